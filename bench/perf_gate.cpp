@@ -0,0 +1,683 @@
+// Performance regression gate. Runs every benchmark listed in a baseline file a fixed
+// number of times, takes the median and a distribution-free confidence interval of each
+// tracked metric, and compares them with the checked-in baseline. A metric regresses when
+// its median moved past the threshold in the bad direction AND its interval no longer
+// overlaps the baseline interval, so single noisy runs do not fail the gate.
+//
+// Absolute numbers only mean something on the hardware that produced them, so baselines
+// are keyed by machine profile: the CPU model and core count of the host, or the name
+// given with --profile. Metrics without a baseline for the current profile are reported
+// but never fail the gate; --update records (or replaces) the current profile's values
+// and leaves the other profiles untouched.
+//
+//   perf_gate --baseline bench/baselines.json --bench-dir build
+//   perf_gate --baseline bench/baselines.json --bench-dir build --update
+//   perf_gate --baseline bench/baselines.json --bench-dir build --profile ci-large
+//
+// Exit status: 0 when no metric regressed, 1 on a regression, 2 on usage or run errors.
+//
+// Baseline format:
+//   {"runs": 5, "confidence": 0.95, "throughput_threshold": 0.10, "latency_threshold": 0.20,
+//    "benchmarks": [{"name": "...", "command": "selfkafka_bench --duration 3 --format json",
+//                    "metrics": [{"metric": "msgs_per_sec", "direction": "higher",
+//                                 "baselines": {"Intel(R) Xeon(R) Processor x8":
+//                                     {"median": 91000, "ci_low": 89000, "ci_high": 93000}}}]}]}
+//
+// Benchmark output is flattened into dotted metric names: object keys are joined with
+// '.', array elements are keyed by their "name" field and the "config" object is skipped
+// (selfkafka_bench: "end_to_end_us.p99"; selfkafka_microbench: "partition_append.ops_per_sec").
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Minimal JSON value: enough for the benchmark reports and the baseline file
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object; // Keeps key order
+
+    const JsonValue* get(const std::string& key) const {
+        for (const auto& [name, value] : object) {
+            if (name == key) {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text), pos_(0) {}
+
+    JsonValue parse() {
+        JsonValue value = parseValue();
+        skipWhitespace();
+        if (pos_ != text_.size()) {
+            fail("trailing characters");
+        }
+        return value;
+    }
+
+private:
+    JsonValue parseValue() {
+        skipWhitespace();
+        if (pos_ >= text_.size()) {
+            fail("unexpected end of input");
+        }
+        char c = text_[pos_];
+        JsonValue value;
+        if (c == '{') {
+            value.type = JsonValue::Type::Object;
+            ++pos_;
+            if (consume('}')) {
+                return value;
+            }
+            do {
+                skipWhitespace();
+                std::string key = parseString();
+                skipWhitespace();
+                expect(':');
+                value.object.emplace_back(std::move(key), parseValue());
+                skipWhitespace();
+            } while (consume(','));
+            expect('}');
+        } else if (c == '[') {
+            value.type = JsonValue::Type::Array;
+            ++pos_;
+            if (consume(']')) {
+                return value;
+            }
+            do {
+                value.array.push_back(parseValue());
+                skipWhitespace();
+            } while (consume(','));
+            expect(']');
+        } else if (c == '"') {
+            value.type = JsonValue::Type::String;
+            value.string = parseString();
+        } else if (text_.compare(pos_, 4, "true") == 0 || text_.compare(pos_, 5, "false") == 0) {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = (c == 't');
+            pos_ += value.boolean ? 4 : 5;
+        } else if (text_.compare(pos_, 4, "null") == 0) {
+            pos_ += 4;
+        } else {
+            value.type = JsonValue::Type::Number;
+            const char* begin = text_.c_str() + pos_;
+            char* end = nullptr;
+            value.number = std::strtod(begin, &end);
+            if (end == begin) {
+                fail("invalid value");
+            }
+            pos_ += static_cast<size_t>(end - begin);
+        }
+        return value;
+    }
+
+    std::string parseString() {
+        expect('"');
+        std::string out;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            char c = text_[pos_++];
+            if (c == '\\' && pos_ < text_.size()) {
+                char escaped = text_[pos_++];
+                switch (escaped) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'u': out += '?'; pos_ += 4; break; // Not needed for metric names
+                    default: out += escaped; break;
+                }
+            } else {
+                out += c;
+            }
+        }
+        expect('"');
+        return out;
+    }
+
+    void skipWhitespace() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) {
+        skipWhitespace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail(std::string("expected '") + c + "'");
+        }
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("JSON parse error at offset " + std::to_string(pos_) + ": " + what);
+    }
+
+    const std::string& text_;
+    size_t pos_;
+};
+
+// Flattens numeric leaves of a benchmark report into dotted metric names
+void flatten(const JsonValue& value, const std::string& prefix, std::map<std::string, double>& out) {
+    auto join = [&prefix](const std::string& key) { return prefix.empty() ? key : prefix + "." + key; };
+    switch (value.type) {
+        case JsonValue::Type::Number:
+            out[prefix] = value.number;
+            break;
+        case JsonValue::Type::Object:
+            for (const auto& [key, child] : value.object) {
+                if (prefix.empty() && (key == "config" || key == "results")) {
+                    if (key == "results") {
+                        flatten(child, "", out); // Top-level results are the metric namespace
+                    }
+                    continue;
+                }
+                flatten(child, join(key), out);
+            }
+            break;
+        case JsonValue::Type::Array:
+            for (size_t i = 0; i < value.array.size(); ++i) {
+                const JsonValue* name = value.array[i].get("name");
+                std::string key = (name && name->type == JsonValue::Type::String) ? name->string : std::to_string(i);
+                flatten(value.array[i], join(key), out);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+enum class Direction { Higher, Lower };
+
+struct Estimate {
+    double median;
+    double ciLow;
+    double ciHigh;
+};
+
+struct TrackedMetric {
+    std::string metric;
+    Direction direction = Direction::Higher;
+    std::optional<double> threshold;          // Overrides the per-direction default
+    std::map<std::string, Estimate> baselines; // By machine profile
+};
+
+struct BenchmarkSpec {
+    std::string name;
+    std::string command;
+    std::vector<TrackedMetric> metrics;
+};
+
+struct Baseline {
+    size_t runs = 5;
+    double confidence = 0.95;
+    double throughputThreshold = 0.10;
+    double latencyThreshold = 0.20;
+    std::vector<BenchmarkSpec> benchmarks;
+};
+
+struct GateConfig {
+    std::string baselinePath;
+    std::string benchDir = ".";
+    std::optional<size_t> runs;
+    std::optional<double> throughputThreshold;
+    std::optional<double> latencyThreshold;
+    std::string filter;
+    std::string profile; // Detected from the host when empty
+    bool update = false;
+};
+
+double numberField(const JsonValue& object, const std::string& key, double fallback) {
+    const JsonValue* value = object.get(key);
+    return (value && value->type == JsonValue::Type::Number) ? value->number : fallback;
+}
+
+std::string stringField(const JsonValue& object, const std::string& key) {
+    const JsonValue* value = object.get(key);
+    if (!value || value->type != JsonValue::Type::String) {
+        throw std::runtime_error("Baseline entry is missing string field \"" + key + "\"");
+    }
+    return value->string;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+Baseline loadBaseline(const std::string& path) {
+    JsonValue root = JsonParser(readFile(path)).parse();
+    Baseline baseline;
+    baseline.runs = static_cast<size_t>(numberField(root, "runs", 5));
+    baseline.confidence = numberField(root, "confidence", 0.95);
+    baseline.throughputThreshold = numberField(root, "throughput_threshold", 0.10);
+    baseline.latencyThreshold = numberField(root, "latency_threshold", 0.20);
+
+    const JsonValue* benchmarks = root.get("benchmarks");
+    if (!benchmarks || benchmarks->type != JsonValue::Type::Array) {
+        throw std::runtime_error("Baseline has no \"benchmarks\" array");
+    }
+    for (const auto& entry : benchmarks->array) {
+        BenchmarkSpec spec{stringField(entry, "name"), stringField(entry, "command"), {}};
+        const JsonValue* metrics = entry.get("metrics");
+        if (!metrics || metrics->type != JsonValue::Type::Array) {
+            throw std::runtime_error("Benchmark " + spec.name + " has no \"metrics\" array");
+        }
+        for (const auto& m : metrics->array) {
+            TrackedMetric metric;
+            metric.metric = stringField(m, "metric");
+            std::string direction = stringField(m, "direction");
+            if (direction != "higher" && direction != "lower") {
+                throw std::runtime_error("Direction of " + metric.metric + " must be \"higher\" or \"lower\"");
+            }
+            metric.direction = (direction == "higher") ? Direction::Higher : Direction::Lower;
+            if (const JsonValue* threshold = m.get("threshold")) {
+                metric.threshold = threshold->number;
+            }
+            if (const JsonValue* baselines = m.get("baselines"); baselines && baselines->type == JsonValue::Type::Object) {
+                for (const auto& [profile, recorded] : baselines->object) {
+                    double median = numberField(recorded, "median", 0.0);
+                    metric.baselines[profile] = Estimate{median, numberField(recorded, "ci_low", median),
+                                                         numberField(recorded, "ci_high", median)};
+                }
+            }
+            spec.metrics.push_back(std::move(metric));
+        }
+        baseline.benchmarks.push_back(std::move(spec));
+    }
+    return baseline;
+}
+
+std::string formatNumber(double value) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    return buffer;
+}
+
+std::string escapeJson(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
+
+void writeBaseline(const std::string& path, const Baseline& baseline) {
+    std::ostringstream out;
+    out << "{\n"
+        << "  \"runs\": " << baseline.runs << ",\n"
+        << "  \"confidence\": " << formatNumber(baseline.confidence) << ",\n"
+        << "  \"throughput_threshold\": " << formatNumber(baseline.throughputThreshold) << ",\n"
+        << "  \"latency_threshold\": " << formatNumber(baseline.latencyThreshold) << ",\n"
+        << "  \"benchmarks\": [\n";
+    for (size_t b = 0; b < baseline.benchmarks.size(); ++b) {
+        const BenchmarkSpec& spec = baseline.benchmarks[b];
+        out << "    {\n"
+            << "      \"name\": \"" << escapeJson(spec.name) << "\",\n"
+            << "      \"command\": \"" << escapeJson(spec.command) << "\",\n"
+            << "      \"metrics\": [\n";
+        for (size_t m = 0; m < spec.metrics.size(); ++m) {
+            const TrackedMetric& metric = spec.metrics[m];
+            out << "        {\"metric\": \"" << escapeJson(metric.metric) << "\", \"direction\": \""
+                << (metric.direction == Direction::Higher ? "higher" : "lower") << "\"";
+            if (metric.threshold) {
+                out << ", \"threshold\": " << formatNumber(*metric.threshold);
+            }
+            out << ", \"baselines\": {";
+            size_t p = 0;
+            for (const auto& [profile, recorded] : metric.baselines) {
+                out << (p++ == 0 ? "\n" : ",\n") << "          \"" << escapeJson(profile) << "\": {\"median\": "
+                    << formatNumber(recorded.median) << ", \"ci_low\": " << formatNumber(recorded.ciLow)
+                    << ", \"ci_high\": " << formatNumber(recorded.ciHigh) << "}";
+            }
+            out << (metric.baselines.empty() ? "}}" : "\n        }}") << (m + 1 < spec.metrics.size() ? "," : "")
+                << "\n";
+        }
+        out << "      ]\n"
+            << "    }" << (b + 1 < baseline.benchmarks.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+
+    std::ofstream file(path, std::ios::trunc);
+    if (!file || !(file << out.str())) {
+        throw std::runtime_error("Failed to write baseline " + path);
+    }
+}
+
+// Runs one benchmark command and returns the flattened metrics of its JSON report (the
+// last line of stdout that starts with '{', so stray log lines are ignored)
+std::map<std::string, double> runBenchmark(const GateConfig& config, const BenchmarkSpec& spec) {
+    std::string command = config.benchDir + "/" + spec.command;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        throw std::runtime_error("Failed to start: " + command);
+    }
+    std::string output;
+    char buffer[4096];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        output.append(buffer, read);
+    }
+    int status = pclose(pipe);
+    if (status != 0) {
+        throw std::runtime_error("Benchmark " + spec.name + " failed (status " + std::to_string(status) + "): " + command);
+    }
+
+    std::string report;
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.front() == '{') {
+            report = line;
+        }
+    }
+    if (report.empty()) {
+        throw std::runtime_error("Benchmark " + spec.name + " printed no JSON report");
+    }
+
+    std::map<std::string, double> metrics;
+    flatten(JsonParser(report).parse(), "", metrics);
+    return metrics;
+}
+
+// Machine profile of this host: CPU model and core count, e.g. "Intel(R) Xeon(R) Processor x8"
+std::string detectProfile() {
+    std::string model = "unknown-cpu";
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0 || line.rfind("Model", 0) == 0) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                std::string value;
+                for (char c : line.substr(colon + 1)) {
+                    bool space = std::isspace(static_cast<unsigned char>(c));
+                    if (!space || (!value.empty() && value.back() != ' ')) {
+                        value += space ? ' ' : c;
+                    }
+                }
+                while (!value.empty() && value.back() == ' ') {
+                    value.pop_back();
+                }
+                if (!value.empty()) {
+                    model = value;
+                    break;
+                }
+            }
+        }
+    }
+    return model + " x" + std::to_string(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// Median with a distribution-free confidence interval: the order statistics
+// [x(k), x(n-k+1)] with the largest k for which P(Binomial(n, 1/2) < k) <= (1 - confidence) / 2
+// (falls back to [min, max] when there are too few samples for the requested level)
+Estimate estimate(std::vector<double> samples, double confidence) {
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    double median = (n % 2 == 1) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+
+    double tail = (1.0 - confidence) / 2.0;
+    double cumulative = 0.0;
+    size_t k = 1;
+    for (size_t i = 0; i < n / 2; ++i) {
+        // P(X = i) for X ~ Binomial(n, 1/2)
+        cumulative += std::exp(std::lgamma(n + 1.0) - std::lgamma(i + 1.0) - std::lgamma(n - i + 1.0) - n * std::log(2.0));
+        if (cumulative > tail) {
+            break;
+        }
+        k = i + 1;
+    }
+    return Estimate{median, samples[k - 1], samples[n - k]};
+}
+
+enum class Verdict { Ok, Improved, Regressed, NoBaseline, Missing };
+
+struct Comparison {
+    std::string benchmark;
+    std::string metric;
+    Direction direction;
+    std::optional<Estimate> baseline; // This profile's values as they were before an --update
+    std::optional<Estimate> current;
+    double threshold;
+    Verdict verdict;
+};
+
+Comparison compare(const std::string& benchmark, const TrackedMetric& metric, const std::string& profile,
+                   const std::optional<Estimate>& current, double threshold) {
+    Comparison result{benchmark, metric.metric, metric.direction, std::nullopt, current, threshold, Verdict::Ok};
+    if (auto it = metric.baselines.find(profile); it != metric.baselines.end()) {
+        result.baseline = it->second;
+    }
+    if (!current) {
+        result.verdict = Verdict::Missing;
+        return result;
+    }
+    if (!result.baseline) {
+        result.verdict = Verdict::NoBaseline;
+        return result;
+    }
+
+    const Estimate& base = *result.baseline;
+    if (metric.direction == Direction::Higher) {
+        if (current->median < base.median * (1.0 - threshold) && current->ciHigh < base.ciLow) {
+            result.verdict = Verdict::Regressed;
+        } else if (current->median > base.median * (1.0 + threshold) && current->ciLow > base.ciHigh) {
+            result.verdict = Verdict::Improved;
+        }
+    } else {
+        if (current->median > base.median * (1.0 + threshold) && current->ciLow > base.ciHigh) {
+            result.verdict = Verdict::Regressed;
+        } else if (current->median < base.median * (1.0 - threshold) && current->ciHigh < base.ciLow) {
+            result.verdict = Verdict::Improved;
+        }
+    }
+    return result;
+}
+
+const char* verdictName(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::Ok: return "ok";
+        case Verdict::Improved: return "improved";
+        case Verdict::Regressed: return "REGRESSED";
+        case Verdict::NoBaseline: return "no baseline";
+        case Verdict::Missing: return "MISSING";
+    }
+    return "?";
+}
+
+void printTable(const std::vector<Comparison>& comparisons) {
+    auto interval = [](double median, double low, double high) {
+        return formatNumber(median) + " [" + formatNumber(low) + ", " + formatNumber(high) + "]";
+    };
+
+    std::printf("%-18s %-54s %-40s %-40s %9s %7s  %s\n", "benchmark", "metric", "baseline median [CI]",
+                "current median [CI]", "change", "limit", "status");
+    for (const auto& c : comparisons) {
+        std::string base = c.baseline ? interval(c.baseline->median, c.baseline->ciLow, c.baseline->ciHigh) : "-";
+        std::string current = c.current ? interval(c.current->median, c.current->ciLow, c.current->ciHigh) : "-";
+        std::string change = "-";
+        if (c.current && c.baseline && c.baseline->median != 0.0) {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%+.1f%%", (c.current->median / c.baseline->median - 1.0) * 100.0);
+            change = buffer;
+        }
+        char limit[32];
+        std::snprintf(limit, sizeof(limit), "%s%.0f%%", c.direction == Direction::Higher ? "-" : "+",
+                      c.threshold * 100.0);
+        std::printf("%-18s %-54s %-40s %-40s %9s %7s  %s\n", c.benchmark.c_str(), c.metric.c_str(),
+                    base.c_str(), current.c_str(), change.c_str(), limit, verdictName(c.verdict));
+    }
+}
+
+void printUsage() {
+    std::cout << "Usage: perf_gate --baseline PATH [options]\n"
+              << "  --baseline PATH              baseline JSON listing benchmarks and tracked metrics\n"
+              << "  --bench-dir DIR              directory containing the benchmark executables (default .)\n"
+              << "  --runs N                     runs per benchmark (default: baseline \"runs\")\n"
+              << "  --throughput-threshold F     allowed drop of higher-is-better metrics, e.g. 0.10\n"
+              << "  --latency-threshold F        allowed rise of lower-is-better metrics, e.g. 0.20\n"
+              << "  --filter TEXT                only run benchmarks whose name contains TEXT\n"
+              << "  --profile NAME               machine profile to compare against (default: CPU model and count)\n"
+              << "  --update                     record the measured values as this profile's baseline\n";
+}
+
+GateConfig parseArgs(int argc, char** argv) {
+    GateConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        if (arg == "--update") {
+            config.update = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--baseline") {
+            config.baselinePath = value;
+        } else if (arg == "--bench-dir") {
+            config.benchDir = value;
+        } else if (arg == "--runs") {
+            config.runs = std::stoul(value);
+        } else if (arg == "--throughput-threshold") {
+            config.throughputThreshold = std::stod(value);
+        } else if (arg == "--latency-threshold") {
+            config.latencyThreshold = std::stod(value);
+        } else if (arg == "--filter") {
+            config.filter = value;
+        } else if (arg == "--profile") {
+            config.profile = value;
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    if (config.baselinePath.empty()) {
+        throw std::invalid_argument("--baseline is required");
+    }
+    if (config.runs && *config.runs == 0) {
+        throw std::invalid_argument("Runs must be positive");
+    }
+    return config;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        GateConfig config = parseArgs(argc, argv);
+        Baseline baseline = loadBaseline(config.baselinePath);
+        size_t runs = config.runs.value_or(baseline.runs);
+        double throughputThreshold = config.throughputThreshold.value_or(baseline.throughputThreshold);
+        double latencyThreshold = config.latencyThreshold.value_or(baseline.latencyThreshold);
+        std::string profile = config.profile.empty() ? detectProfile() : config.profile;
+        std::cerr << "perf_gate: machine profile \"" << profile << "\"" << std::endl;
+
+        std::vector<Comparison> comparisons;
+        for (auto& spec : baseline.benchmarks) {
+            if (spec.name.find(config.filter) == std::string::npos) {
+                continue;
+            }
+
+            std::map<std::string, std::vector<double>> samples;
+            for (size_t run = 0; run < runs; ++run) {
+                std::cerr << "perf_gate: " << spec.name << " run " << (run + 1) << "/" << runs << std::endl;
+                for (const auto& [name, value] : runBenchmark(config, spec)) {
+                    samples[name].push_back(value);
+                }
+            }
+
+            for (auto& metric : spec.metrics) {
+                std::optional<Estimate> current;
+                auto it = samples.find(metric.metric);
+                if (it != samples.end() && it->second.size() == runs) {
+                    current = estimate(it->second, baseline.confidence);
+                }
+                double threshold = metric.threshold.value_or(
+                    metric.direction == Direction::Higher ? throughputThreshold : latencyThreshold);
+                comparisons.push_back(compare(spec.name, metric, profile, current, threshold));
+
+                if (config.update && current) {
+                    metric.baselines[profile] = *current;
+                }
+            }
+        }
+
+        printTable(comparisons);
+
+        bool missing = std::any_of(comparisons.begin(), comparisons.end(),
+                                   [](const Comparison& c) { return c.verdict == Verdict::Missing; });
+        if (config.update) {
+            if (missing) {
+                throw std::runtime_error("Some tracked metrics were not reported; baseline not updated");
+            }
+            baseline.runs = runs;
+            writeBaseline(config.baselinePath, baseline);
+            std::cout << "Baseline updated for profile \"" << profile << "\": " << config.baselinePath << '\n';
+            return 0;
+        }
+
+        size_t unbaselined = std::count_if(comparisons.begin(), comparisons.end(),
+                                           [](const Comparison& c) { return c.verdict == Verdict::NoBaseline; });
+        if (unbaselined > 0) {
+            std::cout << unbaselined << " metric(s) have no baseline for profile \"" << profile
+                      << "\" and were not gated; record one with --update\n";
+        }
+
+        size_t regressed = std::count_if(comparisons.begin(), comparisons.end(), [](const Comparison& c) {
+            return c.verdict == Verdict::Regressed || c.verdict == Verdict::Missing;
+        });
+        if (regressed > 0) {
+            std::cout << regressed << " metric(s) regressed or missing\n";
+            return 1;
+        }
+        std::cout << "No performance regressions (" << comparisons.size() - unbaselined << " metrics gated)\n";
+    } catch (const std::exception& e) {
+        std::cerr << "perf_gate: " << e.what() << '\n';
+        return 2;
+    }
+    return 0;
+}
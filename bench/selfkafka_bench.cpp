@@ -0,0 +1,389 @@
+// End-to-end throughput and latency benchmark.
+//
+// Producers send through Broker::send (async writer path) with an append callback, and
+// consumers poll every partition. Reports appended msgs/sec and MB/sec, produce->append
+// latency (send call to append callback) and end-to-end latency (message timestamp to
+// consumer delivery) as JSON or CSV.
+//
+//   selfkafka_bench --producers 4 --consumers 2 --topics 2 --partitions 8
+//                   --message-size uniform:100-1000 --keys 1000 --duration 10 --format json
+
+#include "Broker.h"
+#include "Consumer.h"
+#include "LatencyHistogram.h"
+#include "Metrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Message size distribution: fixed:N, uniform:MIN-MAX or exponential:MEAN
+struct SizeDistribution {
+    enum class Kind { Fixed, Uniform, Exponential };
+
+    Kind kind = Kind::Fixed;
+    size_t min = 100;
+    size_t max = 100;
+    double mean = 100.0;
+    std::string spec = "fixed:100";
+
+    static SizeDistribution parse(const std::string& spec) {
+        SizeDistribution distribution;
+        distribution.spec = spec;
+        size_t colon = spec.find(':');
+        if (colon == std::string::npos) {
+            throw std::invalid_argument("Message size must be fixed:N, uniform:MIN-MAX or exponential:MEAN");
+        }
+        std::string kind = spec.substr(0, colon);
+        std::string args = spec.substr(colon + 1);
+        if (kind == "fixed") {
+            distribution.kind = Kind::Fixed;
+            distribution.min = distribution.max = std::stoul(args);
+            distribution.mean = static_cast<double>(distribution.min);
+        } else if (kind == "uniform") {
+            size_t dash = args.find('-');
+            if (dash == std::string::npos) {
+                throw std::invalid_argument("Uniform message size must be uniform:MIN-MAX");
+            }
+            distribution.kind = Kind::Uniform;
+            distribution.min = std::stoul(args.substr(0, dash));
+            distribution.max = std::stoul(args.substr(dash + 1));
+            if (distribution.min > distribution.max) {
+                throw std::invalid_argument("Uniform message size needs MIN <= MAX");
+            }
+            distribution.mean = (distribution.min + distribution.max) / 2.0;
+        } else if (kind == "exponential") {
+            distribution.kind = Kind::Exponential;
+            distribution.mean = std::stod(args);
+            distribution.min = 0;
+            distribution.max = static_cast<size_t>(distribution.mean * 20); // Cap the tail
+        } else {
+            throw std::invalid_argument("Unknown message size distribution: " + kind);
+        }
+        return distribution;
+    }
+
+    size_t next(std::mt19937_64& rng) const {
+        switch (kind) {
+            case Kind::Fixed:
+                return min;
+            case Kind::Uniform:
+                return std::uniform_int_distribution<size_t>(min, max)(rng);
+            case Kind::Exponential:
+                return std::min(max, static_cast<size_t>(std::exponential_distribution<double>(1.0 / mean)(rng)));
+        }
+        return min;
+    }
+};
+
+struct BenchConfig {
+    size_t producers = 1;
+    size_t consumers = 1;
+    size_t topics = 1;
+    size_t partitions = 4;
+    SizeDistribution messageSize;
+    size_t keys = 1000;
+    double durationSeconds = 10.0;
+    double warmupSeconds = 1.0;
+    size_t maxInFlight = 1000; // Per producer; bounds the async writer queues
+    std::string format = "json";
+    std::string output; // Empty: stdout
+};
+
+struct BenchResult {
+    uint64_t produced = 0;
+    uint64_t appended = 0;
+    uint64_t appendedBytes = 0;
+    uint64_t consumed = 0;
+    double measuredSeconds = 0.0;
+    LatencySnapshot produceToAppend;
+    LatencySnapshot endToEnd;
+};
+
+void printUsage() {
+    std::cout << "Usage: selfkafka_bench [options]\n"
+              << "  --producers N          producer threads (default 1)\n"
+              << "  --consumers N          consumer threads, 0 to skip consuming (default 1)\n"
+              << "  --topics N             topics (default 1)\n"
+              << "  --partitions N         partitions per topic (default 4)\n"
+              << "  --message-size SPEC    fixed:N | uniform:MIN-MAX | exponential:MEAN bytes (default fixed:100)\n"
+              << "  --keys N               distinct message keys (default 1000)\n"
+              << "  --duration SECONDS     measured duration (default 10)\n"
+              << "  --warmup SECONDS       unmeasured warmup before it (default 1)\n"
+              << "  --max-in-flight N      unappended messages per producer (default 1000)\n"
+              << "  --format json|csv      output format (default json)\n"
+              << "  --output PATH          write results to a file instead of stdout\n";
+}
+
+BenchConfig parseArgs(int argc, char** argv) {
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--producers") {
+            config.producers = std::stoul(value);
+        } else if (arg == "--consumers") {
+            config.consumers = std::stoul(value);
+        } else if (arg == "--topics") {
+            config.topics = std::stoul(value);
+        } else if (arg == "--partitions") {
+            config.partitions = std::stoul(value);
+        } else if (arg == "--message-size") {
+            config.messageSize = SizeDistribution::parse(value);
+        } else if (arg == "--keys") {
+            config.keys = std::stoul(value);
+        } else if (arg == "--duration") {
+            config.durationSeconds = std::stod(value);
+        } else if (arg == "--warmup") {
+            config.warmupSeconds = std::stod(value);
+        } else if (arg == "--max-in-flight") {
+            config.maxInFlight = std::stoul(value);
+        } else if (arg == "--format") {
+            config.format = value;
+        } else if (arg == "--output") {
+            config.output = value;
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+
+    if (config.producers == 0 || config.topics == 0 || config.partitions == 0 || config.keys == 0) {
+        throw std::invalid_argument("Producers, topics, partitions and keys must be positive");
+    }
+    if (config.format != "json" && config.format != "csv") {
+        throw std::invalid_argument("Format must be json or csv");
+    }
+    return config;
+}
+
+std::string topicName(size_t index) {
+    return "bench-" + std::to_string(index);
+}
+
+BenchResult run(const BenchConfig& config) {
+    Broker broker("bench-broker");
+    std::vector<std::string> topics;
+    for (size_t t = 0; t < config.topics; ++t) {
+        topics.push_back(topicName(t));
+        broker.createTopic(topics.back(), config.partitions);
+    }
+    broker.startAsyncWriter();
+
+    LatencyHistogram produceToAppend;
+    LatencyHistogram endToEnd;
+    std::atomic<bool> measuring{false};
+    std::atomic<bool> producing{true};
+    std::atomic<bool> consuming{true};
+    std::atomic<uint64_t> produced{0};
+    std::atomic<uint64_t> appended{0};
+    std::atomic<uint64_t> appendedBytes{0};
+    std::atomic<uint64_t> consumed{0};
+    std::atomic<uint64_t> totalInFlight{0};
+
+    // Key and payload pools so producers only copy
+    std::vector<std::string> keys;
+    keys.reserve(config.keys);
+    for (size_t k = 0; k < config.keys; ++k) {
+        keys.push_back("key-" + std::to_string(k));
+    }
+    const std::string payload(config.messageSize.max, 'x');
+
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < config.producers; ++p) {
+        producers.emplace_back([&, p] {
+            std::mt19937_64 rng(p + 1);
+            std::atomic<uint64_t> inFlight{0};
+            size_t topic = p % config.topics;
+            while (producing.load(std::memory_order_relaxed)) {
+                if (inFlight.load(std::memory_order_relaxed) >= config.maxInFlight) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                size_t size = config.messageSize.next(rng);
+                const std::string& key = keys[rng() % keys.size()];
+                bool measured = measuring.load(std::memory_order_relaxed);
+                auto sentAt = Clock::now();
+                inFlight.fetch_add(1, std::memory_order_relaxed);
+                totalInFlight.fetch_add(1, std::memory_order_relaxed);
+                broker.send(topics[topic], key, payload.substr(0, size),
+                            [&, sentAt, size, measured](std::exception_ptr error) {
+                    if (!error && measured) {
+                        produceToAppend.record(Clock::now() - sentAt);
+                        appended.fetch_add(1, std::memory_order_relaxed);
+                        appendedBytes.fetch_add(size, std::memory_order_relaxed);
+                    }
+                    inFlight.fetch_sub(1, std::memory_order_relaxed);
+                    totalInFlight.fetch_sub(1, std::memory_order_relaxed);
+                });
+                if (measured) {
+                    produced.fetch_add(1, std::memory_order_relaxed);
+                }
+                topic = (topic + 1) % config.topics;
+            }
+
+            // The callbacks reference inFlight, so wait for them before it goes out of scope
+            while (inFlight.load() > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+
+    // Each consumer thread owns a share of the (topic, partition) pairs
+    std::vector<std::thread> consumers;
+    for (size_t c = 0; c < config.consumers; ++c) {
+        consumers.emplace_back([&, c] {
+            std::vector<std::unique_ptr<Consumer>> owned;
+            for (size_t t = 0; t < config.topics; ++t) {
+                std::vector<uint32_t> partitions;
+                for (size_t pid = 0; pid < config.partitions; ++pid) {
+                    if ((t * config.partitions + pid) % config.consumers == c) {
+                        partitions.push_back(static_cast<uint32_t>(pid));
+                    }
+                }
+                if (!partitions.empty()) {
+                    owned.push_back(std::make_unique<Consumer>(broker, topics[t]));
+                    owned.back()->assign(partitions);
+                }
+            }
+
+            while (consuming.load(std::memory_order_relaxed)) {
+                for (auto& consumer : owned) {
+                    ConsumerRecords records = consumer->poll(5000, 16 * 1024 * 1024, std::chrono::milliseconds(5));
+                    auto now = std::chrono::system_clock::now();
+                    bool measured = measuring.load(std::memory_order_relaxed);
+                    if (!measured) {
+                        continue;
+                    }
+                    for (const auto& [partitionId, messages] : records) {
+                        for (const auto& message : messages) {
+                            endToEnd.record(now - message.getTimestamp());
+                        }
+                    }
+                    consumed.fetch_add(records.count(), std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    auto toDuration = [](double seconds) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    };
+    std::this_thread::sleep_for(toDuration(config.warmupSeconds));
+    measuring.store(true);
+    auto measureStart = Clock::now();
+    std::this_thread::sleep_for(toDuration(config.durationSeconds));
+    measuring.store(false);
+    double measuredSeconds = std::chrono::duration<double>(Clock::now() - measureStart).count();
+
+    producing.store(false);
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    consuming.store(false);
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+    broker.stopAsyncWriter();
+
+    BenchResult result;
+    result.produced = produced.load();
+    result.appended = appended.load();
+    result.appendedBytes = appendedBytes.load();
+    result.consumed = consumed.load();
+    result.measuredSeconds = measuredSeconds;
+    result.produceToAppend = produceToAppend.snapshot();
+    result.endToEnd = endToEnd.snapshot();
+    return result;
+}
+
+std::string latencyJson(const LatencySnapshot& latency) {
+    char buffer[256];
+    std::snprintf(buffer, sizeof(buffer),
+                  "{\"count\":%llu,\"mean\":%.3f,\"p50\":%.3f,\"p99\":%.3f,\"p999\":%.3f,\"max\":%.3f}",
+                  static_cast<unsigned long long>(latency.count), latency.mean / 1e3, latency.p50 / 1e3,
+                  latency.p99 / 1e3, latency.p999 / 1e3, latency.max / 1e3);
+    return buffer;
+}
+
+std::string formatResult(const BenchConfig& config, const BenchResult& result) {
+    double seconds = result.measuredSeconds > 0 ? result.measuredSeconds : 1.0;
+    double msgsPerSec = static_cast<double>(result.appended) / seconds;
+    double mbPerSec = static_cast<double>(result.appendedBytes) / seconds / (1024.0 * 1024.0);
+    double consumedPerSec = static_cast<double>(result.consumed) / seconds;
+    std::ostringstream out;
+
+    if (config.format == "csv") {
+        out << "producers,consumers,topics,partitions,message_size,keys,duration_s,"
+               "produced,appended,consumed,msgs_per_sec,mb_per_sec,consumed_msgs_per_sec,"
+               "produce_append_p50_us,produce_append_p99_us,produce_append_p999_us,produce_append_max_us,"
+               "end_to_end_p50_us,end_to_end_p99_us,end_to_end_p999_us,end_to_end_max_us\n";
+        out << config.producers << ',' << config.consumers << ',' << config.topics << ',' << config.partitions
+            << ',' << config.messageSize.spec << ',' << config.keys << ',' << result.measuredSeconds << ','
+            << result.produced << ',' << result.appended << ',' << result.consumed << ',' << msgsPerSec << ','
+            << mbPerSec << ',' << consumedPerSec << ',' << result.produceToAppend.p50 / 1e3 << ','
+            << result.produceToAppend.p99 / 1e3 << ',' << result.produceToAppend.p999 / 1e3 << ','
+            << result.produceToAppend.max / 1e3 << ',' << result.endToEnd.p50 / 1e3 << ','
+            << result.endToEnd.p99 / 1e3 << ',' << result.endToEnd.p999 / 1e3 << ','
+            << result.endToEnd.max / 1e3 << '\n';
+        return out.str();
+    }
+
+    out << "{\"benchmark\":\"selfkafka_bench\",\"config\":{"
+        << "\"producers\":" << config.producers << ",\"consumers\":" << config.consumers
+        << ",\"topics\":" << config.topics << ",\"partitions\":" << config.partitions
+        << ",\"message_size\":\"" << config.messageSize.spec << "\",\"keys\":" << config.keys
+        << ",\"duration_s\":" << config.durationSeconds << ",\"warmup_s\":" << config.warmupSeconds
+        << ",\"max_in_flight\":" << config.maxInFlight << "},\"results\":{"
+        << "\"measured_s\":" << result.measuredSeconds << ",\"produced\":" << result.produced
+        << ",\"appended\":" << result.appended << ",\"consumed\":" << result.consumed
+        << ",\"msgs_per_sec\":" << msgsPerSec << ",\"mb_per_sec\":" << mbPerSec
+        << ",\"consumed_msgs_per_sec\":" << consumedPerSec
+        << ",\"produce_to_append_us\":" << latencyJson(result.produceToAppend)
+        << ",\"end_to_end_us\":" << latencyJson(result.endToEnd) << "}}\n";
+    return out.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        BenchConfig config = parseArgs(argc, argv);
+        Metrics::getInstance().setLogLevel(LogLevel::WARN);
+
+        std::string report = formatResult(config, run(config));
+        if (config.output.empty()) {
+            std::cout << report;
+        } else {
+            std::ofstream file(config.output, std::ios::trunc);
+            if (!file) {
+                throw std::runtime_error("Failed to open output file: " + config.output);
+            }
+            file << report;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "selfkafka_bench: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,199 @@
+// Load generator: drives an in-process broker with production-shaped traffic (Zipfian or
+// hotspot keys, payload sizes from a histogram, diurnal or burst rate schedules, slow
+// consumers) and reports per-partition skew and lag. The seed is always printed; pass it
+// back with --seed to replay the same key and payload sequences.
+//
+//   selfkafka_loadgen --keys 100000 --key-dist zipf:0.99 --payload 64-256:70,256-4096:25,4096-65536:5
+//                     --rate burst:2000:20000:10:1 --consumers 4 --slow-consumers 1 --duration 60
+
+#include "Broker.h"
+#include "LoadGenerator.h"
+#include "Metrics.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct LoadgenOptions {
+    LoadGeneratorConfig config;
+    uint64_t keys = 1000;
+    std::string keyDistribution = "uniform";
+    double reportIntervalSeconds = 5.0; // 0 disables progress lines
+    std::string format = "text";
+    std::string output;
+};
+
+void printUsage() {
+    std::cout << "Usage: selfkafka_loadgen [options]\n"
+              << "  --partitions N          partitions of the load topic (default 8)\n"
+              << "  --producers N           producer threads sharing the rate (default 1)\n"
+              << "  --consumers N           consumers, partitions split round-robin (default 1)\n"
+              << "  --slow-consumers N      of those, consumers that sleep per record (default 0)\n"
+              << "  --slow-delay-us N       sleep per record of a slow consumer (default 1000)\n"
+              << "  --keys N                distinct keys (default 1000)\n"
+              << "  --key-dist SPEC         uniform | zipf:S | hotspot:KEY_FRACTION:TRAFFIC_FRACTION\n"
+              << "  --payload SPEC          fixed:N | MIN-MAX:WEIGHT,... byte histogram (default fixed:100)\n"
+              << "  --rate SPEC             constant:R | diurnal:MEAN:AMPLITUDE:PERIOD_S |\n"
+              << "                          burst:BASE:PEAK:PERIOD_S:BURST_S messages/sec (default constant:1000)\n"
+              << "  --duration SECONDS      run length (default 60)\n"
+              << "  --seed N                generator seed (default: random, printed)\n"
+              << "  --report-interval S     progress line every S seconds on stderr, 0 for none (default 5)\n"
+              << "  --format text|json      final report format (default text)\n"
+              << "  --output PATH           write the report to a file instead of stdout\n";
+}
+
+LoadgenOptions parseArgs(int argc, char** argv) {
+    LoadgenOptions options;
+    std::string payload = "fixed:100";
+    std::string rate = "constant:1000";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--partitions") {
+            options.config.partitions = std::stoul(value);
+        } else if (arg == "--producers") {
+            options.config.producers = std::stoul(value);
+        } else if (arg == "--consumers") {
+            options.config.consumers = std::stoul(value);
+        } else if (arg == "--slow-consumers") {
+            options.config.slowConsumers = std::stoul(value);
+        } else if (arg == "--slow-delay-us") {
+            options.config.slowConsumerDelay = std::chrono::microseconds(std::stoull(value));
+        } else if (arg == "--keys") {
+            options.keys = std::stoull(value);
+        } else if (arg == "--key-dist") {
+            options.keyDistribution = value;
+        } else if (arg == "--payload") {
+            payload = value;
+        } else if (arg == "--rate") {
+            rate = value;
+        } else if (arg == "--duration") {
+            options.config.duration = std::chrono::milliseconds(static_cast<int64_t>(std::stod(value) * 1000));
+        } else if (arg == "--seed") {
+            options.config.seed = std::stoull(value);
+        } else if (arg == "--report-interval") {
+            options.reportIntervalSeconds = std::stod(value);
+        } else if (arg == "--format") {
+            options.format = value;
+        } else if (arg == "--output") {
+            options.output = value;
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+
+    if (options.format != "text" && options.format != "json") {
+        throw std::invalid_argument("Format must be text or json");
+    }
+    options.config.keys = KeyDistribution::parse(options.keyDistribution, options.keys);
+    options.config.payloadSizes = PayloadSizeDistribution::parse(payload);
+    options.config.rate = RateSchedule::parse(rate);
+    return options;
+}
+
+std::string joinCounts(const std::vector<uint64_t>& values, const char* separator) {
+    std::string out;
+    for (size_t i = 0; i < values.size(); ++i) {
+        out += (i ? separator : "") + std::to_string(values[i]);
+    }
+    return out;
+}
+
+std::string formatReport(const LoadgenOptions& options, const LoadGeneratorReport& report) {
+    const LoadGeneratorConfig& config = options.config;
+    uint64_t totalLag = std::accumulate(report.lagPerPartition.begin(), report.lagPerPartition.end(), uint64_t{0});
+    double seconds = report.elapsedSeconds > 0 ? report.elapsedSeconds : 1.0;
+    std::ostringstream out;
+
+    if (options.format == "json") {
+        out << "{\"benchmark\":\"selfkafka_loadgen\",\"config\":{\"seed\":" << report.seed
+            << ",\"partitions\":" << config.partitions << ",\"producers\":" << config.producers
+            << ",\"consumers\":" << config.consumers << ",\"slow_consumers\":" << config.slowConsumers
+            << ",\"slow_delay_us\":" << config.slowConsumerDelay.count() << ",\"keys\":" << options.keys
+            << ",\"key_dist\":\"" << config.keys.describe() << "\",\"payload\":\"" << config.payloadSizes.describe()
+            << "\",\"rate\":\"" << config.rate.describe() << "\",\"duration_s\":"
+            << std::chrono::duration<double>(config.duration).count() << "},\"results\":{\"elapsed_s\":"
+            << report.elapsedSeconds << ",\"produced\":" << report.produced << ",\"produced_bytes\":"
+            << report.producedBytes << ",\"consumed\":" << report.consumed << ",\"produced_msgs_per_sec\":"
+            << report.produced / seconds << ",\"consumed_msgs_per_sec\":" << report.consumed / seconds
+            << ",\"hottest_partition_share\":" << report.hottestPartitionShare << ",\"total_lag\":" << totalLag
+            << ",\"appended_per_partition\":[" << joinCounts(report.appendedPerPartition, ",")
+            << "],\"lag_per_partition\":[" << joinCounts(report.lagPerPartition, ",")
+            << "],\"consumed_per_consumer\":[" << joinCounts(report.consumedPerConsumer, ",") << "]}}\n";
+        return out.str();
+    }
+
+    out << "seed:                  " << report.seed << "\n"
+        << "traffic:               keys " << options.keys << " " << config.keys.describe() << ", payload "
+        << config.payloadSizes.describe() << ", rate " << config.rate.describe() << "\n"
+        << "elapsed:               " << report.elapsedSeconds << " s\n"
+        << "produced:              " << report.produced << " (" << report.produced / seconds << " msgs/s, "
+        << report.producedBytes / seconds / (1024.0 * 1024.0) << " MB/s)\n"
+        << "consumed:              " << report.consumed << " (" << report.consumed / seconds << " msgs/s)\n"
+        << "hottest partition:     " << report.hottestPartitionShare * 100.0 << "% of appends\n"
+        << "appended per partition " << joinCounts(report.appendedPerPartition, " ") << "\n"
+        << "lag per partition:     " << joinCounts(report.lagPerPartition, " ") << " (total " << totalLag << ")\n"
+        << "consumed per consumer: " << joinCounts(report.consumedPerConsumer, " ") << "\n";
+    return out.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        LoadgenOptions options = parseArgs(argc, argv);
+        Metrics::getInstance().setLogLevel(LogLevel::WARN);
+
+        Broker broker("loadgen");
+        broker.startAsyncWriter();
+        LoadGenerator generator(broker, options.config);
+        std::cerr << "selfkafka_loadgen: seed " << generator.getSeed() << std::endl;
+
+        generator.start();
+        auto nextReport = std::chrono::steady_clock::now();
+        while (generator.isRunning()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (options.reportIntervalSeconds > 0 && std::chrono::steady_clock::now() >= nextReport) {
+                LoadGeneratorReport progress = generator.getReport();
+                uint64_t lag = std::accumulate(progress.lagPerPartition.begin(), progress.lagPerPartition.end(),
+                                               uint64_t{0});
+                std::cerr << "[" << static_cast<int>(progress.elapsedSeconds) << "s] produced " << progress.produced
+                          << ", consumed " << progress.consumed << ", lag " << lag << std::endl;
+                nextReport += std::chrono::milliseconds(static_cast<int64_t>(options.reportIntervalSeconds * 1000));
+            }
+        }
+        generator.join();
+        broker.stopAsyncWriter();
+
+        std::string report = formatReport(options, generator.getReport());
+        if (options.output.empty()) {
+            std::cout << report;
+        } else {
+            std::ofstream file(options.output, std::ios::trunc);
+            if (!file) {
+                throw std::runtime_error("Failed to open output file: " + options.output);
+            }
+            file << report;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "selfkafka_loadgen: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
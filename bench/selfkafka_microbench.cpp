@@ -0,0 +1,481 @@
+// Component microbenchmarks for the queue, partition, topic, retention and metadata hot
+// paths. Each case is set up once, run for a number of unmeasured warm-up runs and then
+// for the measured repetitions; the report gives nanoseconds per operation (min, median,
+// mean, max over the repetitions) and median operations per second. Worker threads can
+// be pinned to CPUs (Linux) so runs are comparable across commits.
+//
+//   selfkafka_microbench --filter partition --repetitions 10 --cpus 0,1,2,3 --format json
+
+#include "Broker.h"
+#include "MessageQueue.h"
+#include "Metrics.h"
+#include "Partition.h"
+#include "RetentionCleaner.h"
+#include "RetentionPolicy.h"
+#include "Topic.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct MicrobenchConfig {
+    std::string filter;
+    size_t warmup = 1;
+    size_t repetitions = 5;
+    std::vector<int> cpus; // Empty: no pinning
+    uint64_t retentionRecords = 10'000'000;
+    size_t metadataPartitions = 10'000;
+    std::string format = "text";
+    std::string output;
+    bool list = false;
+};
+
+MicrobenchConfig config;
+
+// Pins the calling thread to the slot-th configured CPU (no-op without --cpus)
+void pinThread(size_t slot) {
+    if (config.cpus.empty()) {
+        return;
+    }
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(config.cpus[slot % config.cpus.size()], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)slot;
+#endif
+}
+
+// Runs body(i) on n threads, pinned to slots 1..n (slot 0 is the driver thread), and
+// returns once all have finished
+void runThreads(size_t n, const std::function<void(size_t)>& body) {
+    std::vector<std::thread> threads;
+    threads.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        threads.emplace_back([&body, i] {
+            pinThread(i + 1);
+            body(i);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// One benchmark: setup runs once, run() performs one repetition and returns its op count
+struct Case {
+    std::string name;
+    std::function<void()> setup;
+    std::function<uint64_t()> run;
+    std::function<void()> teardown;
+};
+
+struct CaseResult {
+    std::string name;
+    uint64_t opsPerRun = 0;
+    std::vector<double> nsPerOp;
+};
+
+Message makeMessage(uint64_t i) {
+    return Message("key-" + std::to_string(i % 1024), "value-0123456789");
+}
+
+// MessageQueue::push from N producers while one consumer drains with tryPop
+Case messageQueueCase(size_t producers) {
+    constexpr uint64_t kPerProducer = 50'000;
+    return Case{
+        "message_queue_push_pop/producers:" + std::to_string(producers), nullptr,
+        [producers] {
+            MessageQueue queue;
+            std::atomic<bool> done{false};
+            uint64_t expected = kPerProducer * producers;
+            std::thread consumer([&] {
+                pinThread(producers + 1);
+                Message message("", "");
+                uint64_t popped = 0;
+                while (popped < expected) {
+                    if (queue.tryPop(message, std::chrono::milliseconds(10))) {
+                        popped++;
+                    }
+                }
+                done.store(true);
+            });
+            runThreads(producers, [&](size_t) {
+                Message message = makeMessage(0);
+                for (uint64_t i = 0; i < kPerProducer; ++i) {
+                    queue.push(message);
+                }
+            });
+            consumer.join();
+            return expected;
+        },
+        nullptr};
+}
+
+// Partition::append into a fresh partition
+Case partitionAppendCase() {
+    constexpr uint64_t kAppends = 200'000;
+    return Case{
+        "partition_append", nullptr,
+        [] {
+            Partition partition(0);
+            Message message = makeMessage(0);
+            for (uint64_t i = 0; i < kAppends; ++i) {
+                partition.append(message);
+            }
+            return kAppends;
+        },
+        nullptr};
+}
+
+// Partition::append while M readers scan the log with getMessages in windows of 100
+Case partitionAppendWithReadersCase(size_t readers) {
+    constexpr uint64_t kAppends = 100'000;
+    return Case{
+        "partition_append_with_readers/readers:" + std::to_string(readers), nullptr,
+        [readers] {
+            Partition partition(0);
+            std::atomic<bool> writing{true};
+            std::vector<std::thread> readerThreads;
+            for (size_t r = 0; r < readers; ++r) {
+                readerThreads.emplace_back([&, r] {
+                    pinThread(r + 2);
+                    uint64_t from = 0;
+                    while (writing.load(std::memory_order_relaxed)) {
+                        auto messages = partition.getMessages(from, from + 100);
+                        from = messages.empty() ? 0 : from + messages.size();
+                    }
+                });
+            }
+
+            Message message = makeMessage(0);
+            for (uint64_t i = 0; i < kAppends; ++i) {
+                partition.append(message);
+            }
+            writing.store(false);
+            for (auto& thread : readerThreads) {
+                thread.join();
+            }
+            return kAppends;
+        },
+        nullptr};
+}
+
+// Partition::getMessages (windows of 100) from M readers on a prefilled partition
+Case partitionGetMessagesCase(size_t readers) {
+    constexpr uint64_t kRecords = 200'000;
+    constexpr uint64_t kWindow = 100;
+    auto partition = std::make_shared<Partition>(0);
+    return Case{
+        "partition_get_messages/readers:" + std::to_string(readers),
+        [partition] {
+            Message message = makeMessage(0);
+            for (uint64_t i = 0; i < kRecords; ++i) {
+                partition->append(message);
+            }
+        },
+        [partition, readers] {
+            runThreads(readers, [&](size_t) {
+                for (uint64_t from = 0; from < kRecords; from += kWindow) {
+                    auto messages = partition->getMessages(from, from + kWindow);
+                    if (messages.size() != kWindow) {
+                        throw std::runtime_error("Short read from partition");
+                    }
+                }
+            });
+            return kRecords * readers; // Records read
+        },
+        nullptr};
+}
+
+// Topic::append: key hashing, partition routing and the topic lock
+Case topicAppendCase(size_t partitions) {
+    constexpr uint64_t kAppends = 200'000;
+    return Case{
+        "topic_append/partitions:" + std::to_string(partitions), nullptr,
+        [partitions] {
+            Topic topic("bench", partitions);
+            std::vector<Message> messages;
+            for (uint64_t i = 0; i < 1024; ++i) {
+                messages.push_back(makeMessage(i));
+            }
+            for (uint64_t i = 0; i < kAppends; ++i) {
+                topic.append(messages[i % messages.size()]);
+            }
+            return kAppends;
+        },
+        nullptr};
+}
+
+// RetentionCleaner cleanup pass over one large partition (ops are records scanned)
+Case retentionCleanupCase() {
+    auto partition = std::make_shared<Partition>(0);
+    auto cleaner = std::make_shared<RetentionCleaner>();
+    return Case{
+        "retention_cleanup/records:" + std::to_string(config.retentionRecords),
+        [partition, cleaner] {
+            Message message("k", "v");
+            for (uint64_t i = 0; i < config.retentionRecords; ++i) {
+                partition->append(message);
+            }
+            // Size-based policy under which the older half of the log is expired on every pass
+            cleaner->addPartition(partition, RetentionPolicy(std::chrono::hours(24 * 365),
+                                                             config.retentionRecords / 2 * 66));
+        },
+        [cleaner] {
+            cleaner->runOnce();
+            return config.retentionRecords;
+        },
+        nullptr};
+}
+
+// Broker::getTopicsMetadata across many partitions (ops are partitions described)
+Case topicsMetadataCase() {
+    constexpr size_t kPartitionsPerTopic = 100;
+    auto broker = std::make_shared<Broker>("microbench");
+    size_t topics = std::max<size_t>(1, config.metadataPartitions / kPartitionsPerTopic);
+    return Case{
+        "broker_topics_metadata/partitions:" + std::to_string(topics * kPartitionsPerTopic),
+        [broker, topics] {
+            for (size_t t = 0; t < topics; ++t) {
+                broker->createTopic("topic-" + std::to_string(t), kPartitionsPerTopic);
+            }
+        },
+        [broker, topics] {
+            uint64_t described = 0;
+            for (int i = 0; i < 10; ++i) {
+                for (const auto& topic : broker->getTopicsMetadata()) {
+                    described += topic.partitions.size();
+                }
+            }
+            if (described != topics * kPartitionsPerTopic * 10) {
+                throw std::runtime_error("Unexpected partition count in metadata");
+            }
+            return described;
+        },
+        nullptr};
+}
+
+std::vector<Case> allCases() {
+    std::vector<Case> cases;
+    for (size_t producers : {1, 2, 4, 8}) {
+        cases.push_back(messageQueueCase(producers));
+    }
+    cases.push_back(partitionAppendCase());
+    for (size_t readers : {1, 4}) {
+        cases.push_back(partitionAppendWithReadersCase(readers));
+    }
+    for (size_t readers : {1, 4}) {
+        cases.push_back(partitionGetMessagesCase(readers));
+    }
+    for (size_t partitions : {1, 16, 64}) {
+        cases.push_back(topicAppendCase(partitions));
+    }
+    cases.push_back(retentionCleanupCase());
+    cases.push_back(topicsMetadataCase());
+    return cases;
+}
+
+CaseResult runCase(Case& benchCase) {
+    CaseResult result;
+    result.name = benchCase.name;
+    if (benchCase.setup) {
+        benchCase.setup();
+    }
+    for (size_t i = 0; i < config.warmup; ++i) {
+        benchCase.run();
+    }
+    for (size_t i = 0; i < config.repetitions; ++i) {
+        auto start = Clock::now();
+        uint64_t ops = benchCase.run();
+        double elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        result.opsPerRun = ops;
+        result.nsPerOp.push_back(ops > 0 ? elapsedNs / static_cast<double>(ops) : elapsedNs);
+    }
+    if (benchCase.teardown) {
+        benchCase.teardown();
+    }
+    return result;
+}
+
+struct Summary {
+    double min;
+    double median;
+    double mean;
+    double max;
+};
+
+Summary summarize(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (double value : values) {
+        sum += value;
+    }
+    size_t mid = values.size() / 2;
+    double median = (values.size() % 2 == 1) ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+    return Summary{values.front(), median, sum / static_cast<double>(values.size()), values.back()};
+}
+
+std::string formatResults(const std::vector<CaseResult>& results) {
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(2);
+
+    if (config.format == "json") {
+        out << "{\"benchmark\":\"selfkafka_microbench\",\"warmup\":" << config.warmup
+            << ",\"repetitions\":" << config.repetitions << ",\"results\":[";
+        for (size_t i = 0; i < results.size(); ++i) {
+            Summary s = summarize(results[i].nsPerOp);
+            out << (i ? "," : "") << "{\"name\":\"" << results[i].name << "\",\"ops_per_run\":"
+                << results[i].opsPerRun << ",\"ns_per_op\":{\"min\":" << s.min << ",\"median\":" << s.median
+                << ",\"mean\":" << s.mean << ",\"max\":" << s.max << "},\"ops_per_sec\":"
+                << (s.median > 0 ? 1e9 / s.median : 0.0) << "}";
+        }
+        out << "]}\n";
+    } else if (config.format == "csv") {
+        out << "name,ops_per_run,ns_per_op_min,ns_per_op_median,ns_per_op_mean,ns_per_op_max,ops_per_sec\n";
+        for (const auto& result : results) {
+            Summary s = summarize(result.nsPerOp);
+            out << result.name << ',' << result.opsPerRun << ',' << s.min << ',' << s.median << ',' << s.mean
+                << ',' << s.max << ',' << (s.median > 0 ? 1e9 / s.median : 0.0) << '\n';
+        }
+    } else {
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-48s %12s %12s %12s %14s\n", "benchmark", "min ns/op", "median",
+                      "max", "ops/sec");
+        out << line;
+        for (const auto& result : results) {
+            Summary s = summarize(result.nsPerOp);
+            std::snprintf(line, sizeof(line), "%-48s %12.1f %12.1f %12.1f %14.0f\n", result.name.c_str(), s.min,
+                          s.median, s.max, s.median > 0 ? 1e9 / s.median : 0.0);
+            out << line;
+        }
+    }
+    return out.str();
+}
+
+void printUsage() {
+    std::cout << "Usage: selfkafka_microbench [options]\n"
+              << "  --filter TEXT            run cases whose name contains TEXT\n"
+              << "  --list                   list case names and exit\n"
+              << "  --warmup N               unmeasured runs per case (default 1)\n"
+              << "  --repetitions N          measured runs per case (default 5)\n"
+              << "  --cpus A,B,...           pin the driver and worker threads to these CPUs (Linux)\n"
+              << "  --retention-records N    records in the retention partition (default 10000000)\n"
+              << "  --metadata-partitions N  partitions for the metadata case (default 10000)\n"
+              << "  --format text|json|csv   output format (default text)\n"
+              << "  --output PATH            write results to a file instead of stdout\n";
+}
+
+void parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            std::exit(0);
+        }
+        if (arg == "--list") {
+            config.list = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--filter") {
+            config.filter = value;
+        } else if (arg == "--warmup") {
+            config.warmup = std::stoul(value);
+        } else if (arg == "--repetitions") {
+            config.repetitions = std::stoul(value);
+        } else if (arg == "--cpus") {
+            std::stringstream list(value);
+            std::string cpu;
+            while (std::getline(list, cpu, ',')) {
+                config.cpus.push_back(std::stoi(cpu));
+            }
+        } else if (arg == "--retention-records") {
+            config.retentionRecords = std::stoull(value);
+        } else if (arg == "--metadata-partitions") {
+            config.metadataPartitions = std::stoul(value);
+        } else if (arg == "--format") {
+            config.format = value;
+        } else if (arg == "--output") {
+            config.output = value;
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+
+    if (config.repetitions == 0) {
+        throw std::invalid_argument("Repetitions must be positive");
+    }
+    if (config.format != "text" && config.format != "json" && config.format != "csv") {
+        throw std::invalid_argument("Format must be text, json or csv");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        parseArgs(argc, argv);
+        Metrics::getInstance().setLogLevel(LogLevel::ERROR);
+        pinThread(0);
+
+        std::vector<CaseResult> results;
+        for (auto& benchCase : allCases()) {
+            if (benchCase.name.find(config.filter) == std::string::npos) {
+                continue;
+            }
+            if (config.list) {
+                std::cout << benchCase.name << '\n';
+                continue;
+            }
+            if (config.format == "text") {
+                std::cerr << "running " << benchCase.name << "..." << std::endl;
+            }
+            results.push_back(runCase(benchCase));
+        }
+        if (config.list) {
+            return 0;
+        }
+
+        std::string report = formatResults(results);
+        if (config.output.empty()) {
+            std::cout << report;
+        } else {
+            std::ofstream file(config.output, std::ios::trunc);
+            if (!file) {
+                throw std::runtime_error("Failed to open output file: " + config.output);
+            }
+            file << report;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "selfkafka_microbench: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -10,6 +10,11 @@
 #include "Broker.h"
 #include "Producer.h"
 #include "Consumer.h"
+#include "Metrics.h"
+#include "SchedulingClass.h"
+#include "CoroutineExecutor.h"
+
+#include <atomic>
 
 void demonstrateAsyncWriting() {
     std::cout << "\n=== Async Writing Demo ===" << '\n';
@@ -111,10 +116,91 @@ void demonstrateConcurrentProducers() {
     std::cout << "Concurrent producers demo completed!" << '\n';
 }
 
+void demonstrateSchedulingClasses() {
+    std::cout << "\n=== Scheduling Classes Demo ===" << '\n';
+
+    Broker broker("scheduling-broker");
+    broker.createTopic("orders", 2, SchedulingClass::latencyCritical());
+    broker.createTopic("backfill", 2, SchedulingClass::bulk());
+
+    // Queue a large backfill before the writer starts, then trickle in orders
+    Producer producer(broker);
+    const std::string payload(1024, 'x');
+    for (int i = 0; i < 2000; ++i) {
+        producer.send("backfill", "row" + std::to_string(i), payload);
+    }
+
+    broker.startAsyncWriter();
+    for (int i = 0; i < 20; ++i) {
+        producer.send("orders", "order" + std::to_string(i), "created");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    while (broker.getAsyncQueueSize("backfill") > 0 || broker.getAsyncQueueSize("orders") > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::cout << "orders avg queue delay: "
+              << Metrics::getInstance().getAverageQueueDelay("latency-critical") << "us" << '\n';
+    std::cout << "backfill avg queue delay: "
+              << Metrics::getInstance().getAverageQueueDelay("bulk") << "us" << '\n';
+
+    broker.stopAsyncWriter();
+    std::cout << "Scheduling classes demo completed!" << '\n';
+}
+
+Task<void> produceOrders(Producer& producer, int count) {
+    for (int i = 0; i < count; ++i) {
+        co_await producer.sendAsync("coro-topic", "order" + std::to_string(i), "created");
+    }
+}
+
+Task<void> consumeOrders(Consumer& consumer, int count, std::atomic<int>& consumed) {
+    for (int i = 0; i < count; ++i) {
+        Message message = co_await consumer.next();
+        (void)message;
+        consumed.fetch_add(1);
+    }
+}
+
+void demonstrateCoroutines() {
+    std::cout << "\n=== Coroutine API Demo ===" << '\n';
+
+    Broker broker("coro-broker");
+    broker.createTopic("coro-topic", 4);
+    broker.startAsyncWriter();
+
+    // One executor thread multiplexes the producer and the consumer
+    CoroutineExecutor executor(1);
+    executor.start();
+
+    const int messageCount = 100;
+    Consumer consumer(broker, "coro-topic");
+    Producer producer(broker);
+    std::atomic<int> consumed{0};
+
+    spawn(executor, consumeOrders(consumer, messageCount, consumed));
+    spawn(executor, produceOrders(producer, messageCount));
+
+    while (consumed.load() < messageCount) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::cout << "Consumed " << consumed.load() << " messages on one executor thread ("
+              << executor.getTotalResumed() << " resumptions)" << '\n';
+
+    broker.stopAsyncWriter();
+    executor.stop();
+    executor.join();
+    std::cout << "Coroutine API demo completed!" << '\n';
+}
+
 int main() {
     try {
         demonstrateAsyncWriting();
         demonstrateConcurrentProducers();
+        demonstrateSchedulingClasses();
+        demonstrateCoroutines();
         
         std::cout << "\n=== All async demos completed successfully! ===" << '\n';
 
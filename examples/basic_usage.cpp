@@ -71,6 +71,7 @@ void demonstrateMultiThreading() {
     // Create broker and topic
     Broker broker("thread-broker");
     broker.createTopic("events", 2);
+    broker.startAsyncWriter();
     
     // Producer thread
     std::thread producerThread([&broker]() {
@@ -82,30 +83,19 @@ void demonstrateMultiThreading() {
         std::cout << "Producer finished sending 10 messages" << '\n';
     });
     
-    // Consumer thread
+    // Consumer thread (batch poll across all partitions, no exceptions when idle)
     std::thread consumerThread([&broker]() {
         Consumer consumer(broker, "events");
-        int messagesRead = 0;
+        size_t messagesRead = 0;
         
         while (messagesRead < 10) {
-            bool foundMessage = false;
-            // Try to read from all partitions
-            for (uint32_t partitionId = 0; partitionId < 2; ++partitionId) {
-                try {
-                    Message msg = consumer.poll(partitionId);
-                    std::cout << "Consumer read: " << msg.toString() << '\n';
-                    messagesRead++;
-                    foundMessage = true;
-                    break; // Found a message, exit partition loop
-                } catch (const std::runtime_error&) {
-                    // No message in this partition, try next
+            ConsumerRecords records = consumer.poll(10, 64 * 1024, std::chrono::milliseconds(200));
+            for (const auto& [partitionId, messages] : records) {
+                for (const auto& msg : messages) {
+                    std::cout << "Consumer read from partition " << partitionId << ": " << msg.toString() << '\n';
                 }
             }
-            
-            if (!foundMessage) {
-                // No messages in any partition, wait a bit
-                std::this_thread::sleep_for(std::chrono::milliseconds(50));
-            }
+            messagesRead += records.count();
         }
         std::cout << "Consumer finished reading 10 messages" << '\n';
     });
@@ -113,6 +103,7 @@ void demonstrateMultiThreading() {
     // Wait for threads to complete
     producerThread.join();
     consumerThread.join();
+    broker.stopAsyncWriter();
 }
 
 void demonstratePartitionRouting() {
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap activity seen through the global operator new/delete
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes = 0; // Requested bytes of the counted allocations
+};
+
+// Counts heap allocations per thread and per process. The counting operator new/delete
+// replacements are only compiled in with SELFKAFKA_ALLOC_TRACKING; without it isEnabled()
+// is false and every count stays zero.
+class AllocationTracker {
+public:
+    static bool isEnabled();
+    static AllocationCounts getThreadCounts();  // Calling thread since it started
+    static AllocationCounts getProcessCounts(); // Every thread since the process started
+};
+
+// Measures the allocations made between construction and delta(), either by the calling
+// thread only or by the whole process (for paths that hand work to other threads)
+class AllocationScope {
+public:
+    explicit AllocationScope(bool processWide = false);
+
+    AllocationCounts delta() const;
+
+private:
+    AllocationCounts read() const;
+
+    bool processWide_;
+    AllocationCounts start_;
+};
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <condition_variable>
+
+// Log levels
+enum class LogLevel {
+    DEBUG = 0,
+    INFO = 1,
+    WARN = 2,
+    ERROR = 3
+};
+
+// Logger whose callers only copy a compact binary record (level, timestamp, format
+// string pointer, encoded arguments) into a per-thread single-producer ring. A background
+// thread drains the rings, formats the records in timestamp order and writes each batch
+// with one call. Records are dropped (and counted) when a thread's ring is full, and
+// messages repeated more than the rate limit within a second are folded into a summary.
+// A preformatted message longer than one record's payload (232 bytes) continues in up to
+// kMaxMessageRecords consecutive records. Whatever still does not fit (longer messages,
+// arguments past the payload of a formatted record) is cut, marked "[truncated]" in the
+// line and counted.
+class AsyncLogger {
+public:
+    static constexpr size_t kRingSlots = 512;
+    static constexpr size_t kPayloadBytes = 232;
+    static constexpr size_t kMaxMessageRecords = 16;
+
+    AsyncLogger();
+    ~AsyncLogger();
+
+    // Lifecycle
+    void start();
+    void stop(); // Remaining records are written before the thread exits
+    void join();
+
+    // Logging. format must outlive the logger (a string literal); "{}" marks each argument.
+    void log(LogLevel level, std::string_view message);
+    template <typename... Args>
+    void logf(LogLevel level, const char* format, const Args&... args);
+    void flush(); // Waits until everything logged so far is written
+
+    // Configuration
+    void setOutput(FILE* output);
+    void setRateLimit(size_t messagesPerSecond); // Per message kind; 0 disables the limit
+
+    // Statistics
+    uint64_t getTotalWritten() const;
+    uint64_t getTotalDropped() const;
+    uint64_t getTotalSuppressed() const;
+    uint64_t getTotalTruncated() const;
+    bool isRunning() const;
+
+private:
+    // Record flags
+    static constexpr uint8_t kContinued = 1; // The message continues in the next record
+    static constexpr uint8_t kTruncated = 2; // Part of the message did not fit
+
+    struct Record {
+        uint64_t timestampNs;
+        const char* format; // nullptr: the payload is one preformatted string
+        uint8_t level;
+        uint8_t argCount;
+        uint16_t payloadSize;
+        uint8_t flags;
+        char payload[kPayloadBytes];
+    };
+
+    // Single-producer (the owning thread), single-consumer (the logger thread) ring
+    struct Ring {
+        std::array<Record, kRingSlots> slots;
+        std::atomic<uint64_t> head{0}; // Next slot the logger thread reads
+        std::atomic<uint64_t> tail{0}; // Next slot the owning thread writes
+        std::atomic<bool> abandoned{false};
+    };
+
+    // Repeated-message window of one message kind
+    struct RateWindow {
+        uint64_t second;
+        size_t written;
+        uint64_t suppressed;
+        std::string sample;
+    };
+
+    static uint64_t now();
+    Ring& ringForThread();
+    Record* beginRecord(LogLevel level, const char* format);
+    void commitRecord();
+    static void initRecord(Record& record, LogLevel level, const char* format, uint64_t timestampNs);
+
+    static void encode(Record& record, int64_t value);
+    static void encode(Record& record, uint64_t value);
+    static void encode(Record& record, double value);
+    static void encode(Record& record, std::string_view value);
+    template <typename T>
+    static void encodeArg(Record& record, const T& value);
+
+    void loggerThread();
+    size_t drain(std::vector<Record>& batch);
+    void write(std::vector<Record>& batch);
+    void formatRecord(const Record& record, std::string& message) const;
+    bool admit(const Record& record, const std::string& message, std::string& out);
+    void appendPrefix(std::string& out, uint64_t timestampNs, LogLevel level);
+    void flushRateWindows(uint64_t second, std::string& out, bool all);
+
+    // Rings of every thread that logged (threads hold a reference; abandoned rings are
+    // dropped once drained)
+    std::vector<std::shared_ptr<Ring>> rings_;
+    std::mutex ringsMutex_;
+    const uint64_t instanceId_;
+
+    // Output (logger thread only, once started)
+    FILE* output_;
+    std::atomic<size_t> rateLimit_;
+    std::unordered_map<std::string, RateWindow> rateWindows_;
+    uint64_t cachedSecond_;
+    std::string cachedTime_;
+    uint64_t droppedReported_;
+
+    // Thread management
+    std::thread loggerThread_;
+    std::atomic<bool> running_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    std::condition_variable flushedCv_;
+    uint64_t flushRequests_;
+    uint64_t flushesDone_;
+
+    // Statistics
+    std::atomic<uint64_t> totalWritten_;
+    std::atomic<uint64_t> totalDropped_;
+    std::atomic<uint64_t> totalSuppressed_;
+    std::atomic<uint64_t> totalTruncated_;
+};
+
+// Logging: Encodes the arguments into the calling thread's ring
+template <typename... Args>
+void AsyncLogger::logf(LogLevel level, const char* format, const Args&... args) {
+    Record* record = beginRecord(level, format);
+    if (record == nullptr) {
+        return;
+    }
+    (encodeArg(*record, args), ...);
+    commitRecord();
+}
+
+// Encoding: Maps an argument onto one of the encoded kinds
+template <typename T>
+void AsyncLogger::encodeArg(Record& record, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        encode(record, std::string_view(value ? "true" : "false"));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        encode(record, static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+        encode(record, static_cast<uint64_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        encode(record, static_cast<double>(value));
+    } else {
+        encode(record, std::string_view(value));
+    }
+}
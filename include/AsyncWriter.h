@@ -1,13 +1,17 @@
 #pragma once
 
 #include "MessageQueue.h"
+#include "SchedulingClass.h"
 #include "Topic.h"
+#include "Metrics.h"
 
 #include <thread>
 #include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 #include <unordered_map>
+#include <condition_variable>
 
 // Forward declaration
 class Broker;
@@ -25,6 +29,12 @@ public:
     // Message handling
     void enqueueMessage(const std::string& topicName, const Message& message);
     void enqueueMessage(const std::string& topicName, Message&& message);
+    void enqueueMessage(const std::string& topicName, Message&& message,
+                        std::function<void(std::exception_ptr)> onAppended);
+
+    // Scheduling
+    void setSchedulingClass(const std::string& topicName, const SchedulingClass& schedulingClass);
+    SchedulingClass getSchedulingClass(const std::string& topicName) const;
 
     // Statistics
     size_t getQueueSize(const std::string& topicName) const;
@@ -32,15 +42,45 @@ public:
     bool isRunning() const;
 
 private:
+    // Per-topic writer lane: its queue, scheduling class and DRR deficit
+    struct TopicLane {
+        std::string topicName;
+        std::unique_ptr<MessageQueue> queue;
+        SchedulingClass schedulingClass;
+        uint64_t deficit = 0; // Only touched by the writer thread
+        Metrics::TopicMetrics* metrics = nullptr;
+    };
+
+    // Writer-thread view of a lane (class copied so updates never race the writer)
+    struct ScheduledLane {
+        TopicLane* lane;
+        SchedulingClass schedulingClass;
+        Metrics::SchedulingClassMetrics* classMetrics;
+    };
+    using Schedule = std::vector<std::vector<ScheduledLane>>;
+
     void writerThread();
-    MessageQueue& getOrCreateQueue(const std::string& topicName);
+    bool serveRound(std::vector<ScheduledLane>& lanes);
+    void writeMessage(const ScheduledLane& scheduled, QueuedMessage& entry);
+    void failUnwritten();
+    void refreshSchedule(Schedule& schedule, uint64_t& scheduleVersion);
+    TopicLane& getOrCreateLane(const std::string& topicName);
+    void notifyWriter();
 
     Broker& broker_;
     std::thread writerThread_;
     std::atomic<bool> running_;
     std::atomic<size_t> totalProcessedMessages_;
-    
-    // Topic queues
-    std::unordered_map<std::string, std::unique_ptr<MessageQueue>> topicQueues_;
-    mutable std::mutex queuesMutex_;
+
+    // Topic lanes (never removed, so raw pointers stay valid for the writer thread)
+    std::unordered_map<std::string, std::unique_ptr<TopicLane>> topicLanes_;
+    std::vector<TopicLane*> laneOrder_; // Creation order, for a stable round-robin
+    std::atomic<uint64_t> lanesVersion_;
+    mutable ProfiledMutex<"AsyncWriter::queuesMutex_"> queuesMutex_;
+
+    // Idle wake-up
+    std::atomic<uint64_t> pendingMessages_;
+    std::atomic<bool> writerIdle_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
 };
@@ -3,10 +3,19 @@
 #include "Topic.h"
 #include "Message.h"
 #include "AsyncWriter.h"
+#include "SchedulingClass.h"
+#include "OffsetStore.h"
+#include "TimerWheel.h"
+#include "GroupMetadataStore.h"
+#include "LagTracker.h"
+#include "MetricsSnapshot.h"
+#include "ProfiledMutex.h"
 
 #include <thread>
 #include <unordered_map>
 #include <memory>
+#include <exception>
+#include <functional>
 
 // Forward declaration
 class RetentionCleaner;
@@ -17,6 +26,21 @@ struct PartitionMetadata {
     uint64_t messageCount;
     uint64_t firstOffset;
     uint64_t lastOffset;
+    ThroughputRates throughput;
+};
+
+struct PartitionLag {
+    uint32_t partitionId;
+    uint64_t logEndOffset;
+    uint64_t committedOffset; // 0 when the group has not committed this partition
+    uint64_t lag;
+};
+
+struct GroupLag {
+    std::string groupId;
+    std::string topicName;
+    std::vector<PartitionLag> partitions;
+    uint64_t totalLag;
 };
 
 struct TopicMetadata {
@@ -24,24 +48,41 @@ struct TopicMetadata {
     size_t numPartitions;
     std::vector<PartitionMetadata> partitions;
     uint64_t totalMessages;
+    ThroughputRates throughput;
 };
 
 class Broker {
 public:
     explicit Broker(std::string id);
+    Broker(std::string id, std::string dataDirectory); // Persists committed offsets under dataDirectory
     ~Broker();
 
-    void createTopic(const std::string topicName, size_t numPartitions);
+    void createTopic(const std::string topicName, size_t numPartitions,
+                     const SchedulingClass& schedulingClass = SchedulingClass());
     bool hasTopic(const std::string& topicName) const;
     
     // Async operations (non-blocking)
     void append(const std::string& topicName, const Message& message);
     void send(const std::string& topicName, const std::string& key, const std::string& value);
+    void send(const std::string& topicName, const std::string& key, const std::string& value,
+              std::function<void(std::exception_ptr)> onAppended);
     
     // Sync operations (for internal use by AsyncWriter)
     void appendSync(const std::string& topicName, const Message& message);
+    void appendSync(const std::string& topicName, Message&& message);
 
     std::vector<Message> getMessages(const std::string& topicName, uint32_t partitionId, uint64_t from, uint64_t to) const;
+    std::vector<Message> fetch(const std::string& topicName, uint32_t partitionId, uint64_t from,
+                               size_t maxRecords, uint64_t maxBytes) const;
+    size_t getNumPartitions(const std::string& topicName) const;
+    uint64_t getLogEndOffset(const std::string& topicName, uint32_t partitionId) const;
+    
+    // Append notifications (for readers waiting on new data)
+    uint64_t getAppendCount(const std::string& topicName) const;
+    bool waitForAppend(const std::string& topicName, uint64_t seenAppends, std::chrono::milliseconds timeout) const;
+    void notifyOnAppend(const std::string& topicName, uint64_t seenAppends, std::function<void()> callback) const;
+    void notifyWhenAvailable(const std::string& topicName, uint32_t partitionId, uint64_t offset,
+                             std::function<void()> callback) const;
     std::vector<std::string> listTopics() const;
     std::string getId() const;
     
@@ -50,6 +91,26 @@ public:
     void stopAsyncWriter();
     size_t getAsyncQueueSize(const std::string& topicName) const;
     size_t getTotalProcessedMessages() const;
+    void setSchedulingClass(const std::string& topicName, const SchedulingClass& schedulingClass);
+    SchedulingClass getSchedulingClass(const std::string& topicName) const;
+    
+    // Committed offsets (durable when the broker has a data directory)
+    void commitOffset(const std::string& groupId, const std::string& topicName, uint32_t partitionId, uint64_t offset);
+    void commitOffsetAsync(const std::string& groupId, const std::string& topicName, uint32_t partitionId, uint64_t offset);
+    std::optional<uint64_t> getCommittedOffset(const std::string& groupId, const std::string& topicName, uint32_t partitionId) const;
+    void flushCommittedOffsets();
+    
+    // Consumer lag (log end offset minus committed offset), kept current on append and commit
+    GroupLag getGroupLag(const std::string& groupId, const std::string& topicName) const;
+    uint64_t getTotalGroupLag(const std::string& groupId, const std::string& topicName) const; // O(1)
+    
+    // Session timers shared by the consumer groups of this broker
+    TimerWheel& getSessionTimers();
+    
+    // Consumer group metadata backend: embedded (under the data directory) when the broker
+    // has one, PostgreSQL otherwise; created on first use unless set explicitly
+    std::shared_ptr<GroupMetadataStore> getGroupMetadataStore();
+    void setGroupMetadataStore(std::shared_ptr<GroupMetadataStore> store);
     
     // Retention management
     void startRetentionCleaner();
@@ -61,16 +122,36 @@ public:
     std::vector<TopicMetadata> getTopicsMetadata() const;
     std::vector<PartitionMetadata> getPartitionMetadata(const std::string& topicName) const;
     
+    // Metrics export: process-wide metrics plus this broker's partitions, groups and threads
+    MetricsSnapshot metricsSnapshot() const;
+    void collectMetrics(MetricsSnapshot& snapshot) const;
+    
 private:
     std::string id_;
+    std::string dataDirectory_;
     std::unordered_map<std::string, std::shared_ptr<Topic>> topics_; 
-    mutable std::mutex mutex_; // Mutex to protect the topics_ map
+    mutable ProfiledMutex<"Broker::mutex_"> mutex_; // Mutex to protect the topics_ map
     
     // Async writer
     std::unique_ptr<AsyncWriter> asyncWriter_;
     
     // Retention cleaner
     std::unique_ptr<RetentionCleaner> retentionCleaner_;
+    
+    // Committed offsets (__consumer_offsets log)
+    std::unique_ptr<OffsetStore> offsetStore_;
+    std::unique_ptr<LagTracker> lagTracker_;
+    
+    // Consumer session deadlines
+    std::unique_ptr<TimerWheel> sessionTimers_;
+    
+    // Consumer group metadata
+    std::shared_ptr<GroupMetadataStore> groupMetadataStore_;
+    std::mutex groupMetadataMutex_;
 
     void checkTopicExists(const std::string& topicName) const;
+    std::shared_ptr<Topic> getTopic(const std::string& topicName) const;
+    void refreshGroupLag(const std::string& groupId, const std::string& topicName) const;
+    void recordFetched(const std::string& topicName, Partition& partition, const std::vector<Message>& messages,
+                       uint64_t startTicks) const;
 };
\ No newline at end of file
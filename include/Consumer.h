@@ -2,10 +2,17 @@
 
 #include "Broker.h"
 #include "Message.h"
+#include "ConsumerRecords.h"
+#include "Fetcher.h"
+#include "Task.h"
+#include "Metrics.h"
 
 #include <chrono>
+#include <deque>
 #include <mutex>
+#include <memory>
 #include <string>
+#include <vector>
 #include <cstdint>
 #include <unordered_map>
 #include <condition_variable>
@@ -13,18 +20,58 @@
 class Consumer {
 public:
     explicit Consumer(Broker& broker, const std::string& topicName);
+    Consumer(Broker& broker, const std::string& topicName, const std::string& groupId);
+    ~Consumer();
+
+    // Batch poll across all assigned partitions (empty result means no data, never throws for it)
+    ConsumerRecords poll(size_t maxRecords, uint64_t maxBytes, std::chrono::milliseconds timeout);
 
     Message poll(uint32_t partitionId);
     void waitForMessage(uint32_t partitionId);
 
+    // Coroutine API: suspends instead of blocking and is resumed by append notifications
+    // on the awaiting coroutine's executor (the consumer must outlive the returned tasks)
+    Task<Message> next();
+    Task<ConsumerRecords> pollAsync(size_t maxRecords, uint64_t maxBytes);
+    Task<void> waitForMessageAsync(uint32_t partitionId);
+
+    // Assignment (defaults to every partition of the topic)
+    void assign(const std::vector<uint32_t>& partitions);
+    std::vector<uint32_t> assignment() const;
+
+    // Prefetching (own fetcher thread, or a fetcher shared with other consumers)
+    void enablePrefetch(uint64_t maxBufferedBytes);
+    void enablePrefetch(Fetcher& fetcher, uint64_t maxBufferedBytes);
+
+    // Offsets (committed to the broker's offset log when the consumer has a group)
     void commit(uint32_t partitionId, uint64_t offset);
+    void commitAsync(uint32_t partitionId, uint64_t offset);
+    void commitAsync();
+    void commitSync();
     uint64_t position(uint32_t partitionId) const;
+    const std::string& getGroupId() const;
+    void seek(uint32_t partitionId, uint64_t offset);
     void reset(uint32_t partitionId);
 
 private:
+    void ensureAssignment();
+    uint64_t& positionFor(uint32_t partitionId);
+    std::vector<std::pair<uint32_t, uint64_t>> currentPositions() const;
+    void fetchAssigned(ConsumerRecords& records, size_t maxRecords, uint64_t maxBytes);
+    void recordDelivered(const std::vector<Message>& messages);
+    void dropPendingRecords(uint32_t partitionId);
+
     Broker& broker_;
     std::string topicName_;
-    std::unordered_map<uint32_t, uint64_t> offsets_;
+    std::string groupId_;
+    std::unordered_map<uint32_t, uint64_t> offsets_; // Next offset to fetch per partition
+    std::deque<std::pair<uint32_t, Message>> pendingRecords_; // Fetched by next() but not yet returned
+    std::vector<uint32_t> assignment_;
+    bool assigned_;              // False until assign() or the first batch poll resolves all partitions
+    size_t nextPartitionIndex_;  // Rotates the first partition fetched so limits are shared fairly
+    std::unique_ptr<Fetcher> ownedFetcher_;      // Set by enablePrefetch(bytes)
+    std::shared_ptr<FetchSession> fetchSession_; // Declared after ownedFetcher_ so it is released first
+    Metrics::TopicMetrics* metrics_;             // End-to-end latency histogram of the topic
     mutable std::mutex mutex_;   // Mutex to protect the offsets_ map
     mutable std::condition_variable cv_; // Condition variable to notify when a new message is available
-};
\ No newline at end of file
+};
@@ -2,18 +2,33 @@
 
 #include "Broker.h"
 #include "Consumer.h"
+#include "TimerWheel.h"
+#include "GroupMetadataWriter.h"
 
 #include <algorithm>
 #include <iostream>
-#include <libpq-fe.h>
+#include <functional>
+#include <unordered_set>
+
+// Callbacks for incremental rebalances. Revocations are delivered (and the consumers'
+// assignments narrowed) before any moved partition is handed to its new owner. They
+// run under the group lock and must not call back into the group.
+struct RebalanceListener {
+    std::function<void(const std::string& consumerId, const std::vector<uint32_t>& partitions)> onPartitionsRevoked;
+    std::function<void(const std::string& consumerId, const std::vector<uint32_t>& partitions)> onPartitionsAssigned;
+};
 
 class ConsumerGroup {
 public:
     explicit ConsumerGroup(const std::string& groupId, Broker& broker, const std::string& topicName);
+    ConsumerGroup(const std::string& groupId, Broker& broker, const std::string& topicName,
+                  std::shared_ptr<GroupMetadataStore> store);
     ~ConsumerGroup();
 
-    void addConsumer(std::shared_ptr<Consumer> consumer);
+    std::string addConsumer(std::shared_ptr<Consumer> consumer);
+    std::string addConsumer(std::shared_ptr<Consumer> consumer, const std::string& groupInstanceId); // Static member
     void removeConsumer(std::shared_ptr<Consumer> consumer);
+    void removeStaticMember(const std::string& groupInstanceId);
     void sendHeartbeat(const std::string& consumerId);
 
     void start();
@@ -24,13 +39,28 @@ public:
     std::string getGroupId() const;
     std::vector<std::string> getActiveConsumers() const;
     bool isConsumerActive(const std::string& consumerId) const;
+    void setSessionTimeout(std::chrono::seconds timeout); // Applies to sessions armed afterwards
+    void setStaticMemberGracePeriod(std::chrono::seconds gracePeriod);
 
+    // Rebalancing (sticky and cooperative: only partitions that must move are revoked)
     void rebalance();
+    void setRebalanceListener(RebalanceListener listener);
+    uint64_t getRebalanceCount() const;
+    uint64_t getPartitionMovements() const;
+    uint64_t getStaticRejoinCount() const;
 
 private:
-    void heartbeatMonitor();
-    void saveToDatabase();
-    void loadFromDatabase();
+    void rebalanceLocked();
+    void removeConsumerLocked(const std::string& consumerId);
+    void departStaticMemberLocked(const std::string& consumerId);
+    bool isMemberLocked(const std::string& consumerId) const;
+    void assignLocked(const std::string& consumerId);
+    void scheduleSessionLocked(const std::string& consumerId);
+    void scheduleGraceLocked(const std::string& consumerId);
+    void expireSession(const std::string& consumerId, TimerWheel::TimerId timerId);
+    void expireDepartedMember(const std::string& consumerId, TimerWheel::TimerId timerId);
+    void saveMetadata();   // Hands a snapshot to the metadata writer; caller holds consumersMutex_
+    void loadMetadata();
 
     // Core data
     std::string groupId_;
@@ -40,18 +70,32 @@ private:
     // Consumer management
     std::vector<std::shared_ptr<Consumer>> consumers_;
     std::unordered_map<std::string, std::shared_ptr<Consumer>> consumersMap_; 
-    std::unordered_map<uint32_t, std::shared_ptr<Consumer>> partitionAssignments_;
+    std::unordered_map<uint32_t, std::string> partitionAssignments_;           // partition -> owner id
+    std::unordered_map<std::string, std::vector<uint32_t>> memberAssignments_; // owner id -> partitions
+    RebalanceListener rebalanceListener_;
+    uint64_t rebalanceCount_{0};
+    uint64_t partitionMovements_{0};
     std::unordered_map<std::string, std::chrono::system_clock::time_point> lastHeartbeats_;
     
-    // Threads
-    std::thread heartbeatMonitorThread_; // Thread to monitor heartbeats
-    std::atomic<bool> running_; // Flag to indicate if the consumer group is running
-    mutable std::mutex consumersMutex_; // Mutex to protect the consumers_ vector
+    // Static membership: ids supplied by the caller survive restarts; a departed static
+    // member keeps its partitions until its grace timer fires
+    struct DepartedMember {
+        TimerWheel::TimerId graceTimer = 0;
+        std::chrono::system_clock::time_point departedAt;
+    };
+    std::unordered_set<std::string> staticMembers_;
+    std::unordered_map<std::string, DepartedMember> departedMembers_;
+    uint64_t staticRejoins_{0};
+    
+    // Session tracking (deadlines live on the broker's shared timer wheel)
+    std::unordered_map<std::string, TimerWheel::TimerId> sessionTimers_;
+    std::atomic<bool> running_; // Flag to indicate if session expiry is active
+    mutable ProfiledMutex<"ConsumerGroup::consumersMutex_"> consumersMutex_; // Mutex to protect the consumers_ vector
 
     // Configuration
     std::chrono::seconds heartbeatTimeout_{90};
+    std::chrono::seconds staticGracePeriod_{90};
     
-    // PostgreSQL connection
-    PGconn* connection_;
-    std::string connectionString_;
+    // Metadata persistence (written in the background)
+    std::unique_ptr<GroupMetadataWriter> metadataWriter_;
 };
\ No newline at end of file
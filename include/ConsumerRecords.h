@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Message.h"
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+// Batch of records returned by Consumer::poll, grouped by partition
+class ConsumerRecords {
+public:
+    using PartitionRecords = std::pair<uint32_t, std::vector<Message>>;
+    using const_iterator = std::vector<PartitionRecords>::const_iterator;
+
+    ConsumerRecords();
+
+    // Building (used by Consumer)
+    void add(uint32_t partitionId, std::vector<Message>&& messages);
+
+    // Accessors
+    const std::vector<Message>& records(uint32_t partitionId) const;
+    std::vector<uint32_t> partitions() const;
+    size_t count() const;
+    uint64_t sizeBytes() const;
+    bool empty() const;
+
+    // Iteration over (partitionId, messages) pairs
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+    std::vector<PartitionRecords> partitions_;
+    size_t count_;
+    uint64_t sizeBytes_;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Task.h"
+
+#include <deque>
+#include <memory>
+#include <utility>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <coroutine>
+#include <exception>
+#include <condition_variable>
+
+// Small thread pool that resumes coroutines. Awaitables in Consumer and Producer post
+// the waiting coroutine back to the executor it was running on when data arrives, so
+// one executor thread can multiplex many partitions and producers.
+class CoroutineExecutor {
+public:
+    explicit CoroutineExecutor(size_t numThreads = 1);
+    ~CoroutineExecutor();
+
+    // Lifecycle
+    void start();
+    void stop();
+    void join();
+
+    // Scheduling
+    void post(std::coroutine_handle<> handle);
+    static CoroutineExecutor* current(); // Executor of the calling thread, or nullptr
+
+    // Awaitable that moves the awaiting coroutine onto this executor
+    struct ScheduleAwaiter {
+        CoroutineExecutor& executor;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+        void await_resume() const noexcept {}
+    };
+    ScheduleAwaiter schedule();
+
+    // Statistics
+    size_t getPendingCount() const;
+    uint64_t getTotalResumed() const;
+    bool isRunning() const;
+
+private:
+    void workerThread();
+
+    size_t numThreads_;
+    std::vector<std::thread> workers_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> totalResumed_;
+
+    std::deque<std::coroutine_handle<>> ready_;
+    mutable std::mutex readyMutex_; // Mutex to protect the ready_ queue
+    std::condition_variable readyCv_;
+};
+
+// Resumes 'handle' on 'executor', or inline on the calling thread when there is none
+void resumeOn(CoroutineExecutor* executor, std::coroutine_handle<> handle);
+
+// Awaitable completed by a one-shot callback. 'registerCallback' receives a callable
+// (optionally taking a std::exception_ptr) to hand to a notification source. The
+// coroutine resumes on the executor it was running on; if the callback fires before
+// the coroutine suspends (data already there), it simply continues without suspending.
+// The callback only holds the shared completion state, so one that fires after the
+// awaiting coroutine was destroyed (its Task dropped) is ignored.
+template <typename Register>
+class CallbackAwaiter {
+public:
+    explicit CallbackAwaiter(Register registerCallback) :
+        registerCallback_(std::move(registerCallback)),
+        state_(std::make_shared<State>()) {}
+
+    CallbackAwaiter(const CallbackAwaiter&) = delete;
+    CallbackAwaiter& operator=(const CallbackAwaiter&) = delete;
+    ~CallbackAwaiter() {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->abandoned = true;
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        state_->executor = CoroutineExecutor::current();
+        state_->handle = handle;
+        registerCallback_([state = state_](std::exception_ptr error = nullptr) {
+            bool resume;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->abandoned) {
+                    return;
+                }
+                state->error = error;
+                resume = std::exchange(state->completed, true);
+            }
+            if (resume) {
+                resumeOn(state->executor, state->handle);
+            }
+        });
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return !std::exchange(state_->completed, true);
+    }
+
+    void await_resume() const {
+        if (state_->error) {
+            std::rethrow_exception(state_->error);
+        }
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        CoroutineExecutor* executor = nullptr;
+        std::coroutine_handle<> handle;
+        std::exception_ptr error;
+        bool completed = false; // Set by whichever of callback/suspend runs first
+        bool abandoned = false; // Awaiter destroyed, the handle must not be resumed
+    };
+
+    Register registerCallback_;
+    std::shared_ptr<State> state_;
+};
+
+// Runs a task to completion on the executor without anyone awaiting it (errors are logged)
+void spawn(CoroutineExecutor& executor, Task<void> task);
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Message.h"
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <condition_variable>
+
+// Forward declaration
+class Broker;
+class Fetcher;
+
+// Per-consumer prefetch buffers, filled by a Fetcher thread ahead of the consumer's position
+class FetchSession {
+public:
+    FetchSession(Fetcher& fetcher, std::string topicName, uint64_t maxBufferedBytes);
+
+    // Consumer side
+    size_t take(uint32_t partitionId, uint64_t position, size_t maxRecords, uint64_t maxBytes,
+                std::vector<Message>& out);
+    void advance(uint32_t partitionId, uint64_t position); // After a direct fetch
+    void assign(const std::vector<uint32_t>& partitions);
+    void seek(uint32_t partitionId, uint64_t offset);
+    void close();
+
+    // Statistics
+    uint64_t getBufferedBytes() const;
+    const std::string& getTopicName() const;
+    bool isClosed() const;
+
+private:
+    friend class Fetcher;
+
+    struct PartitionBuffer {
+        std::deque<Message> messages;
+        uint64_t nextFetchOffset = 0; // Offset the fetcher will request next
+        uint64_t bytes = 0;
+        uint64_t epoch = 0;           // Bumped on seek so in-flight fetches are discarded
+    };
+
+    struct FetchTarget {
+        uint32_t partitionId;
+        uint64_t offset;
+        uint64_t budgetBytes;
+        uint64_t epoch;
+    };
+
+    std::vector<FetchTarget> collectTargets() const;
+    void deliver(const FetchTarget& target, std::vector<Message>&& messages);
+    void resetBuffer(PartitionBuffer& buffer, uint64_t offset);
+    bool skipBelow(PartitionBuffer& buffer, uint64_t position);
+
+    Fetcher& fetcher_;
+    std::string topicName_;
+    uint64_t maxBufferedBytes_;
+    std::unordered_map<uint32_t, PartitionBuffer> buffers_;
+    uint64_t bufferedBytes_;
+    std::atomic<bool> closed_;
+    mutable std::mutex mutex_; // Mutex to protect the buffers_ map
+};
+
+class Fetcher {
+public:
+    explicit Fetcher(Broker& broker);
+    ~Fetcher();
+
+    // Lifecycle
+    void start();
+    void stop();
+    void join();
+
+    // Sessions (one per consumer; a single Fetcher can be shared by many consumers)
+    std::shared_ptr<FetchSession> openSession(const std::string& topicName, uint64_t maxBufferedBytes);
+
+    // Wakes the fetcher thread (buffer space freed, seek, new session)
+    void notify();
+
+    // Statistics
+    uint64_t getTotalFetchedMessages() const;
+    bool isRunning() const;
+
+    // Configuration
+    void setMaxRecordsPerFetch(size_t maxRecords);
+
+private:
+    void fetcherThread();
+    bool fillSession(FetchSession& session);
+
+    Broker& broker_;
+    std::thread fetcherThread_;
+    std::atomic<bool> running_;
+    std::atomic<size_t> maxRecordsPerFetch_;
+    std::atomic<uint64_t> totalFetchedMessages_;
+
+    std::vector<std::weak_ptr<FetchSession>> sessions_;
+    std::mutex sessionsMutex_;
+
+    // Idle wake-up
+    std::atomic<bool> wakeRequested_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "GroupMetadataStore.h"
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+
+// Embedded group metadata backend: each diff is one checksummed record appended to
+// <directory>/journal.log, and every group's full state is periodically written to
+// <directory>/snapshot.log so the journal can be truncated. Recovery replays the
+// snapshot, then the journal, dropping a torn tail. Appends go to the page cache
+// (they survive a process crash); setSyncWrites(true) also fsyncs every append.
+class FileGroupStore : public GroupMetadataStore {
+public:
+    explicit FileGroupStore(std::string directory);
+    ~FileGroupStore() override;
+
+    GroupState load(const std::string& groupId, const std::string& topicName) override;
+    bool apply(const std::string& groupId, const std::string& topicName, const GroupStateDiff& diff) override;
+    bool isAvailable() const override;
+    std::string getName() const override;
+
+    // Configuration
+    void setSyncWrites(bool syncWrites);
+    void setSnapshotThreshold(uint64_t journalRecords);
+
+    // Statistics
+    uint64_t getTotalAppends() const;
+    uint64_t getTotalSnapshots() const;
+
+private:
+    static void encodeRecord(std::string& buffer, const std::string& groupId, const std::string& topicName,
+                             const GroupStateDiff& diff);
+    static void applyToState(GroupState& state, const GroupStateDiff& diff);
+    size_t replay(const std::string& path); // Returns the length of the valid prefix
+    void snapshot();
+
+    std::string directory_;
+    std::string journalPath_;
+    std::string snapshotPath_;
+    int journalFd_;
+    uint64_t journalLength_; // Bytes of complete appends; a failed append is cut back to it
+
+    // Latest state of every group (guarded by mutex_, as are the journal files and journalLength_)
+    std::unordered_map<std::string, GroupState> groups_;
+    uint64_t recordsInJournal_;
+    mutable std::mutex mutex_;
+
+    // Configuration
+    std::atomic<bool> syncWrites_;
+    std::atomic<uint64_t> snapshotThreshold_;
+
+    // Statistics
+    std::atomic<uint64_t> totalAppends_;
+    std::atomic<uint64_t> totalSnapshots_;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "GroupState.h"
+
+#include <string>
+
+// Backend that persists consumer group membership and assignments. Implementations
+// are shared by all groups of a broker and must be safe to call from several threads.
+class GroupMetadataStore {
+public:
+    virtual ~GroupMetadataStore() = default;
+
+    // Returns the stored state of a group, registering the group if it is new
+    virtual GroupState load(const std::string& groupId, const std::string& topicName) = 0;
+
+    // Applies a diff atomically; on failure the stored group is left unchanged
+    virtual bool apply(const std::string& groupId, const std::string& topicName, const GroupStateDiff& diff) = 0;
+
+    // False when the backend cannot persist anything (e.g. no database connection)
+    virtual bool isAvailable() const = 0;
+
+    // Backend name for logs
+    virtual std::string getName() const = 0;
+};
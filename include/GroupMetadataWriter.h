@@ -0,0 +1,63 @@
+#pragma once
+
+#include "GroupMetadataStore.h"
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <optional>
+#include <condition_variable>
+
+// Persists consumer group snapshots off the group's lock. Submitted snapshots are
+// coalesced; the writer thread diffs the latest one against what it last persisted and
+// hands only the changed rows to the GroupMetadataStore.
+class GroupMetadataWriter {
+public:
+    GroupMetadataWriter(std::shared_ptr<GroupMetadataStore> store, std::string groupId, std::string topicName);
+    ~GroupMetadataWriter();
+
+    // Lifecycle
+    void start();
+    void stop(); // The last submitted snapshot is still written before the thread exits
+    void join();
+
+    // Persistence
+    GroupState load(); // Reads the stored group (creating it if missing); call before start()
+    void submit(GroupState state);
+    void flush();      // Waits until every snapshot submitted so far has been attempted
+
+    // Statistics
+    bool isAvailable() const;
+    uint64_t getTotalWrites() const;
+    uint64_t getTotalCoalesced() const;
+    bool isRunning() const;
+
+private:
+    void writerThread();
+
+    std::shared_ptr<GroupMetadataStore> store_;
+    std::string groupId_;
+    std::string topicName_;
+
+    // Last snapshot known to be in the store (writer thread only once started)
+    GroupState persisted_;
+
+    // Latest snapshot not yet written
+    std::optional<GroupState> pending_;
+    uint64_t submittedSequence_;
+    uint64_t attemptedSequence_;
+    std::mutex mutex_;
+    std::condition_variable pendingCv_;
+    std::condition_variable attemptedCv_;
+
+    // Thread management
+    std::thread writerThread_;
+    std::atomic<bool> running_;
+
+    // Statistics
+    std::atomic<uint64_t> totalWrites_;
+    std::atomic<uint64_t> totalCoalesced_;
+};
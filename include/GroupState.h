@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+// Persistable snapshot of a consumer group: its members and who owns which partition
+struct GroupState {
+    std::string groupId;
+    std::string topicName;
+    std::unordered_map<std::string, std::chrono::system_clock::time_point> members; // consumer -> last heartbeat
+    std::unordered_map<uint32_t, std::string> assignments;                           // partition -> consumer
+};
+
+// Row-level changes that turn one persisted snapshot into the next
+struct GroupStateDiff {
+    std::vector<std::pair<std::string, std::chrono::system_clock::time_point>> upsertedMembers;
+    std::vector<std::string> removedMembers;
+    std::vector<std::pair<uint32_t, std::string>> upsertedAssignments;
+    std::vector<uint32_t> removedAssignments;
+
+    static GroupStateDiff between(const GroupState& before, const GroupState& after);
+    bool empty() const;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+// Groups consuming one topic, resolved once per topic and kept on the Topic, so an append
+// refreshes their lag gauges under this topic's lock only, with no map lookup
+class TopicLag {
+public:
+    void refresh(uint64_t logEndSum) const;
+
+private:
+    friend class LagTracker;
+    struct Entry;
+
+    std::vector<const Entry*> groups_; // Into LagTracker::offsets_
+    std::atomic<bool> tracking_{false}; // Any group committed; appends skip the lock until then
+    mutable std::mutex mutex_;
+};
+
+// One group's offsets on one topic; the sum is atomic so a topic refresh reads it
+// without the tracker lock
+struct TopicLag::Entry {
+    std::string groupId;
+    std::string topicName;
+    std::unordered_map<uint32_t, uint64_t> committed; // Guarded by the tracker lock
+    std::atomic<uint64_t> committedSum{0};
+    std::atomic<uint64_t>* lagGauge = nullptr;
+};
+
+// Committed offsets per group and topic, with a running sum per (group, topic) so that
+// total lag is the topic's log end offset sum minus one number, without scanning. The
+// consumer lag gauge of every tracked group is refreshed on commits and on appends.
+class LagTracker {
+public:
+    LagTracker();
+
+    // Updates
+    void recordCommit(const std::string& groupId, const std::string& topicName, uint32_t partitionId, uint64_t offset);
+    uint64_t updateLag(const std::string& groupId, const std::string& topicName, uint64_t logEndSum);
+
+    // Lookup
+    uint64_t getCommittedSum(const std::string& groupId, const std::string& topicName) const;
+    std::optional<uint64_t> getCommittedOffset(const std::string& groupId, const std::string& topicName,
+                                               uint32_t partitionId) const;
+    std::vector<std::pair<std::string, std::string>> getTrackedGroups() const; // (group, topic)
+    std::shared_ptr<TopicLag> getTopicLag(const std::string& topicName); // Created on first use
+
+private:
+    using GroupTopicOffsets = TopicLag::Entry;
+
+    static std::string makeKey(const std::string& groupId, const std::string& topicName);
+    static uint64_t lagOf(const GroupTopicOffsets& entry, uint64_t logEndSum);
+    std::shared_ptr<TopicLag>& topicLagLocked(const std::string& topicName);
+
+    std::unordered_map<std::string, GroupTopicOffsets> offsets_;
+    std::unordered_map<std::string, std::shared_ptr<TopicLag>> topics_;
+    mutable std::mutex mutex_;
+};
+
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ShardedCounter.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Percentiles of a histogram at one point in time (all values in nanoseconds)
+struct LatencySnapshot {
+    uint64_t count = 0;
+    double mean = 0.0;
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+};
+
+// HDR-style latency histogram: log-linear buckets with 32 sub-buckets per power of two
+// (under 3.2% relative error) from 1ns to ~4.8 hours. Recording is a relaxed increment on
+// the calling thread's shard, allocated on first use; reads merge the shards.
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBucketBits = 6;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits; // Linear range [0, 64)
+    static constexpr size_t kHalfSubBuckets = kSubBuckets / 2;
+    static constexpr size_t kMaxValueBits = 44;
+    static constexpr size_t kBuckets = kSubBuckets + (kMaxValueBits - kSubBucketBits) * kHalfSubBuckets;
+    static constexpr size_t kShards = 8;
+
+    LatencyHistogram() = default;
+    ~LatencyHistogram();
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // Recording
+    void record(std::chrono::nanoseconds latency);
+    void recordValue(uint64_t nanos);
+
+    // Reads
+    LatencySnapshot snapshot() const;
+    uint64_t getCount() const;
+    void reset();
+
+    // Bucket layout
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index); // Largest value mapped to the bucket
+
+private:
+    struct Shard {
+        std::array<std::atomic<uint64_t>, kBuckets> counts{};
+        std::atomic<uint64_t> total{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+    };
+
+    Shard& shardForThread();
+
+    std::array<std::atomic<Shard*>, kShards> shards_{};
+};
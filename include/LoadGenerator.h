@@ -0,0 +1,152 @@
+#pragma once
+
+#include "Broker.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+// Key choice per message: uniform over N keys, Zipfian (rank r drawn with probability
+// proportional to 1 / r^s) or hotspot (a fraction of the keys receives a fixed share of
+// the traffic). Keys are named "key-<index>".
+class KeyDistribution {
+public:
+    enum class Kind { Uniform, Zipfian, Hotspot };
+
+    static KeyDistribution uniform(uint64_t keys);
+    static KeyDistribution zipfian(uint64_t keys, double exponent);
+    static KeyDistribution hotspot(uint64_t keys, double hotKeyFraction, double hotTrafficFraction);
+    static KeyDistribution parse(const std::string& spec, uint64_t keys); // uniform | zipf:S | hotspot:KEYS:TRAFFIC
+
+    uint64_t next(std::mt19937_64& rng) const; // Key index in [0, keys)
+    uint64_t getKeyCount() const;
+    std::string describe() const;
+
+private:
+    KeyDistribution(Kind kind, uint64_t keys);
+
+    Kind kind_;
+    uint64_t keys_;
+    double exponent_;
+    double hotKeyFraction_;
+    double hotTrafficFraction_;
+    std::vector<double> cdf_; // Zipfian only: cumulative probability of ranks 1..keys
+};
+
+// Payload size per message from a weighted histogram of [min, max] byte ranges, each
+// sampled uniformly: "64-256:70,256-4096:25,4096-65536:5" or "fixed:N"
+class PayloadSizeDistribution {
+public:
+    struct Bucket {
+        size_t minBytes;
+        size_t maxBytes;
+        double weight;
+    };
+
+    static PayloadSizeDistribution fixed(size_t bytes);
+    static PayloadSizeDistribution parse(const std::string& spec);
+
+    explicit PayloadSizeDistribution(std::vector<Bucket> buckets);
+
+    size_t next(std::mt19937_64& rng) const;
+    size_t getMaxBytes() const;
+    std::string describe() const;
+
+private:
+    std::vector<Bucket> buckets_;
+    std::vector<double> cdf_; // Cumulative bucket weight, normalized to 1
+};
+
+// Target produce rate (messages/sec) over time: constant, diurnal (a day compressed into
+// a period, rate = mean * (1 + amplitude * sin(2*pi*t / period))) or bursts (peak rate for
+// the first burstLength seconds of every period, base rate otherwise)
+class RateSchedule {
+public:
+    enum class Kind { Constant, Diurnal, Burst };
+
+    static RateSchedule constant(double rate);
+    static RateSchedule diurnal(double meanRate, double amplitude, double periodSeconds);
+    static RateSchedule burst(double baseRate, double peakRate, double periodSeconds, double burstSeconds);
+    static RateSchedule parse(const std::string& spec); // constant:R | diurnal:MEAN:AMP:PERIOD | burst:BASE:PEAK:PERIOD:LEN
+
+    double rateAt(double elapsedSeconds) const;
+    std::string describe() const;
+
+private:
+    RateSchedule(Kind kind, double a, double b, double c, double d);
+
+    Kind kind_;
+    double a_, b_, c_, d_; // Parameters in the order of the factory arguments
+};
+
+struct LoadGeneratorConfig {
+    std::string topicName = "loadgen";
+    size_t partitions = 8;
+    size_t producers = 1;
+    size_t consumers = 1;          // Partitions are split round-robin between consumers
+    size_t slowConsumers = 0;      // The last slowConsumers consumers sleep per record
+    std::chrono::microseconds slowConsumerDelay{1000};
+    KeyDistribution keys = KeyDistribution::uniform(1000);
+    PayloadSizeDistribution payloadSizes = PayloadSizeDistribution::fixed(100);
+    RateSchedule rate = RateSchedule::constant(1000);
+    std::chrono::milliseconds duration{60000};
+    uint64_t seed = 0;             // 0: drawn from std::random_device and reported
+};
+
+struct LoadGeneratorReport {
+    uint64_t seed = 0;
+    double elapsedSeconds = 0.0;
+    uint64_t produced = 0;
+    uint64_t producedBytes = 0;
+    uint64_t consumed = 0;
+    std::vector<uint64_t> consumedPerConsumer;
+    std::vector<uint64_t> appendedPerPartition; // Log end offsets, shows key skew
+    std::vector<uint64_t> lagPerPartition;      // Appended but not consumed
+    double hottestPartitionShare = 0.0;         // Largest partition's share of appends
+};
+
+// Drives Producer and Consumer instances against a broker with shaped traffic. Every
+// producer and consumer draws from its own generator seeded from the run seed, so the
+// key and payload-size sequences of a run can be reproduced with the reported seed.
+class LoadGenerator {
+public:
+    LoadGenerator(Broker& broker, LoadGeneratorConfig config);
+    ~LoadGenerator();
+
+    // Lifecycle (runs for config.duration unless stopped earlier)
+    void start();
+    void stop();
+    void join();
+    bool isRunning() const;
+
+    // Statistics
+    uint64_t getSeed() const;
+    uint64_t getTotalProduced() const;
+    uint64_t getTotalConsumed() const;
+    LoadGeneratorReport getReport() const;
+
+private:
+    void producerThread(size_t index);
+    void consumerThread(size_t index);
+    double elapsedSeconds() const;
+
+    Broker& broker_;
+    LoadGeneratorConfig config_;
+    uint64_t seed_;
+    std::atomic<bool> running_;
+    std::atomic<size_t> activeProducers_;
+    std::chrono::steady_clock::time_point startTime_;
+    std::chrono::steady_clock::time_point stopTime_;
+    std::vector<std::thread> threads_;
+
+    std::atomic<uint64_t> totalProduced_;
+    std::atomic<uint64_t> totalProducedBytes_;
+    std::vector<std::atomic<uint64_t>> consumedPerConsumer_;
+    std::vector<std::atomic<uint64_t>> positions_; // Per partition, published by its consumer
+    mutable std::mutex reportMutex_;               // Guards startTime_/stopTime_ for getReport()
+};
@@ -16,6 +16,10 @@ public:
     const std::string& getKey() const;
     const std::string& getValue() const;
     std::chrono::system_clock::time_point getTimestamp() const;
+    size_t getSizeBytes() const; // Payload size (key + value)
+    uint64_t getTraceId() const;  // Non-zero when the message was sampled for tracing
+    void setTraceId(uint64_t traceId);
+    void setOffset(uint64_t offset); // Assigned by the partition on append
 
     std::string toString() const; // For debugging purposes
 
@@ -24,4 +28,5 @@ private:
     std::string key_;
     std::string value_;
     std::chrono::system_clock::time_point timestamp_;
+    uint64_t traceId_;
 };
\ No newline at end of file
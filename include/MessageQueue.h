@@ -1,24 +1,39 @@
 #pragma once
 
 #include "Message.h"
+#include "ProfiledMutex.h"
+#include "RingQueue.h"
 
-#include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+
+// Queue entry: the message, when it was enqueued, and an optional completion callback
+struct QueuedMessage {
+    Message message;
+    std::chrono::steady_clock::time_point enqueuedAt;
+    std::function<void(std::exception_ptr)> onAppended;
+    uint64_t enqueuedTicks = 0; // Tracer ticks at enqueue, for traced messages only
+};
 
 class MessageQueue {
 public:
     MessageQueue();
     ~MessageQueue();
 
-    // Producer operations
-    void push(const Message& message);
-    void push(Message&& message);
+    // Producer operations (return false if the queue is shut down and the message was not queued)
+    bool push(const Message& message);
+    bool push(Message&& message);
+    bool push(Message&& message, std::function<void(std::exception_ptr)> onAppended);
     
     // Consumer operations
     Message pop();
     bool tryPop(Message& message, std::chrono::milliseconds timeout);
+    bool tryPopFront(QueuedMessage& entry);
+    bool frontSize(uint64_t& sizeBytes) const;
     
     // Utility
     size_t size() const;
@@ -26,8 +41,10 @@ public:
     void shutdown();
 
 private:
-    std::queue<Message> queue_;
-    mutable std::mutex mutex_; // Mutex to protect the queue
-    std::condition_variable cv_; // Condition variable to notify waiting threads
+    static uint64_t enqueueTicks(const Message& message);
+
+    RingQueue<QueuedMessage> queue_; // Reuses its slots, so steady-state pushes do not allocate
+    mutable ProfiledMutex<"MessageQueue::mutex_"> mutex_; // Mutex to protect the queue
+    ProfiledConditionVariable cv_; // Condition variable to notify waiting threads
     std::atomic<bool> shutdown_; // Flag to indicate if the queue is shutting down
 };
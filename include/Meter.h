@@ -0,0 +1,78 @@
+#pragma once
+
+#include "ShardedCounter.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Rates of one meter, in units per second
+struct MeterRates {
+    uint64_t count = 0;
+    double instantRate = 0.0; // Over the last completed tick
+    double meanRate = 0.0;    // Since creation or reset
+    double oneMinuteRate = 0.0;
+    double fiveMinuteRate = 0.0;
+    double fifteenMinuteRate = 0.0;
+};
+
+// Throughput of a topic or partition
+struct ThroughputRates {
+    MeterRates messagesIn;
+    MeterRates bytesIn;
+    MeterRates messagesOut;
+    MeterRates bytesOut;
+};
+
+// Event counter with 1/5/15-minute exponentially weighted moving average rates. Marks go
+// to a sharded counter; once per tick interval the first caller to notice (marking or
+// reading) claims the tick with a compare-and-swap and folds the events since the
+// previous tick into the averages, so neither path takes a lock.
+class Meter {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::chrono::seconds kTickInterval{1};
+
+    Meter();
+    Meter(const Meter&) = delete;
+    Meter& operator=(const Meter&) = delete;
+
+    // Hot path
+    void mark(uint64_t count = 1);
+    void mark(uint64_t count, Clock::time_point now); // Lets callers share one clock read
+
+    // Reads
+    uint64_t getCount() const;
+    MeterRates getRates() const;
+    void reset();
+
+private:
+    static constexpr size_t kWindows = 3;
+
+    void tickIfNecessary(int64_t nowNs) const;
+    static int64_t toNs(Clock::time_point time);
+
+    ShardedCounter count_;
+    std::atomic<int64_t> startNs_;
+
+    // Tick state (advanced from const reads as well)
+    mutable std::atomic<int64_t> lastTickNs_;
+    mutable std::atomic<uint64_t> countAtLastTick_;
+    mutable std::atomic<double> instantRate_;
+    mutable std::array<std::atomic<double>, kWindows> rates_;
+    mutable std::atomic<bool> initialized_;
+};
+
+// Messages and bytes in and out of one topic or partition
+struct ThroughputMeters {
+    Meter messagesIn;
+    Meter bytesIn;
+    Meter messagesOut;
+    Meter bytesOut;
+
+    void markIn(uint64_t messages, uint64_t bytes, Meter::Clock::time_point now = Meter::Clock::now());
+    void markOut(uint64_t messages, uint64_t bytes, Meter::Clock::time_point now = Meter::Clock::now());
+    ThroughputRates getRates() const;
+    void reset();
+};
@@ -1,23 +1,74 @@
 #pragma once
 
+#include "ShardedCounter.h"
+#include "LatencyHistogram.h"
+#include "Meter.h"
+#include "AsyncLogger.h"
+#include "ProfiledMutex.h"
+#include "MetricsSnapshot.h"
+
 #include <atomic>
 #include <chrono>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <map>
+#include <utility>
 #include <mutex>
+#include <shared_mutex>
 
-// Log levels
-enum class LogLevel {
-    DEBUG = 0,
-    INFO = 1,
-    WARN = 2,
-    ERROR = 3
-};
+// Logging that skips building the message when the level is disabled
+#define SK_LOG(level, message)                                  \
+    do {                                                        \
+        Metrics& skMetrics = Metrics::getInstance();            \
+        if (skMetrics.isLogEnabled(level)) {                    \
+            skMetrics.log(level, message);                      \
+        }                                                       \
+    } while (0)
+#define SK_LOG_DEBUG(message) SK_LOG(LogLevel::DEBUG, message)
+#define SK_LOG_INFO(message) SK_LOG(LogLevel::INFO, message)
+#define SK_LOG_WARN(message) SK_LOG(LogLevel::WARN, message)
+#define SK_LOG_ERROR(message) SK_LOG(LogLevel::ERROR, message)
+
+// Logging with arguments encoded in binary and formatted on the logger thread
+// ("{}" marks each argument; the format must be a string literal)
+#define SK_LOGF(level, ...)                                     \
+    do {                                                        \
+        Metrics& skMetrics = Metrics::getInstance();            \
+        if (skMetrics.isLogEnabled(level)) {                    \
+            skMetrics.getLogger().logf(level, __VA_ARGS__);     \
+        }                                                       \
+    } while (0)
 
 class Metrics {
 public:
+    // Per-topic and per-scheduling-class metrics. Handles returned by the registry stay
+    // valid for the life of the process, so hot paths resolve them once and keep them.
+    struct TopicMetrics {
+        std::atomic<size_t> queueSize{0};
+        ShardedCounter processingTimeNs;
+        ShardedCounter processingCount;
+        LatencyHistogram appendDuration;  // Time spent in Topic::append
+        LatencyHistogram enqueueToAppend; // Async writer queueing plus append
+        LatencyHistogram endToEnd;        // Message timestamp to delivery by a consumer
+        ThroughputMeters throughput;      // Messages and bytes appended and fetched
+    };
+    
+    struct SchedulingClassMetrics {
+        ShardedCounter totalDelayUs;
+        ShardedCounter delayCount;
+        std::atomic<uint64_t> maxDelayUs{0};
+    };
+    
     static Metrics& getInstance();
     
+    // Registry (named metrics resolved once to handles)
+    TopicMetrics& topicMetrics(const std::string& topicName);
+    SchedulingClassMetrics& schedulingClassMetrics(const std::string& className);
+    ShardedCounter& counter(const std::string& name);
+    LockSiteMetrics& lockSiteMetrics(const std::string& site);
+    uint64_t getCounter(const std::string& name) const;
+    
     // Message counters
     void incrementMessagesSent();
     void incrementMessagesReceived();
@@ -26,7 +77,25 @@ public:
     
     // Queue metrics
     void updateQueueSize(const std::string& topicName, size_t size);
-    void recordProcessingTime(const std::string& topicName, std::chrono::milliseconds time);
+    void recordProcessingTime(const std::string& topicName, std::chrono::nanoseconds time);
+    void updateQueueSize(TopicMetrics& topic, size_t size);
+    void recordProcessingTime(TopicMetrics& topic, std::chrono::nanoseconds time);
+    
+    // Latency histograms (per topic)
+    void recordEnqueueToAppend(TopicMetrics& topic, std::chrono::nanoseconds latency);
+    void recordEndToEnd(TopicMetrics& topic, std::chrono::nanoseconds latency);
+    
+    // Throughput meters (per topic)
+    void recordMessagesIn(TopicMetrics& topic, uint64_t messages, uint64_t bytes);
+    void recordMessagesOut(TopicMetrics& topic, uint64_t messages, uint64_t bytes);
+    
+    // Scheduling metrics (per scheduling class)
+    void recordQueueDelay(const std::string& className, std::chrono::microseconds delay);
+    void recordQueueDelay(SchedulingClassMetrics& schedulingClass, std::chrono::microseconds delay);
+    
+    // Consumer lag gauges (per group and topic; the handle stays valid for the process lifetime)
+    void updateConsumerLag(const std::string& groupId, const std::string& topicName, uint64_t lag);
+    std::atomic<uint64_t>& consumerLagGauge(const std::string& groupId, const std::string& topicName);
     
     // Getters
     uint64_t getMessagesSent() const;
@@ -35,39 +104,71 @@ public:
     uint64_t getMessagesDropped() const;
     
     size_t getQueueSize(const std::string& topicName) const;
-    double getAverageProcessingTime(const std::string& topicName) const;
+    double getAverageProcessingTime(const std::string& topicName) const; // milliseconds
+    LatencySnapshot getAppendLatency(const std::string& topicName) const;
+    LatencySnapshot getEnqueueToAppendLatency(const std::string& topicName) const;
+    LatencySnapshot getEndToEndLatency(const std::string& topicName) const;
+    ThroughputRates getTopicThroughput(const std::string& topicName) const;
+    double getAverageQueueDelay(const std::string& className) const; // microseconds
+    uint64_t getMaxQueueDelay(const std::string& className) const;   // microseconds
+    uint64_t getConsumerLag(const std::string& groupId, const std::string& topicName) const;
+    
+    // Lock contention (per ProfiledMutex site; empty unless built with SELFKAFKA_PROFILE_LOCKS)
+    uint64_t getLockAcquisitions(const std::string& site) const;
+    uint64_t getLockContended(const std::string& site) const;
+    LatencySnapshot getLockWaitTime(const std::string& site) const;
+    LatencySnapshot getLockHoldTime(const std::string& site) const;
     
     // Logging
     void setLogLevel(LogLevel level);
+    bool isLogEnabled(LogLevel level) const {
+        return level >= logLevel_.load(std::memory_order_relaxed);
+    }
     void log(LogLevel level, const std::string& message);
     void logInfo(const std::string& message);
     void logWarn(const std::string& message);
     void logError(const std::string& message);
     void logDebug(const std::string& message);
+    AsyncLogger& getLogger();
+    void flushLogs(); // Waits until everything logged so far is written
+    
+    // Export (reads atomics under shared registry locks; recording is never blocked)
+    MetricsSnapshot snapshot() const;
+    void collect(MetricsSnapshot& snapshot) const;
     
     // Statistics
     void printStatistics() const;
     void reset();
 
 private:
-    Metrics() = default;
+    Metrics();
+    ~Metrics();
+    
+    template <typename T>
+    static T& resolve(std::unordered_map<std::string, std::unique_ptr<T>>& registry, std::shared_mutex& mutex,
+                      const std::string& name);
     
     // Message counters
-    std::atomic<uint64_t> messagesSent_{0};
-    std::atomic<uint64_t> messagesReceived_{0};
-    std::atomic<uint64_t> messagesProcessed_{0};
-    std::atomic<uint64_t> messagesDropped_{0};
+    ShardedCounter messagesSent_;
+    ShardedCounter messagesReceived_;
+    ShardedCounter messagesProcessed_;
+    ShardedCounter messagesDropped_;
     
-    // Queue metrics
-    std::unordered_map<std::string, std::atomic<size_t>> queueSizes_;
-    std::unordered_map<std::string, std::atomic<double>> totalProcessingTime_;
-    std::unordered_map<std::string, std::atomic<uint64_t>> processingCount_;
-    mutable std::mutex queueMetricsMutex_;
+    // Registry (entries are never removed; reset() zeroes them in place)
+    std::unordered_map<std::string, std::unique_ptr<TopicMetrics>> topics_;
+    std::unordered_map<std::string, std::unique_ptr<SchedulingClassMetrics>> schedulingClasses_;
+    std::unordered_map<std::string, std::unique_ptr<ShardedCounter>> counters_;
+    std::unordered_map<std::string, std::unique_ptr<LockSiteMetrics>> lockSites_;
+    mutable std::shared_mutex registryMutex_;
+    
+    // Consumer lag metrics ((group, topic) -> messages behind)
+    std::map<std::pair<std::string, std::string>, std::atomic<uint64_t>> consumerLag_;
+    mutable ProfiledMutex<"Metrics::lagMutex_"> lagMutex_;
     
     // Logging
     std::atomic<LogLevel> logLevel_{LogLevel::INFO};
+    AsyncLogger logger_;
     
     // Helper methods
-    std::string getCurrentTime() const;
     std::string logLevelToString(LogLevel level) const;
 };
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "MetricsSnapshot.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <functional>
+
+// Minimal HTTP/1.1 endpoint for metric scrapes, bound to the loopback interface only.
+// GET /metrics returns Prometheus text exposition and GET /metrics.json returns JSON;
+// every request takes a fresh snapshot from the provider. Requests are served one at a
+// time on the server thread and each connection is closed after its response.
+class MetricsHttpServer {
+public:
+    using SnapshotProvider = std::function<MetricsSnapshot()>;
+
+    explicit MetricsHttpServer(SnapshotProvider provider, uint16_t port = 0); // 0 picks a free port
+    ~MetricsHttpServer();
+
+    // Lifecycle
+    void start(); // Binds 127.0.0.1:port; throws std::runtime_error when the port is unavailable
+    void stop();
+    void join();
+
+    // Status
+    uint16_t getPort() const; // Bound port once started
+    bool isRunning() const;
+
+    // Statistics
+    uint64_t getTotalRequests() const;
+
+private:
+    void serverThread();
+    void handleConnection(int clientFd);
+    static void sendResponse(int clientFd, const std::string& status, const std::string& contentType,
+                             const std::string& body);
+
+    SnapshotProvider provider_;
+    std::atomic<uint16_t> port_;
+    int listenFd_;
+
+    // Thread management
+    std::thread serverThread_;
+    std::atomic<bool> running_;
+
+    // Statistics
+    std::atomic<uint64_t> totalRequests_;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include "Meter.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
+
+enum class MetricType {
+    Counter,
+    Gauge
+};
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+struct MetricSample {
+    std::string name;
+    MetricType type;
+    MetricLabels labels;
+    double value;
+};
+
+struct HistogramSample {
+    std::string name;
+    MetricLabels labels;
+    LatencySnapshot latency; // Nanoseconds; rendered in seconds
+};
+
+// Point-in-time copy of every metric, renderable as Prometheus text exposition or JSON.
+// Collecting one only reads atomics and takes shared registry locks, so recording threads
+// are never blocked by a scrape.
+class MetricsSnapshot {
+public:
+    MetricsSnapshot();
+
+    // Building
+    void addCounter(const std::string& name, MetricLabels labels, double value);
+    void addGauge(const std::string& name, MetricLabels labels, double value);
+    void addHistogram(const std::string& name, MetricLabels labels, const LatencySnapshot& latency);
+    void addMeter(const std::string& name, const MetricLabels& labels, const MeterRates& rates);
+    void addThroughput(const std::string& prefix, const MetricLabels& labels, const ThroughputRates& rates);
+
+    // Accessors
+    const std::vector<MetricSample>& getSamples() const;
+    const std::vector<HistogramSample>& getHistograms() const;
+    std::chrono::system_clock::time_point getTimestamp() const;
+    const MetricSample* find(const std::string& name, const MetricLabels& labels = {}) const;
+
+    // Rendering
+    std::string toPrometheus() const;
+    std::string toJson() const;
+
+private:
+    std::chrono::system_clock::time_point timestamp_;
+    std::vector<MetricSample> samples_;
+    std::vector<HistogramSample> histograms_;
+};
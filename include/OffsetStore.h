@@ -0,0 +1,104 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <exception>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+
+// Committed consumer offsets, kept in a compacted append-only log (__consumer_offsets)
+// with an in-memory index of the latest offset per group and partition.
+// Without a data directory the store is in-memory only.
+class OffsetStore {
+public:
+    explicit OffsetStore(std::string dataDirectory);
+    ~OffsetStore();
+
+    // Lifecycle
+    void start();
+    void stop();
+    void join();
+
+    // Commits
+    void commitAsync(const std::string& groupId, const std::string& topicName, uint32_t partitionId, uint64_t offset);
+    void commitSync(const std::string& groupId, const std::string& topicName, uint32_t partitionId, uint64_t offset);
+    void flush();
+
+    // Lookup (served from the in-memory index)
+    std::optional<uint64_t> getCommittedOffset(const std::string& groupId, const std::string& topicName,
+                                               uint32_t partitionId) const;
+    void forEachCommittedOffset(
+        const std::function<void(const std::string&, const std::string&, uint32_t, uint64_t)>& visitor) const;
+
+    // Statistics
+    bool isDurable() const;
+    uint64_t getTotalAppends() const;
+    uint64_t getTotalCommits() const;
+    bool isRunning() const;
+
+    // Configuration
+    void setCompactionThreshold(uint64_t minRecords);
+
+private:
+    struct OffsetKey {
+        std::string groupId;
+        std::string topicName;
+        uint32_t partitionId;
+
+        bool operator==(const OffsetKey& other) const = default;
+    };
+
+    struct OffsetKeyHash {
+        size_t operator()(const OffsetKey& key) const;
+    };
+
+    using OffsetMap = std::unordered_map<OffsetKey, uint64_t, OffsetKeyHash>;
+
+    void flusherThread();
+    void appendRecords(const OffsetMap& records);
+    void compact();
+    void recover();
+    static void encodeRecord(std::string& buffer, const OffsetKey& key, uint64_t offset);
+    uint64_t enqueue(const std::string& groupId, const std::string& topicName, uint32_t partitionId, uint64_t offset);
+    void waitFlushed(uint64_t sequence);
+    bool flushPending();
+
+    std::string dataDirectory_;
+    std::string logPath_;
+    int logFd_;
+
+    // Latest committed offsets (a commit enters index_ and pending_ holding both locks,
+    // indexMutex_ first, so readers never see it in neither)
+    OffsetMap index_;
+    mutable std::mutex indexMutex_;
+
+    // Commits not yet appended to the log (coalesced per key)
+    OffsetMap pending_;
+    uint64_t enqueuedSequence_;
+    uint64_t flushedSequence_;
+    uint64_t failedSequence_;        // Highest sequence whose flush failed (requeued for retry)
+    std::exception_ptr flushError_;  // Error of that flush, rethrown to its waiters
+    std::mutex pendingMutex_;
+    std::mutex writeMutex_; // Serializes log appends and compaction
+    std::condition_variable pendingCv_;
+    std::condition_variable flushedCv_;
+
+    // Thread management
+    std::thread flusherThread_;
+    std::atomic<bool> running_;
+
+    // Log bookkeeping (guarded by writeMutex_)
+    uint64_t recordsInLog_;
+    uint64_t logLength_; // Bytes of complete appends; a failed append is cut back to it
+    std::atomic<uint64_t> compactionThreshold_;
+
+    // Statistics
+    std::atomic<uint64_t> totalAppends_;
+    std::atomic<uint64_t> totalCommits_;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Broker.h"
+#include "Consumer.h"
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+
+// Processes records of each partition on a worker pool. Records with the same key run
+// one at a time in offset order; different keys run concurrently. Completions are kept
+// in a sliding bitset per partition and only the contiguous completed prefix is
+// committed, so a restart never skips a record that was still being processed.
+// Records delivered again below the completed prefix (after a seek back or a
+// reassignment) restart that partition's window. A handler that throws is logged and
+// its record counts as processed.
+class ParallelConsumer {
+public:
+    using Handler = std::function<void(uint32_t partitionId, const Message& message)>;
+
+    ParallelConsumer(Broker& broker, const std::string& topicName, const std::string& groupId,
+                     size_t numWorkers, Handler handler);
+    ~ParallelConsumer();
+
+    // Lifecycle
+    void start();
+    void stop(); // Stops polling; records already dispatched are still processed and committed
+    void join();
+
+    // Configuration (before start)
+    void setMaxInFlightRecords(size_t maxRecords); // Per partition; polling pauses beyond it
+    void setCommitInterval(std::chrono::milliseconds interval);
+    Consumer& getConsumer(); // For assign() or enablePrefetch() before start
+
+    // Statistics
+    uint64_t getCommittedOffset(uint32_t partitionId) const; // Next offset after the completed prefix
+    uint64_t getTotalProcessed() const;
+    uint64_t getTotalCommits() const;
+    bool isRunning() const;
+
+private:
+    struct PendingRecord {
+        uint32_t partitionId;
+        Message message;
+    };
+
+    // Per-key FIFO; a key is in readyKeys_ while its head record waits for a worker
+    struct KeyQueue {
+        std::deque<PendingRecord> records;
+    };
+
+    // Completion window: bit i of completed is offset windowBase + i; windowBase is a
+    // multiple of 64 and whole words are dropped as nextCommit moves past them
+    struct PartitionProgress {
+        uint64_t nextCommit = 0;
+        uint64_t windowBase = 0;
+        uint64_t dispatchedEnd = 0;
+        uint64_t committed = 0;
+        std::deque<uint64_t> completed;
+    };
+
+    void pollThread();
+    void workerThread();
+    void dispatchLocked(uint32_t partitionId, Message&& message);
+    void completeLocked(uint32_t partitionId, uint64_t offset);
+    bool hasCapacityLocked() const;
+    void commitCompleted();
+
+    Broker& broker_;
+    std::string topicName_;
+    std::string groupId_;
+    std::unique_ptr<Consumer> consumer_;
+    Handler handler_;
+    size_t numWorkers_;
+
+    // Dispatch state
+    std::unordered_map<std::string, KeyQueue> keyQueues_; // Keyed by partition id + '\0' + key
+    std::deque<std::string> readyKeys_;
+    std::unordered_map<uint32_t, PartitionProgress> progress_;
+    size_t maxInFlightRecords_;
+    std::chrono::milliseconds commitInterval_;
+    mutable std::mutex mutex_;
+    std::condition_variable workCv_;     // Workers wait for ready keys
+    std::condition_variable capacityCv_; // Poll thread waits for in-flight records to drain
+
+    // Thread management
+    std::thread pollThread_;
+    std::vector<std::thread> workerThreads_;
+    std::atomic<bool> running_;
+    bool workersExit_;
+
+    // Statistics
+    std::atomic<uint64_t> totalProcessed_;
+    std::atomic<uint64_t> totalCommits_;
+};
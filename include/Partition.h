@@ -1,12 +1,16 @@
 #pragma once
 
 #include "Message.h"
+#include "Meter.h"
+#include "ProfiledMutex.h"
 
 #include <mutex>
 #include <queue>
 #include <vector>
 #include <atomic>
 #include <thread>
+#include <utility>
+#include <functional>
 #include <stdexcept>
 #include <condition_variable>
 
@@ -15,20 +19,27 @@ public:
     explicit Partition(uint32_t id);
 
     void append(const Message& message);
+    void append(Message&& message); // Takes over the key/value buffers instead of copying them
     void waitForMessage(uint64_t offset);
+    void notifyWhenAvailable(uint64_t offset, std::function<void()> callback);
     const Message getMessage(uint64_t offset) const;
     std::vector<Message> getMessages(uint64_t from, uint64_t to) const;
+    std::vector<Message> fetch(uint64_t from, size_t maxRecords, uint64_t maxBytes) const;
     std::vector<Message> getAllMessages() const; 
 
     uint64_t size() const;
     uint32_t getId() const;
+    ThroughputMeters& getThroughput(); // In: marked on append; out: marked by the broker's read paths
+    ThroughputRates getThroughputRates() const;
 
 private:
     uint32_t id_;
     std::vector<Message> messages_;
     std::atomic<uint64_t> nextOffset_;
-    mutable std::mutex mutex_; // Mutex to protect the messages_ vector
-    mutable std::condition_variable cv_; // Condition variable to notify when a new message is appended
+    mutable ProfiledMutex<"Partition::mutex_"> mutex_; // Mutex to protect the messages_ vector
+    mutable ProfiledConditionVariable cv_; // Condition variable to notify when a new message is appended
+    std::vector<std::pair<uint64_t, std::function<void()>>> waiters_; // One-shot callbacks keyed by awaited offset
+    ThroughputMeters throughput_;
 
     void checkConsistency() const;
 };
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "GroupMetadataStore.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <libpq-fe.h>
+
+// Group metadata in PostgreSQL (database/schema.sql). Each diff is applied in one
+// transaction of prepared multi-row upserts and deletes.
+class PostgresGroupStore : public GroupMetadataStore {
+public:
+    explicit PostgresGroupStore(std::string connectionString = defaultConnectionString());
+    ~PostgresGroupStore() override;
+
+    GroupState load(const std::string& groupId, const std::string& topicName) override;
+    bool apply(const std::string& groupId, const std::string& topicName, const GroupStateDiff& diff) override;
+    bool isAvailable() const override;
+    std::string getName() const override;
+
+    // "dbname=selfkafka user=$USER"
+    static std::string defaultConnectionString();
+
+private:
+    bool ensureConnected();
+    bool prepareStatements();
+    bool execPrepared(const char* name, int numParams, const char* const* values);
+    bool execCommand(const char* command);
+
+    PGconn* connection_;
+    std::unordered_set<std::string> registeredGroups_; // Groups whose consumer_groups row exists
+    mutable std::mutex mutex_;                         // Serializes use of the connection
+};
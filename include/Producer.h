@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Broker.h"
+#include "Task.h"
 
 #include <string>
 
@@ -10,6 +11,9 @@ public:
 
     void send(const std::string& topicName, const std::string& key, const std::string& value);
 
+    // Coroutine API: completes once the message is appended to its partition
+    Task<void> sendAsync(std::string topicName, std::string key, std::string value);
+
 private:
     Broker& broker_;
 };
\ No newline at end of file
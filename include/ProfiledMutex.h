@@ -0,0 +1,94 @@
+#pragma once
+
+#include "ShardedCounter.h"
+#include "LatencyHistogram.h"
+
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+#include <condition_variable>
+
+// Contention statistics of one lock site (every mutex declared with the same site name)
+struct LockSiteMetrics {
+    ShardedCounter acquisitions;
+    ShardedCounter contended;  // Acquisitions that found the mutex held
+    LatencyHistogram waitTime; // Contended acquisitions only
+    LatencyHistogram holdTime;
+};
+
+// Resolves the statistics of a lock site in the Metrics registry
+LockSiteMetrics& resolveLockSite(const char* site);
+
+// Lock site name usable as a template argument: ProfiledMutex<"Broker::mutex_">
+template <size_t N>
+struct LockSite {
+    constexpr LockSite(const char (&name)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            value[i] = name[i];
+        }
+    }
+    char value[N];
+};
+
+#ifdef SELFKAFKA_PROFILE_LOCKS
+
+// Drop-in std::mutex replacement that counts acquisitions and contended acquisitions and
+// records wait and hold times into the histograms of its lock site. Use std::lock_guard /
+// std::unique_lock without template arguments, and ProfiledConditionVariable for waits.
+template <LockSite Site>
+class ProfiledMutex {
+public:
+    ProfiledMutex() = default;
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    void lock() {
+        LockSiteMetrics& site = metrics();
+        if (!mutex_.try_lock()) {
+            auto waitStart = std::chrono::steady_clock::now();
+            mutex_.lock();
+            acquiredAt_ = std::chrono::steady_clock::now();
+            site.contended.add();
+            site.waitTime.record(acquiredAt_ - waitStart);
+        } else {
+            acquiredAt_ = std::chrono::steady_clock::now();
+        }
+        site.acquisitions.add();
+    }
+
+    bool try_lock() {
+        if (!mutex_.try_lock()) {
+            return false;
+        }
+        acquiredAt_ = std::chrono::steady_clock::now();
+        metrics().acquisitions.add();
+        return true;
+    }
+
+    void unlock() {
+        auto held = std::chrono::steady_clock::now() - acquiredAt_;
+        mutex_.unlock();
+        metrics().holdTime.record(held);
+    }
+
+private:
+    static LockSiteMetrics& metrics() {
+        static LockSiteMetrics& site = resolveLockSite(Site.value);
+        return site;
+    }
+
+    std::mutex mutex_;
+    std::chrono::steady_clock::time_point acquiredAt_; // Written by the owner only
+};
+
+using ProfiledConditionVariable = std::condition_variable_any;
+
+#else
+
+// Profiling disabled: a plain std::mutex, so the site name costs nothing
+template <LockSite Site>
+using ProfiledMutex = std::mutex;
+
+using ProfiledConditionVariable = std::condition_variable;
+
+#endif
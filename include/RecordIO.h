@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cerrno>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Helpers shared by the broker's on-disk logs (__consumer_offsets, group metadata)
+namespace recordio {
+
+// FNV-1a, used to detect torn records at the tail of a log
+inline uint32_t checksum(const char* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+void appendValue(std::string& buffer, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    buffer.append(bytes, sizeof(T));
+}
+
+template <typename T>
+T readValue(const char* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+// Writes the whole buffer, optionally syncing it to disk; 'what' names the file in errors
+inline void writeFully(int fd, const std::string& buffer, const std::string& what, bool sync = true) {
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t result = ::write(fd, buffer.data() + written, buffer.size() - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(what + " write failed: " + std::string(std::strerror(errno)));
+        }
+        written += static_cast<size_t>(result);
+    }
+    if (sync && ::fsync(fd) != 0) {
+        throw std::runtime_error(what + " sync failed: " + std::string(std::strerror(errno)));
+    }
+}
+
+// Appends the buffer to a log whose complete records end at 'length', and advances it.
+// A write that fails partway is cut back to 'length', and bytes found past it (left when
+// that cut failed too) are cut before writing, so an append never lands behind torn
+// bytes, where recovery stops reading and drops everything after them.
+inline void appendToLog(int fd, const std::string& buffer, uint64_t& length, const std::string& what,
+                        bool sync = true) {
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        throw std::runtime_error(what + " stat failed: " + std::string(std::strerror(errno)));
+    }
+    if (static_cast<uint64_t>(status.st_size) != length && ::ftruncate(fd, static_cast<off_t>(length)) != 0) {
+        throw std::runtime_error(what + " truncate of a torn append failed: " + std::string(std::strerror(errno)));
+    }
+
+    try {
+        writeFully(fd, buffer, what, sync);
+    } catch (...) {
+        if (::ftruncate(fd, static_cast<off_t>(length)) != 0) {
+            // Left for the next append, which checks the length again
+        }
+        throw;
+    }
+    length += buffer.size();
+}
+
+// Syncs the directory holding 'path', making a rename or creation of it durable
+inline void syncParentDirectory(const std::string& path, const std::string& what) {
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    int fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        throw std::runtime_error(what + " directory open failed: " + std::string(std::strerror(errno)));
+    }
+    int result = ::fsync(fd);
+    int error = errno;
+    ::close(fd);
+    if (result != 0) {
+        throw std::runtime_error(what + " directory sync failed: " + std::string(std::strerror(error)));
+    }
+}
+
+// Replaces 'to' with 'from' and syncs the directory, so the new file survives a crash
+inline void renameDurably(const std::string& from, const std::string& to, const std::string& what) {
+    std::filesystem::rename(from, to);
+    syncParentDirectory(to, what);
+}
+
+} // namespace recordio
@@ -25,6 +25,7 @@ public:
     void addPartition(std::shared_ptr<Partition> partition, const RetentionPolicy& policy);
     void removePartition(std::shared_ptr<Partition> partition);
     void updateRetentionPolicy(std::shared_ptr<Partition> partition, const RetentionPolicy& policy);
+    void runOnce(); // One cleanup pass over every partition on the calling thread
 
     // Statistics
     uint64_t getTotalCleanedMessages() const;
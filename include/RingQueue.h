@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <optional>
+
+// FIFO over a power-of-two ring of slots. Slots are reused once popped and the ring only
+// grows (doubling) when full, so a queue that has reached its working size pushes and
+// pops without touching the heap. Drop-in for the std::queue calls MessageQueue uses.
+template <typename T>
+class RingQueue {
+public:
+    explicit RingQueue(size_t initialCapacity = 64) : slots_(roundUp(initialCapacity)), head_(0), size_(0) {}
+
+    void push(T&& value) {
+        if (size_ == slots_.size()) {
+            grow();
+        }
+        slots_[(head_ + size_) & (slots_.size() - 1)].emplace(std::move(value));
+        ++size_;
+    }
+
+    T& front() { return *slots_[head_]; }
+    const T& front() const { return *slots_[head_]; }
+
+    void pop() {
+        slots_[head_].reset();
+        head_ = (head_ + 1) & (slots_.size() - 1);
+        --size_;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    static size_t roundUp(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    // Moves the entries, oldest first, into a ring twice the size
+    void grow() {
+        std::vector<std::optional<T>> slots(slots_.size() * 2);
+        for (size_t i = 0; i < size_; ++i) {
+            slots[i] = std::move(slots_[(head_ + i) & (slots_.size() - 1)]);
+        }
+        slots_ = std::move(slots);
+        head_ = 0;
+    }
+
+    std::vector<std::optional<T>> slots_;
+    size_t head_;
+    size_t size_;
+};
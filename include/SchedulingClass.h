@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+class SchedulingClass {
+public:
+    // Constructor with default values
+    SchedulingClass();
+
+    // Constructor with custom values
+    SchedulingClass(std::string name, int32_t priority, uint64_t quantumBytes);
+
+    // Predefined classes
+    static SchedulingClass latencyCritical();
+    static SchedulingClass bulk();
+
+    // Class name (used as the key for per-class metrics)
+    const std::string& getName() const;
+
+    // Strict priority lane: higher lanes are always drained first
+    int32_t getPriority() const;
+
+    // Deficit-round-robin weight within a lane, in bytes per round
+    uint64_t getQuantumBytes() const;
+
+    // Get scheduling info as string
+    std::string toString() const;
+
+private:
+    std::string name_;
+    int32_t priority_;
+    uint64_t quantumBytes_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Counter split into cache-line-sized shards. Each thread adds to its own shard with a
+// relaxed, uncontended fetch_add; reads sum the shards, so a read concurrent with adds
+// sees some but possibly not all of them.
+class ShardedCounter {
+public:
+    static constexpr size_t kShards = 32;
+
+    ShardedCounter() = default;
+    ShardedCounter(const ShardedCounter&) = delete;
+    ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+    // Hot path
+    void add(uint64_t value = 1) {
+        shards_[shardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    // Reads
+    uint64_t load() const;
+    void reset();
+
+    // Threads are numbered in the order they first touch any sharded metric
+    static size_t threadIndex() {
+        thread_local size_t index = nextThread_.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+
+    static size_t shardIndex() {
+        return threadIndex() % kShards;
+    }
+
+    static inline std::atomic<size_t> nextThread_{0};
+    std::array<Shard, kShards> shards_;
+};
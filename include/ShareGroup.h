@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Broker.h"
+#include "ConsumerRecords.h"
+#include "SharePartition.h"
+#include "TimerWheel.h"
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+// Queue-style consumption: every member may fetch from every partition. Records are
+// leased to the member that acquired them until it acknowledges them or the acquisition
+// lock times out, after which they are redelivered to any member. Parallelism is bounded
+// by the number of members, not by the partition count.
+class ShareGroup {
+public:
+    ShareGroup(std::string groupId, Broker& broker, std::string topicName);
+    ~ShareGroup();
+
+    // Membership
+    std::string join();
+    void leave(const std::string& memberId); // Its unacknowledged records are redelivered
+
+    // Consumption
+    ConsumerRecords poll(const std::string& memberId, size_t maxRecords, std::chrono::milliseconds timeout);
+    bool acknowledge(const std::string& memberId, uint32_t partitionId, uint64_t offset,
+                     AcknowledgeType type = AcknowledgeType::Accept);
+
+    // Configuration
+    void setAcquisitionLockTimeout(std::chrono::milliseconds timeout);
+
+    // Status
+    std::string getGroupId() const;
+    size_t getMemberCount() const;
+    const SharePartition& getPartition(uint32_t partitionId) const;
+
+    // Statistics
+    uint64_t getTotalAcquired() const;
+    uint64_t getTotalAcknowledged() const;
+    uint64_t getTotalLeaseExpirations() const; // Records released because their lock timed out
+
+private:
+    void armExpiryLocked(uint32_t partitionId, TimerWheel::Clock::time_point deadline);
+    void expireLeases(uint32_t partitionId);
+
+    std::string groupId_;
+    Broker& broker_;
+    std::string topicName_;
+    std::vector<std::unique_ptr<SharePartition>> partitions_;
+
+    // Members and where each one's next poll starts, so partitions are drained evenly
+    std::unordered_set<std::string> members_;
+    std::unordered_map<std::string, uint32_t> pollCursors_;
+    uint64_t nextMemberId_;
+
+    // One expiry timer per partition, armed for its earliest lease deadline
+    struct ExpiryTimer {
+        TimerWheel::TimerId timerId;
+        TimerWheel::Clock::time_point deadline;
+    };
+    std::unordered_map<uint32_t, ExpiryTimer> expiryTimers_;
+    std::chrono::milliseconds lockTimeout_;
+    bool closing_;
+    mutable std::mutex mutex_;
+
+    // Statistics
+    std::atomic<uint64_t> totalAcquired_;
+    std::atomic<uint64_t> totalAcknowledged_;
+    std::atomic<uint64_t> totalLeaseExpirations_;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <optional>
+
+enum class AcknowledgeType {
+    Accept,  // Processed; never delivered again
+    Release, // Handed back for redelivery to any member
+    Reject   // Unprocessable; archived without redelivery
+};
+
+// Delivery state of one partition in a share group. Records in [startOffset, endOffset)
+// are in flight: each is available, acquired under a lease, or completed (accepted or
+// archived), kept as two bitsets over the window. Leases are contiguous offset ranges
+// owned by one member with one deadline; together they cover exactly the acquired
+// records. Everything below startOffset is completed, everything from endOffset on has
+// never been handed out.
+class SharePartition {
+public:
+    using Clock = std::chrono::steady_clock;
+    using OffsetRange = std::pair<uint64_t, uint64_t>; // [first, last]
+
+    explicit SharePartition(uint32_t id, size_t maxInFlightRecords = 2000, uint8_t maxDeliveryAttempts = 5);
+
+    // Delivery (logEndOffset bounds what may be acquired)
+    std::vector<OffsetRange> acquire(const std::string& memberId, size_t maxRecords, uint64_t logEndOffset,
+                                     Clock::time_point leaseDeadline);
+    bool acknowledge(const std::string& memberId, uint64_t offset, AcknowledgeType type);
+    size_t expireLeases(Clock::time_point now); // Returns the number of records released
+    size_t releaseMember(const std::string& memberId);
+
+    // Status
+    uint32_t getId() const;
+    uint64_t getStartOffset() const;
+    uint64_t getEndOffset() const;
+    size_t getAcquiredCount() const;
+    size_t getArchivedCount() const;
+    std::optional<Clock::time_point> getNextLeaseDeadline() const;
+
+private:
+    struct Lease {
+        uint64_t lastOffset;
+        std::string memberId;
+        Clock::time_point deadline;
+    };
+
+    bool testBit(const std::vector<uint64_t>& bits, uint64_t offset) const;
+    void setBit(std::vector<uint64_t>& bits, uint64_t offset, bool value);
+    void extendWindow(uint64_t endOffset);
+    void completeLocked(uint64_t offset, bool archived);
+    void makeAvailableLocked(uint64_t offset);
+    std::map<uint64_t, Lease>::iterator findLease(uint64_t offset);
+    void removeFromLease(std::map<uint64_t, Lease>::iterator lease, uint64_t offset);
+    void advanceStartOffset();
+
+    uint32_t id_;
+    size_t maxInFlightRecords_;
+    uint8_t maxDeliveryAttempts_;
+
+    // In-flight window; bit i and deliveryCounts_[i] describe offset windowBase_ + i.
+    // windowBase_ is a multiple of 64 so whole words can be dropped as the start advances.
+    uint64_t windowBase_;
+    uint64_t startOffset_;
+    uint64_t endOffset_;
+    std::vector<uint64_t> acquired_;
+    std::vector<uint64_t> completed_;
+    std::vector<uint8_t> deliveryCounts_;
+    std::map<uint64_t, Lease> leases_; // Keyed by first offset
+    size_t acquiredCount_;
+    size_t archivedCount_;
+    mutable std::mutex mutex_;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+
+// Hierarchical timing wheel for session deadlines. Scheduling, extending and cancelling
+// a timer are O(1); extending only updates the stored deadline and the timer is moved
+// lazily when its slot comes due. Expiry callbacks run on the wheel thread, which only
+// ticks while timers are scheduled.
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(10));
+    ~TimerWheel();
+
+    // Lifecycle
+    void start();
+    void stop();
+    void join();
+
+    // Timers
+    TimerId schedule(Clock::time_point deadline, std::function<void()> onExpired);
+    bool extend(TimerId timerId, Clock::time_point deadline);
+    bool cancel(TimerId timerId);     // The callback may still be running on return
+    bool cancelSync(TimerId timerId); // Also waits for a running callback to finish
+
+    // Statistics
+    size_t getActiveTimers() const;
+    uint64_t getTotalExpired() const;
+    bool isRunning() const;
+
+private:
+    static constexpr size_t kSlotBits = 6;
+    static constexpr size_t kSlotsPerLevel = size_t(1) << kSlotBits;
+    static constexpr size_t kLevels = 4; // 64^4 ticks: ~19 days at 10ms
+
+    struct Timer {
+        uint64_t deadlineTick;
+        std::function<void()> onExpired;
+    };
+
+    using Slot = std::vector<TimerId>;
+
+    void wheelThread();
+    void advanceTo(uint64_t targetTick, std::vector<TimerId>& expired);
+    void fire(std::unique_lock<std::mutex>& lock, const std::vector<TimerId>& expired);
+    void place(TimerId timerId, uint64_t deadlineTick);
+    void cascade(size_t level);
+    uint64_t toTick(Clock::time_point deadline) const;
+    uint64_t nowTick() const;
+
+    std::chrono::milliseconds tick_;
+    Clock::time_point origin_;
+
+    // Wheel state (guarded by mutex_); cancelled ids are skipped when their slot is drained
+    std::array<std::array<Slot, kSlotsPerLevel>, kLevels> levels_;
+    std::unordered_map<TimerId, Timer> timers_;
+    uint64_t currentTick_;
+    TimerId nextTimerId_;
+    mutable std::mutex mutex_;
+    std::condition_variable wakeCv_;
+
+    // Callback in flight, so cancel() can wait for it
+    TimerId firingTimerId_;
+    std::condition_variable firedCv_;
+
+    // Thread management
+    std::thread wheelThread_;
+    std::atomic<bool> running_;
+
+    // Statistics
+    std::atomic<uint64_t> totalExpired_;
+};
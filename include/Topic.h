@@ -3,11 +3,21 @@
 #include "Message.h"
 #include "Partition.h"
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <functional>
+
+class TopicLag;
+
 class Topic {
 public:
     explicit Topic(std::string name, size_t numPartitions);
 
     void append(const Message& message);
+    void append(Message&& message);
+    bool waitForAppend(uint64_t seenAppends, std::chrono::milliseconds timeout);
+    void notifyOnAppend(uint64_t seenAppends, std::function<void()> callback);
 
     Partition& getPartition(uint32_t partitionId);
     std::vector<Message> getAllMessages();
@@ -15,11 +25,18 @@ public:
     size_t size() const;
     std::string getName() const;
     size_t getNumPartitions() const;
+    uint64_t getAppendCount() const;
+
+    void setTopicLag(std::shared_ptr<TopicLag> topicLag); // Set before the topic is published
+    TopicLag* getTopicLag() const;
 
 private:
     std::string name_;
     std::vector<std::shared_ptr<Partition>> partitions_;
     size_t numPartitions_;
-    mutable std::mutex mutex_; // Mutex to protect the partitions_ vector
-    mutable std::condition_variable cv_; // Condition variable to notify when a new message is appended
+    std::atomic<uint64_t> appendCount_; // Bumped on every append, used to wake waiting readers
+    std::vector<std::function<void()>> appendWaiters_; // One-shot callbacks fired by the next append
+    std::shared_ptr<TopicLag> topicLag_; // Consumer lag gauges refreshed after appends
+    mutable ProfiledMutex<"Topic::mutex_"> mutex_; // Mutex to protect the partitions_ vector
+    mutable ProfiledConditionVariable cv_; // Condition variable to notify when a new message is appended
 };
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Sampled per-message tracing. One message in N gets a trace id when it enters the broker
+// (0 means untraced); the id travels with the Message, and each stage it passes through
+// records a span into the calling thread's ring buffer, timestamped with the TSC where
+// available. Rings keep the most recent kRingEvents spans per thread and are exported as
+// Chrome trace_event JSON (open in Perfetto or chrome://tracing). With sampling off, a
+// tracepoint costs one predictable branch on the message's trace id.
+// A thread's ring is released when the thread exits and handed to the next new thread
+// once its spans have been exported; at most kMaxRetainedRings released rings wait for
+// an export, beyond that the oldest is reused anyway.
+class Tracer {
+public:
+    static constexpr size_t kRingEvents = 4096;
+    static constexpr size_t kMaxRetainedRings = 64;
+
+    static Tracer& getInstance();
+
+    // Sampling
+    void setSampleRate(uint32_t oneInN); // 0 disables tracing
+    uint32_t getSampleRate() const;
+    bool isEnabled() const {
+        return sampleRate_.load(std::memory_order_relaxed) != 0;
+    }
+    uint64_t sample() { // New trace id for a message, or 0 when it is not sampled
+        return isEnabled() ? sampleSlow() : 0;
+    }
+
+    // Recording
+    static uint64_t now() { // TSC ticks (steady clock nanoseconds where there is no TSC)
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+    void record(uint64_t traceId, const char* name, uint64_t beginTicks, uint64_t endTicks) {
+        if (traceId != 0) {
+            recordSlow(traceId, name, beginTicks, endTicks);
+        }
+    }
+    void recordInstant(uint64_t traceId, const char* name) {
+        if (traceId != 0) {
+            uint64_t ticks = now();
+            recordSlow(traceId, name, ticks, ticks);
+        }
+    }
+
+    // Export
+    std::string toChromeJson() const;
+    void dump(const std::string& path) const; // Throws std::runtime_error when the file cannot be written
+    void clear();
+
+    // Statistics
+    uint64_t getTotalSampled() const;
+    uint64_t getTotalRecorded() const;
+
+private:
+    // Seqlock-protected slot: odd sequence while the owning thread writes it
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> traceId{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> beginTicks{0};
+        std::atomic<uint64_t> endTicks{0};
+    };
+
+    // Single-producer ring owned by one thread at a time, read by exporters
+    struct Ring {
+        std::array<Slot, kRingEvents> slots;
+        std::atomic<uint64_t> head{0};     // Next position the owning thread writes
+        std::atomic<uint64_t> floor{0};    // Positions below it were cleared
+        std::atomic<uint64_t> exported{0}; // Positions below it were exported
+        std::atomic<uint32_t> threadId{0};
+        std::atomic<bool> owned{true};     // False once the owning thread exited
+    };
+
+    struct Event {
+        uint64_t traceId;
+        const char* name;
+        uint64_t beginTicks;
+        uint64_t endTicks;
+        uint32_t threadId;
+    };
+
+    Tracer();
+
+    uint64_t sampleSlow();
+    void recordSlow(uint64_t traceId, const char* name, uint64_t beginTicks, uint64_t endTicks);
+    Ring& ringForThread();
+    std::shared_ptr<Ring> acquireRing();
+    std::vector<Event> collect() const;
+    double ticksPerMicrosecond() const;
+
+    std::atomic<uint32_t> sampleRate_;
+    std::atomic<uint64_t> nextTraceId_;
+
+    // Rings of live threads, and of exited ones until they are reused
+    std::vector<std::shared_ptr<Ring>> rings_;
+    uint32_t nextThreadId_;
+    mutable std::mutex ringsMutex_;
+
+    // Clock calibration (ticks to wall time)
+    const uint64_t originTicks_;
+    const std::chrono::steady_clock::time_point originTime_;
+
+    // Statistics
+    std::atomic<uint64_t> totalSampled_;
+    std::atomic<uint64_t> totalRecorded_;
+};
+
+// Records a span from construction to destruction when the trace id is non-zero
+class TraceSpan {
+public:
+    TraceSpan(uint64_t traceId, const char* name) :
+        traceId_(traceId),
+        name_(name),
+        beginTicks_(traceId != 0 ? Tracer::now() : 0) {}
+
+    ~TraceSpan() {
+        if (traceId_ != 0) {
+            Tracer::getInstance().record(traceId_, name_, beginTicks_, Tracer::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    uint64_t traceId_;
+    const char* name_;
+    uint64_t beginTicks_;
+};
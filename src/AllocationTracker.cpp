@@ -0,0 +1,234 @@
+#include "AllocationTracker.h"
+
+#ifdef SELFKAFKA_ALLOC_TRACKING
+
+#include <new>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// Plain thread_local counters (constant-initialized, so safe to touch from operator new
+// before and during thread start-up) plus relaxed process-wide totals
+thread_local AllocationCounts threadCounts;
+std::atomic<uint64_t> processAllocations{0};
+std::atomic<uint64_t> processDeallocations{0};
+std::atomic<uint64_t> processBytes{0};
+
+void countAllocation(std::size_t size) {
+    threadCounts.allocations++;
+    threadCounts.bytes += size;
+    processAllocations.fetch_add(1, std::memory_order_relaxed);
+    processBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void countDeallocation(void* pointer) {
+    if (pointer) {
+        threadCounts.deallocations++;
+        processDeallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Standard operator new loop: retries after each call of the installed new handler and
+// throws std::bad_alloc once there is none. Only successful allocations are counted.
+void* allocate(std::size_t size) {
+    while (true) {
+        if (void* pointer = std::malloc(size ? size : 1)) {
+            countAllocation(size);
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+    while (true) {
+        void* pointer = nullptr;
+        if (posix_memalign(&pointer, align, size ? size : 1) == 0) {
+            countAllocation(size);
+            return pointer;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+} // namespace
+
+// Replacements: Every global allocation form funnels into the counting helpers above; the
+// nothrow forms return nullptr where the throwing ones (or a new handler) throw
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateAligned(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocateAligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocateAligned(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+    countDeallocation(pointer);
+    std::free(pointer);
+}
+
+// Status: Tracking is compiled in
+bool AllocationTracker::isEnabled() {
+    return true;
+}
+
+// Statistics: Returns the calling thread's counts
+AllocationCounts AllocationTracker::getThreadCounts() {
+    return threadCounts;
+}
+
+// Statistics: Returns the counts of every thread
+AllocationCounts AllocationTracker::getProcessCounts() {
+    AllocationCounts counts;
+    counts.allocations = processAllocations.load(std::memory_order_relaxed);
+    counts.deallocations = processDeallocations.load(std::memory_order_relaxed);
+    counts.bytes = processBytes.load(std::memory_order_relaxed);
+    return counts;
+}
+
+#else
+
+// Status: Tracking is not compiled in
+bool AllocationTracker::isEnabled() {
+    return false;
+}
+
+// Statistics: Always zero without SELFKAFKA_ALLOC_TRACKING
+AllocationCounts AllocationTracker::getThreadCounts() {
+    return {};
+}
+
+// Statistics: Always zero without SELFKAFKA_ALLOC_TRACKING
+AllocationCounts AllocationTracker::getProcessCounts() {
+    return {};
+}
+
+#endif
+
+// Constructor: Snapshots the counts the delta is measured from
+AllocationScope::AllocationScope(bool processWide) :
+    processWide_(processWide),
+    start_(read()) {}
+
+// Statistics: Returns the allocations made since construction
+AllocationCounts AllocationScope::delta() const {
+    AllocationCounts now = read();
+    AllocationCounts counts;
+    counts.allocations = now.allocations - start_.allocations;
+    counts.deallocations = now.deallocations - start_.deallocations;
+    counts.bytes = now.bytes - start_.bytes;
+    return counts;
+}
+
+// Internal: Reads the counts this scope measures
+AllocationCounts AllocationScope::read() const {
+    return processWide_ ? AllocationTracker::getProcessCounts() : AllocationTracker::getThreadCounts();
+}
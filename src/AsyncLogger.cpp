@@ -0,0 +1,524 @@
+#include "AsyncLogger.h"
+
+#include <ctime>
+#include <charconv>
+#include <algorithm>
+
+namespace {
+
+constexpr auto kDrainInterval = std::chrono::milliseconds(10);
+
+// Distinguishes logger instances so a thread's cached ring is never reused across them
+std::atomic<uint64_t> nextInstanceId{1};
+
+// The calling thread's ring; marked abandoned when the thread exits
+struct ThreadRing {
+    uint64_t ownerId = 0;
+    std::shared_ptr<void> ring;
+    std::atomic<bool>* abandoned = nullptr;
+
+    ~ThreadRing() {
+        if (abandoned != nullptr) {
+            abandoned->store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadRing threadRing;
+
+const char* levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO:  return "INFO ";
+        case LogLevel::WARN:  return "WARN ";
+        case LogLevel::ERROR: return "ERROR";
+        default: return "UNKNOWN";
+    }
+}
+
+} // namespace
+
+// Constructor: Creates an idle logger writing to stdout
+AsyncLogger::AsyncLogger() :
+    instanceId_(nextInstanceId.fetch_add(1)),
+    output_(stdout),
+    rateLimit_(100),
+    cachedSecond_(0),
+    droppedReported_(0),
+    running_(false),
+    flushRequests_(0),
+    flushesDone_(0),
+    totalWritten_(0),
+    totalDropped_(0),
+    totalSuppressed_(0),
+    totalTruncated_(0) {}
+
+// Destructor: Writes what is left and stops the logger thread
+AsyncLogger::~AsyncLogger() {
+    stop();
+    join();
+}
+
+// Lifecycle: Starts the logger thread
+void AsyncLogger::start() {
+    if (running_.load()) {
+        return;
+    }
+
+    running_.store(true);
+    loggerThread_ = std::thread(&AsyncLogger::loggerThread, this);
+}
+
+// Lifecycle: Asks the logger thread to write the remaining records and exit
+void AsyncLogger::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        running_.store(false);
+    }
+    wakeCv_.notify_all();
+    flushedCv_.notify_all();
+}
+
+// Lifecycle: Waits for the logger thread to finish
+void AsyncLogger::join() {
+    if (loggerThread_.joinable()) {
+        loggerThread_.join();
+    }
+}
+
+// Logging: Queues an already formatted message, split over continuation records when it
+// is longer than one payload. All records are published together, so the logger thread
+// never sees part of a message.
+void AsyncLogger::log(LogLevel level, std::string_view message) {
+    constexpr size_t kChunkBytes = kPayloadBytes - 1 - sizeof(uint16_t);
+    size_t records = std::max<size_t>(1, (message.size() + kChunkBytes - 1) / kChunkBytes);
+    bool truncated = records > kMaxMessageRecords;
+    records = std::min(records, kMaxMessageRecords);
+
+    Ring& ring = ringForThread();
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    if (tail + records - ring.head.load(std::memory_order_acquire) > kRingSlots) {
+        totalDropped_.fetch_add(records, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t timestampNs = now();
+    for (size_t i = 0; i < records; ++i) {
+        Record& record = ring.slots[(tail + i) % kRingSlots];
+        initRecord(record, level, nullptr, timestampNs);
+        if (i + 1 < records) {
+            record.flags |= kContinued;
+        } else if (truncated) {
+            record.flags |= kTruncated;
+        }
+        encode(record, message.substr(std::min(message.size(), i * kChunkBytes), kChunkBytes));
+    }
+    ring.tail.store(tail + records, std::memory_order_release);
+}
+
+// Logging: Waits until every record queued before the call has been written
+void AsyncLogger::flush() {
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    if (!running_.load()) {
+        return;
+    }
+
+    uint64_t target = ++flushRequests_;
+    wakeCv_.notify_one();
+    flushedCv_.wait(lock, [this, target] { return flushesDone_ >= target || !running_.load(); });
+}
+
+// Configuration: Sets the output stream (call before start)
+void AsyncLogger::setOutput(FILE* output) {
+    output_ = output;
+}
+
+// Configuration: Sets how many messages of one kind are written per second
+void AsyncLogger::setRateLimit(size_t messagesPerSecond) {
+    rateLimit_.store(messagesPerSecond);
+}
+
+// Statistics: Returns the number of lines written
+uint64_t AsyncLogger::getTotalWritten() const {
+    return totalWritten_.load();
+}
+
+// Statistics: Returns the number of records lost to full rings
+uint64_t AsyncLogger::getTotalDropped() const {
+    return totalDropped_.load();
+}
+
+// Statistics: Returns the number of messages folded by the rate limit
+uint64_t AsyncLogger::getTotalSuppressed() const {
+    return totalSuppressed_.load();
+}
+
+// Statistics: Returns the number of messages cut short (marked "[truncated]")
+uint64_t AsyncLogger::getTotalTruncated() const {
+    return totalTruncated_.load();
+}
+
+// Status: Check if the logger thread is running
+bool AsyncLogger::isRunning() const {
+    return running_.load();
+}
+
+// Helper: Wall-clock nanoseconds, from the coarse clock where the platform has one
+uint64_t AsyncLogger::now() {
+#ifdef CLOCK_REALTIME_COARSE
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Producer: Returns the calling thread's ring, registering one on first use
+AsyncLogger::Ring& AsyncLogger::ringForThread() {
+    if (threadRing.ownerId != instanceId_) {
+        if (threadRing.abandoned != nullptr) {
+            threadRing.abandoned->store(true, std::memory_order_release);
+        }
+
+        auto ring = std::make_shared<Ring>();
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            rings_.push_back(ring);
+        }
+        threadRing.ownerId = instanceId_;
+        threadRing.abandoned = &ring->abandoned;
+        threadRing.ring = std::move(ring);
+    }
+    return *static_cast<Ring*>(threadRing.ring.get());
+}
+
+// Producer: Claims the next slot of the calling thread's ring, or nullptr when it is full
+AsyncLogger::Record* AsyncLogger::beginRecord(LogLevel level, const char* format) {
+    Ring& ring = ringForThread();
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    if (tail - ring.head.load(std::memory_order_acquire) >= kRingSlots) {
+        totalDropped_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Record& record = ring.slots[tail % kRingSlots];
+    initRecord(record, level, format, now());
+    return &record;
+}
+
+// Producer: Publishes the slot claimed by beginRecord
+void AsyncLogger::commitRecord() {
+    Ring& ring = ringForThread();
+    ring.tail.store(ring.tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Producer: Resets a claimed slot for a new record
+void AsyncLogger::initRecord(Record& record, LogLevel level, const char* format, uint64_t timestampNs) {
+    record.timestampNs = timestampNs;
+    record.format = format;
+    record.level = static_cast<uint8_t>(level);
+    record.argCount = 0;
+    record.payloadSize = 0;
+    record.flags = 0;
+}
+
+// Encoding: Appends a signed integer argument
+void AsyncLogger::encode(Record& record, int64_t value) {
+    if (record.payloadSize + 1 + sizeof(value) > kPayloadBytes) {
+        record.flags |= kTruncated;
+        return;
+    }
+    record.payload[record.payloadSize++] = 'i';
+    std::memcpy(record.payload + record.payloadSize, &value, sizeof(value));
+    record.payloadSize += sizeof(value);
+    record.argCount++;
+}
+
+// Encoding: Appends an unsigned integer argument
+void AsyncLogger::encode(Record& record, uint64_t value) {
+    if (record.payloadSize + 1 + sizeof(value) > kPayloadBytes) {
+        record.flags |= kTruncated;
+        return;
+    }
+    record.payload[record.payloadSize++] = 'u';
+    std::memcpy(record.payload + record.payloadSize, &value, sizeof(value));
+    record.payloadSize += sizeof(value);
+    record.argCount++;
+}
+
+// Encoding: Appends a floating point argument
+void AsyncLogger::encode(Record& record, double value) {
+    if (record.payloadSize + 1 + sizeof(value) > kPayloadBytes) {
+        record.flags |= kTruncated;
+        return;
+    }
+    record.payload[record.payloadSize++] = 'd';
+    std::memcpy(record.payload + record.payloadSize, &value, sizeof(value));
+    record.payloadSize += sizeof(value);
+    record.argCount++;
+}
+
+// Encoding: Appends a string argument, truncated to the space left in the record
+void AsyncLogger::encode(Record& record, std::string_view value) {
+    size_t header = 1 + sizeof(uint16_t);
+    if (record.payloadSize + header > kPayloadBytes) {
+        record.flags |= kTruncated;
+        return;
+    }
+    uint16_t length = static_cast<uint16_t>(std::min(value.size(), kPayloadBytes - record.payloadSize - header));
+    if (length < value.size()) {
+        record.flags |= kTruncated;
+    }
+    record.payload[record.payloadSize++] = 's';
+    std::memcpy(record.payload + record.payloadSize, &length, sizeof(length));
+    record.payloadSize += sizeof(length);
+    std::memcpy(record.payload + record.payloadSize, value.data(), length);
+    record.payloadSize += length;
+    record.argCount++;
+}
+
+// Background: Drains the rings every few milliseconds (or on flush) and writes the batch
+void AsyncLogger::loggerThread() {
+    std::vector<Record> batch;
+
+    while (true) {
+        bool stopping = !running_.load();
+        uint64_t flushTarget;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            flushTarget = flushRequests_;
+        }
+
+        drain(batch);
+        write(batch);
+        batch.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            flushesDone_ = flushTarget;
+        }
+        flushedCv_.notify_all();
+
+        if (stopping) {
+            break;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        wakeCv_.wait_for(lock, kDrainInterval, [this] {
+            return !running_.load() || flushRequests_ != flushesDone_;
+        });
+    }
+
+    std::string out;
+    flushRateWindows(0, out, true);
+    if (!out.empty()) {
+        std::fwrite(out.data(), 1, out.size(), output_);
+        std::fflush(output_);
+    }
+}
+
+// Background: Copies every published record out of the rings and frees their slots
+size_t AsyncLogger::drain(std::vector<Record>& batch) {
+    size_t drained = 0;
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+
+    for (auto it = rings_.begin(); it != rings_.end();) {
+        Ring& ring = **it;
+        bool abandoned = ring.abandoned.load(std::memory_order_acquire);
+        uint64_t head = ring.head.load(std::memory_order_relaxed);
+        uint64_t tail = ring.tail.load(std::memory_order_acquire);
+
+        for (uint64_t position = head; position < tail; ++position) {
+            batch.push_back(ring.slots[position % kRingSlots]);
+        }
+        drained += tail - head;
+        ring.head.store(tail, std::memory_order_release);
+
+        // Abandoned before the tail was read, so nothing can follow
+        if (abandoned) {
+            it = rings_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return drained;
+}
+
+// Background: Formats a batch in timestamp order and writes it with a single call.
+// Continuation records share their message's timestamp and ring, so the stable sort
+// keeps them adjacent and in order.
+void AsyncLogger::write(std::vector<Record>& batch) {
+    std::string out;
+    std::string message;
+    uint64_t written = 0;
+
+    std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const Record& record = batch[i];
+        message.clear();
+        formatRecord(record, message);
+        uint8_t flags = record.flags;
+        while ((batch[i].flags & kContinued) && i + 1 < batch.size()) {
+            formatRecord(batch[++i], message);
+            flags |= batch[i].flags;
+        }
+        if (flags & kTruncated) {
+            message += " [truncated]";
+            totalTruncated_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (admit(record, message, out)) {
+            written++;
+        }
+    }
+
+    uint64_t dropped = totalDropped_.load();
+    if (dropped > droppedReported_) {
+        appendPrefix(out, now(), LogLevel::WARN);
+        out += "Dropped " + std::to_string(dropped - droppedReported_) + " log records (logging ring full)\n";
+        droppedReported_ = dropped;
+    }
+    flushRateWindows(now() / 1000000000ULL, out, false);
+
+    if (!out.empty()) {
+        std::fwrite(out.data(), 1, out.size(), output_);
+        std::fflush(output_);
+    }
+    totalWritten_.fetch_add(written);
+}
+
+// Background: Expands a record's format string with its decoded arguments
+void AsyncLogger::formatRecord(const Record& record, std::string& message) const {
+    const char* position = record.payload;
+    const char* end = record.payload + record.payloadSize;
+
+    auto appendNext = [&]() {
+        if (position >= end) {
+            return;
+        }
+        char tag = *position++;
+        char digits[32];
+        if (tag == 's') {
+            uint16_t length;
+            std::memcpy(&length, position, sizeof(length));
+            position += sizeof(length);
+            message.append(position, length);
+            position += length;
+        } else if (tag == 'i') {
+            int64_t value;
+            std::memcpy(&value, position, sizeof(value));
+            position += sizeof(value);
+            message.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+        } else if (tag == 'u') {
+            uint64_t value;
+            std::memcpy(&value, position, sizeof(value));
+            position += sizeof(value);
+            message.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+        } else if (tag == 'd') {
+            double value;
+            std::memcpy(&value, position, sizeof(value));
+            position += sizeof(value);
+            message.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+        }
+    };
+
+    if (record.format == nullptr) {
+        appendNext();
+        return;
+    }
+    for (const char* c = record.format; *c != '\0'; ++c) {
+        if (c[0] == '{' && c[1] == '}') {
+            appendNext();
+            ++c;
+        } else {
+            message += *c;
+        }
+    }
+}
+
+// Background: Appends the line unless its kind exceeded the rate limit this second.
+// Kinds are the format string, or for preformatted messages the text without digits.
+bool AsyncLogger::admit(const Record& record, const std::string& message, std::string& out) {
+    size_t limit = rateLimit_.load();
+    LogLevel level = static_cast<LogLevel>(record.level);
+
+    if (limit > 0) {
+        std::string key;
+        if (record.format != nullptr) {
+            key = std::to_string(reinterpret_cast<uintptr_t>(record.format));
+        } else {
+            key.reserve(message.size());
+            for (char c : message) {
+                if (c < '0' || c > '9') {
+                    key += c;
+                }
+            }
+        }
+
+        uint64_t second = record.timestampNs / 1000000000ULL;
+        RateWindow& window = rateWindows_[key];
+        if (window.second != second) {
+            if (window.suppressed > 0) {
+                appendPrefix(out, record.timestampNs, LogLevel::WARN);
+                out += "Suppressed " + std::to_string(window.suppressed) + " repeats of: " + window.sample + "\n";
+            }
+            window = RateWindow{second, 0, 0, message};
+        }
+        if (window.written >= limit) {
+            window.suppressed++;
+            totalSuppressed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        window.written++;
+    }
+
+    appendPrefix(out, record.timestampNs, level);
+    out += message;
+    out += '\n';
+    return true;
+}
+
+// Background: Appends "[HH:MM:SS.mmm] [LEVEL] ", formatting the clock once per second
+void AsyncLogger::appendPrefix(std::string& out, uint64_t timestampNs, LogLevel level) {
+    uint64_t second = timestampNs / 1000000000ULL;
+    if (second != cachedSecond_ || cachedTime_.empty()) {
+        time_t time = static_cast<time_t>(second);
+        tm local;
+        localtime_r(&time, &local);
+        char buffer[16];
+        std::strftime(buffer, sizeof(buffer), "%H:%M:%S", &local);
+        cachedTime_ = buffer;
+        cachedSecond_ = second;
+    }
+
+    char millis[8];
+    std::snprintf(millis, sizeof(millis), ".%03u", static_cast<unsigned>((timestampNs / 1000000ULL) % 1000));
+    out += '[';
+    out += cachedTime_;
+    out += millis;
+    out += "] [";
+    out += levelName(level);
+    out += "] ";
+}
+
+// Background: Reports and forgets rate windows older than second (or all of them)
+void AsyncLogger::flushRateWindows(uint64_t second, std::string& out, bool all) {
+    for (auto it = rateWindows_.begin(); it != rateWindows_.end();) {
+        if (!all && it->second.second >= second) {
+            ++it;
+            continue;
+        }
+        if (it->second.suppressed > 0) {
+            appendPrefix(out, now(), LogLevel::WARN);
+            out += "Suppressed " + std::to_string(it->second.suppressed) + " repeats of: " + it->second.sample + "\n";
+        }
+        it = rateWindows_.erase(it);
+    }
+}
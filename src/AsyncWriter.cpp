@@ -1,15 +1,19 @@
 #include "AsyncWriter.h"
+#include "Tracer.h"
 #include "Broker.h"
 #include "Metrics.h"
 
-#include <iostream>
 #include <chrono>
+#include <map>
 
 // Constructor: Initializes the async writer
 AsyncWriter::AsyncWriter(Broker& broker) : 
     broker_(broker), 
     running_(false), 
-    totalProcessedMessages_(0) {}
+    totalProcessedMessages_(0),
+    lanesVersion_(0),
+    pendingMessages_(0),
+    writerIdle_(false) {}
 
 // Destructor: Stops the writer thread
 AsyncWriter::~AsyncWriter() {
@@ -25,7 +29,7 @@ void AsyncWriter::start() {
     
     running_.store(true);
     writerThread_ = std::thread(&AsyncWriter::writerThread, this);
-    std::cout << "AsyncWriter started" << std::endl;
+    Metrics::getInstance().logInfo("AsyncWriter started");
 }
 
 // Lifecycle: Stops the background writer thread
@@ -37,39 +41,81 @@ void AsyncWriter::stop() {
     running_.store(false);
     
     // Shutdown all queues to wake up waiting threads
-    std::lock_guard<std::mutex> lock(queuesMutex_);
-    for (auto& [topicName, queue] : topicQueues_) {
-        queue->shutdown();
+    {
+        std::lock_guard lock(queuesMutex_);
+        for (auto& [topicName, lane] : topicLanes_) {
+            lane->queue->shutdown();
+        }
     }
+    notifyWriter();
     
-    std::cout << "AsyncWriter stopping..." << std::endl;
+    Metrics::getInstance().logInfo("AsyncWriter stopping...");
 }
 
 // Lifecycle: Waits for the writer thread to finish
 void AsyncWriter::join() {
     if (writerThread_.joinable()) {
         writerThread_.join();
-        std::cout << "AsyncWriter stopped" << std::endl;
+        Metrics::getInstance().logInfo("AsyncWriter stopped");
     }
 }
 
 // Message handling: Enqueues a message for async processing (copy version)
 void AsyncWriter::enqueueMessage(const std::string& topicName, const Message& message) {
-    getOrCreateQueue(topicName).push(message);
-    Metrics::getInstance().updateQueueSize(topicName, getOrCreateQueue(topicName).size());
+    TopicLane& lane = getOrCreateLane(topicName);
+    if (!lane.queue->push(message)) {
+        return; // Writer stopped; the queue is shut down
+    }
+    pendingMessages_.fetch_add(1);
+    notifyWriter();
+    Metrics::getInstance().updateQueueSize(*lane.metrics, lane.queue->size());
 }
 
 // Message handling: Enqueues a message for async processing (move version)
 void AsyncWriter::enqueueMessage(const std::string& topicName, Message&& message) {
-    getOrCreateQueue(topicName).push(std::move(message));
-    Metrics::getInstance().updateQueueSize(topicName, getOrCreateQueue(topicName).size());
+    TopicLane& lane = getOrCreateLane(topicName);
+    if (!lane.queue->push(std::move(message))) {
+        return; // Writer stopped; the queue is shut down
+    }
+    pendingMessages_.fetch_add(1);
+    notifyWriter();
+    Metrics::getInstance().updateQueueSize(*lane.metrics, lane.queue->size());
+}
+
+// Message handling: Enqueues a message and invokes onAppended once it is written
+void AsyncWriter::enqueueMessage(const std::string& topicName, Message&& message,
+                                 std::function<void(std::exception_ptr)> onAppended) {
+    TopicLane& lane = getOrCreateLane(topicName);
+    if (!lane.queue->push(std::move(message), std::move(onAppended))) {
+        return; // Writer stopped; the queue is shut down
+    }
+    pendingMessages_.fetch_add(1);
+    notifyWriter();
+    Metrics::getInstance().updateQueueSize(*lane.metrics, lane.queue->size());
+}
+
+// Scheduling: Assigns a topic to a scheduling class (takes effect on the next round)
+void AsyncWriter::setSchedulingClass(const std::string& topicName, const SchedulingClass& schedulingClass) {
+    TopicLane& lane = getOrCreateLane(topicName);
+    {
+        std::lock_guard lock(queuesMutex_);
+        lane.schedulingClass = schedulingClass;
+    }
+    lanesVersion_.fetch_add(1);
+}
+
+// Scheduling: Returns the scheduling class of a topic (default if never configured)
+SchedulingClass AsyncWriter::getSchedulingClass(const std::string& topicName) const {
+    std::lock_guard lock(queuesMutex_);
+    auto it = topicLanes_.find(topicName);
+    return (it != topicLanes_.end()) ? it->second->schedulingClass : SchedulingClass();
 }
 
 // Statistics: Returns queue size for specific topic
 size_t AsyncWriter::getQueueSize(const std::string& topicName) const {
-    std::lock_guard<std::mutex> lock(queuesMutex_);
-    auto it = topicQueues_.find(topicName);
-    return (it != topicQueues_.end()) ? it->second->size() : 0;
+    std::lock_guard lock(queuesMutex_);
+    auto it = topicLanes_.find(topicName);
+    return (it != topicLanes_.end()) ? it->second->queue->size() : 0;
 }
 
 // Statistics: Returns total number of processed messages
@@ -82,49 +128,183 @@ bool AsyncWriter::isRunning() const {
     return running_.load();
 }
 
-// Background: Main writer thread that processes messages
+// Background: Main writer thread. Lanes are served in strict priority order; topics
+// sharing a priority are served by deficit round-robin weighted by their quantum.
+// After each round the scan restarts from the highest lane, so a backlog in a
+// lower lane can delay higher-priority traffic by at most one round.
 void AsyncWriter::writerThread() {
-    std::cout << "AsyncWriter thread started" << std::endl;
+    Metrics::getInstance().logInfo("AsyncWriter thread started");
+    
+    Schedule schedule;
+    uint64_t scheduleVersion = UINT64_MAX;
     
     while (running_.load()) {
-        bool processedAny = false;
+        refreshSchedule(schedule, scheduleVersion);
         
-        // Process messages from all topic queues
-        {
-            std::lock_guard<std::mutex> lock(queuesMutex_);
-            for (auto& [topicName, queue] : topicQueues_) {
-                Message message("", "");
-                if (queue->tryPop(message, std::chrono::milliseconds(100))) {
-                    try {
-                        // Write message to the actual topic
-                        broker_.appendSync(topicName, message);
-                        totalProcessedMessages_.fetch_add(1);
-                        processedAny = true;
-                        
-                        Metrics::getInstance().updateQueueSize(topicName, queue->size());
-                    } catch (const std::exception& e) {
-                        Metrics::getInstance().logError("Error writing message to topic " + topicName + ": " + e.what());
-                    }
-                }
+        bool servedAny = false;
+        for (auto& lanes : schedule) {
+            if (serveRound(lanes)) {
+                servedAny = true;
+                break;
             }
         }
         
-        if (!processedAny) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (!servedAny) {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            writerIdle_.store(true);
+            wakeCv_.wait_for(lock, std::chrono::milliseconds(10), [this] {
+                return pendingMessages_.load() > 0 || !running_.load();
+            });
+            writerIdle_.store(false);
+        }
+    }
+    
+    failUnwritten();
+    Metrics::getInstance().logInfo("AsyncWriter thread finished");
+}
+
+// Internal: Runs one deficit-round-robin round over the topics of a single priority lane.
+// Returns true if any topic in the lane had a backlog.
+bool AsyncWriter::serveRound(std::vector<ScheduledLane>& lanes) {
+    bool hadBacklog = false;
+    
+    for (auto& scheduled : lanes) {
+        TopicLane& lane = *scheduled.lane;
+        uint64_t frontBytes = 0;
+        if (!lane.queue->frontSize(frontBytes)) {
+            lane.deficit = 0; // Idle topics do not bank credit
+            continue;
+        }
+        
+        hadBacklog = true;
+        lane.deficit += scheduled.schedulingClass.getQuantumBytes();
+        
+        do {
+            if (frontBytes > lane.deficit) {
+                break; // Keep the credit, the message goes out in a later round
+            }
+            
+            QueuedMessage entry{Message("", ""), {}, nullptr};
+            if (!lane.queue->tryPopFront(entry)) {
+                break;
+            }
+            pendingMessages_.fetch_sub(1);
+            lane.deficit -= frontBytes;
+            writeMessage(scheduled, entry);
+        } while (lane.queue->frontSize(frontBytes));
+        
+        if (lane.queue->empty()) {
+            lane.deficit = 0;
+        }
+    }
+    
+    return hadBacklog;
+}
+
+// Internal: Writes one dequeued message to its topic, records scheduling metrics and
+// completes the entry's callback
+void AsyncWriter::writeMessage(const ScheduledLane& scheduled, QueuedMessage& entry) {
+    const std::string& topicName = scheduled.lane->topicName;
+    auto queueDelay = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - entry.enqueuedAt);
+    uint64_t traceId = entry.message.getTraceId();
+    if (traceId != 0) {
+        Tracer::getInstance().record(traceId, "writer.queued", entry.enqueuedTicks, Tracer::now());
+    }
+    TraceSpan span(traceId, "writer.write");
+    
+    std::exception_ptr error;
+    try {
+        // Write message to the actual topic
+        broker_.appendSync(topicName, std::move(entry.message)); // Queue entry is discarded after this
+        totalProcessedMessages_.fetch_add(1);
+        
+        Metrics::getInstance().recordEnqueueToAppend(*scheduled.lane->metrics,
+                                                      std::chrono::steady_clock::now() - entry.enqueuedAt);
+        
+        Metrics::getInstance().recordQueueDelay(*scheduled.classMetrics, queueDelay);
+        Metrics::getInstance().updateQueueSize(*scheduled.lane->metrics, scheduled.lane->queue->size());
+    } catch (const std::exception& e) {
+        error = std::current_exception();
+        Metrics::getInstance().logError("Error writing message to topic " + topicName + ": " + e.what());
+    }
+    
+    if (entry.onAppended) {
+        entry.onAppended(error);
+    }
+}
+
+// Internal: Completes the callbacks of messages still queued when the writer stops, so
+// nobody waits for an append that will never happen (the queues are shut down by now)
+void AsyncWriter::failUnwritten() {
+    std::vector<TopicLane*> lanes;
+    {
+        std::lock_guard lock(queuesMutex_);
+        lanes = laneOrder_;
+    }
+    
+    auto error = std::make_exception_ptr(std::runtime_error("AsyncWriter stopped before the message was written"));
+    QueuedMessage entry{Message("", ""), {}, nullptr};
+    for (TopicLane* lane : lanes) {
+        while (lane->queue->tryPopFront(entry)) {
+            pendingMessages_.fetch_sub(1);
+            if (entry.onAppended) {
+                entry.onAppended(error);
+            }
+        }
+    }
+}
+
+// Internal: Rebuilds the writer's priority-ordered view of the lanes when it changed
+void AsyncWriter::refreshSchedule(Schedule& schedule, uint64_t& scheduleVersion) {
+    uint64_t currentVersion = lanesVersion_.load();
+    if (currentVersion == scheduleVersion) {
+        return;
+    }
+    
+    std::map<int32_t, std::vector<ScheduledLane>, std::greater<int32_t>> byPriority;
+    {
+        std::lock_guard lock(queuesMutex_);
+        for (TopicLane* lane : laneOrder_) {
+            auto& classMetrics = Metrics::getInstance().schedulingClassMetrics(lane->schedulingClass.getName());
+            byPriority[lane->schedulingClass.getPriority()].push_back({lane, lane->schedulingClass, &classMetrics});
         }
     }
     
-    std::cout << "AsyncWriter thread finished" << std::endl;
+    schedule.clear();
+    for (auto& [priority, lanes] : byPriority) {
+        schedule.push_back(std::move(lanes));
+    }
+    scheduleVersion = currentVersion;
 }
 
-// Internal: Gets or creates a message queue for a topic
-MessageQueue& AsyncWriter::getOrCreateQueue(const std::string& topicName) {
-    std::lock_guard<std::mutex> lock(queuesMutex_);
+// Internal: Gets or creates the writer lane for a topic
+AsyncWriter::TopicLane& AsyncWriter::getOrCreateLane(const std::string& topicName) {
+    std::lock_guard lock(queuesMutex_);
     
-    auto it = topicQueues_.find(topicName);
-    if (it == topicQueues_.end()) {
-        topicQueues_[topicName] = std::make_unique<MessageQueue>();
+    auto it = topicLanes_.find(topicName);
+    if (it != topicLanes_.end()) {
+        return *it->second;
     }
     
-    return *topicQueues_[topicName];
+    auto lane = std::make_unique<TopicLane>();
+    lane->topicName = topicName;
+    lane->queue = std::make_unique<MessageQueue>();
+    lane->metrics = &Metrics::getInstance().topicMetrics(topicName);
+    TopicLane& laneRef = *lane;
+    
+    topicLanes_[topicName] = std::move(lane);
+    laneOrder_.push_back(&laneRef);
+    lanesVersion_.fetch_add(1);
+    
+    return laneRef;
+}
+
+// Internal: Wakes the writer thread if it is waiting for work. Taking wakeMutex_ orders
+// the notify after the writer's predicate check, so the wake-up cannot be lost.
+void AsyncWriter::notifyWriter() {
+    if (writerIdle_.load()) {
+        { std::lock_guard<std::mutex> lock(wakeMutex_); }
+        wakeCv_.notify_one();
+    }
 }
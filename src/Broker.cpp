@@ -3,33 +3,63 @@
 #include "RetentionCleaner.h"
 #include "RetentionPolicy.h"
 #include "Metrics.h"
+#include "Tracer.h"
+#include "FileGroupStore.h"
+#include "PostgresGroupStore.h"
 
-// Constructor: Initializes broker with given ID
+#include <filesystem>
+
+// Constructor: Initializes broker with given ID (committed offsets kept in memory only)
 Broker::Broker(std::string id):
+    Broker(std::move(id), "") {}
+
+// Constructor: Initializes broker with given ID, recovering committed offsets from dataDirectory
+Broker::Broker(std::string id, std::string dataDirectory):
     id_(std::move(id)),
+    dataDirectory_(dataDirectory),
     asyncWriter_(std::make_unique<AsyncWriter>(*this)),
-    retentionCleaner_(std::make_unique<RetentionCleaner>()) {}
+    retentionCleaner_(std::make_unique<RetentionCleaner>()),
+    offsetStore_(std::make_unique<OffsetStore>(std::move(dataDirectory))),
+    lagTracker_(std::make_unique<LagTracker>()),
+    sessionTimers_(std::make_unique<TimerWheel>()) {
+    offsetStore_->forEachCommittedOffset([this](const std::string& groupId, const std::string& topicName,
+                                                uint32_t partitionId, uint64_t offset) {
+        lagTracker_->recordCommit(groupId, topicName, partitionId, offset);
+    });
+    offsetStore_->start();
+    sessionTimers_->start();
+}
 
-// Destructor: Stops async writer and retention cleaner
+// Destructor: Stops async writer, retention cleaner, session timers and offset flusher
 Broker::~Broker() {
     stopAsyncWriter();
     stopRetentionCleaner();
+    sessionTimers_->stop();
+    sessionTimers_->join();
+    offsetStore_->stop();
+    offsetStore_->join();
 }
 
-// Management: Creates a new topic with specified name and partition count
-void Broker::createTopic(const std::string topicName, size_t numPartitions) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (topics_.contains(topicName)) {
-        throw std::runtime_error("Topic " + topicName + " already exists");
+// Management: Creates a new topic with specified name, partition count and writer scheduling class
+void Broker::createTopic(const std::string topicName, size_t numPartitions, const SchedulingClass& schedulingClass) {
+    {
+        std::lock_guard lock(mutex_);
+        
+        if (topics_.contains(topicName)) {
+            throw std::runtime_error("Topic " + topicName + " already exists");
+        }
+        
+        auto topic = std::make_shared<Topic>(topicName, numPartitions);
+        topic->setTopicLag(lagTracker_->getTopicLag(topicName));
+        topics_[topicName] = std::move(topic);
     }
     
-    topics_[topicName] = std::make_shared<Topic>(topicName, numPartitions);
+    asyncWriter_->setSchedulingClass(topicName, schedulingClass);
 }
 
 // Utility: Checks if a topic with given name exists
 bool Broker::hasTopic(const std::string& topicName) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
     return topics_.contains(topicName);
 }
 
@@ -37,45 +67,128 @@ bool Broker::hasTopic(const std::string& topicName) const {
 void Broker::append(const std::string& topicName, const Message& message) {
     checkTopicExists(topicName);
     Metrics::getInstance().incrementMessagesSent();
-    asyncWriter_->enqueueMessage(topicName, message);
+    
+    uint64_t traceId = (message.getTraceId() == 0) ? Tracer::getInstance().sample() : 0;
+    if (traceId == 0) {
+        TraceSpan span(message.getTraceId(), "broker.send");
+        asyncWriter_->enqueueMessage(topicName, message);
+        return;
+    }
+    
+    Message traced(message);
+    traced.setTraceId(traceId);
+    TraceSpan span(traceId, "broker.send");
+    asyncWriter_->enqueueMessage(topicName, std::move(traced));
 }
 
 // Core: Creates and sends a message to specified topic (async, non-blocking)
 void Broker::send(const std::string& topicName, const std::string& key, const std::string& value) {
     checkTopicExists(topicName);
     Message message(key, value);
+    message.setTraceId(Tracer::getInstance().sample());
     Metrics::getInstance().incrementMessagesSent();
+    TraceSpan span(message.getTraceId(), "broker.send");
     asyncWriter_->enqueueMessage(topicName, std::move(message));
 }
 
-// Internal: Synchronous append for use by AsyncWriter
+// Core: Sends a message and invokes onAppended once it is written (or with the write error)
+void Broker::send(const std::string& topicName, const std::string& key, const std::string& value,
+                  std::function<void(std::exception_ptr)> onAppended) {
+    checkTopicExists(topicName);
+    Message message(key, value);
+    message.setTraceId(Tracer::getInstance().sample());
+    Metrics::getInstance().incrementMessagesSent();
+    TraceSpan span(message.getTraceId(), "broker.send");
+    asyncWriter_->enqueueMessage(topicName, std::move(message), std::move(onAppended));
+}
+
+// Internal: Synchronous append of a copy of a message
 void Broker::appendSync(const std::string& topicName, const Message& message) {
-    auto start = std::chrono::high_resolution_clock::now();
+    appendSync(topicName, Message(message));
+}
+
+// Internal: Synchronous append for use by AsyncWriter (the broker lock only covers the topic lookup)
+void Broker::appendSync(const std::string& topicName, Message&& message) {
+    uint64_t sizeBytes = message.getSizeBytes();
+    auto start = std::chrono::steady_clock::now();
     
-    std::lock_guard<std::mutex> lock(mutex_);
-    checkTopicExists(topicName);
-    topics_[topicName]->append(message);
+    std::shared_ptr<Topic> topic;
+    {
+        TraceSpan span(message.getTraceId(), "broker.lock_wait");
+        topic = getTopic(topicName);
+    }
+    topic->append(std::move(message));
+    topic->getTopicLag()->refresh(topic->getAppendCount());
     
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    auto duration = std::chrono::steady_clock::now() - start;
     
-    Metrics::getInstance().incrementMessagesProcessed();
-    Metrics::getInstance().recordProcessingTime(topicName, duration);
+    Metrics& metrics = Metrics::getInstance();
+    Metrics::TopicMetrics& topicMetrics = metrics.topicMetrics(topicName);
+    metrics.incrementMessagesProcessed();
+    metrics.recordProcessingTime(topicMetrics, duration);
+    metrics.recordMessagesIn(topicMetrics, 1, sizeBytes);
 }
 
 // Reader: Retrieves messages from specific topic and partition
 std::vector<Message> Broker::getMessages(const std::string& topicName, uint32_t partitionId, uint64_t from, uint64_t to) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t startTicks = Tracer::getInstance().isEnabled() ? Tracer::now() : 0;
+    std::lock_guard lock(mutex_);
     checkTopicExists(topicName);
 
     Topic& topic = *topics_.at(topicName);
     Partition& partition = topic.getPartition(partitionId);
-    return partition.getMessages(from, to);
+    std::vector<Message> messages = partition.getMessages(from, to);
+    recordFetched(topicName, partition, messages, startTicks);
+    return messages;
+}
+
+// Reader: Fetches up to maxRecords/maxBytes from one partition under a single lock acquisition
+std::vector<Message> Broker::fetch(const std::string& topicName, uint32_t partitionId, uint64_t from,
+                                   size_t maxRecords, uint64_t maxBytes) const {
+    uint64_t startTicks = Tracer::getInstance().isEnabled() ? Tracer::now() : 0;
+    std::lock_guard lock(mutex_);
+    checkTopicExists(topicName);
+
+    Partition& partition = topics_.at(topicName)->getPartition(partitionId);
+    std::vector<Message> messages = partition.fetch(from, maxRecords, maxBytes);
+    recordFetched(topicName, partition, messages, startTicks);
+    return messages;
+}
+
+// Utility: Returns the number of partitions of specified topic
+size_t Broker::getNumPartitions(const std::string& topicName) const {
+    return getTopic(topicName)->getNumPartitions();
+}
+
+// Utility: Returns the offset the next message appended to a partition will get
+uint64_t Broker::getLogEndOffset(const std::string& topicName, uint32_t partitionId) const {
+    return getTopic(topicName)->getPartition(partitionId).size();
+}
+
+// Notification: Returns the append counter of specified topic
+uint64_t Broker::getAppendCount(const std::string& topicName) const {
+    return getTopic(topicName)->getAppendCount();
+}
+
+// Notification: Waits (without holding the broker lock) for an append newer than 'seenAppends'
+bool Broker::waitForAppend(const std::string& topicName, uint64_t seenAppends, std::chrono::milliseconds timeout) const {
+    return getTopic(topicName)->waitForAppend(seenAppends, timeout);
+}
+
+// Notification: Invokes callback on the topic's next append after 'seenAppends'
+void Broker::notifyOnAppend(const std::string& topicName, uint64_t seenAppends, std::function<void()> callback) const {
+    getTopic(topicName)->notifyOnAppend(seenAppends, std::move(callback));
+}
+
+// Notification: Invokes callback once specified offset exists in the partition
+void Broker::notifyWhenAvailable(const std::string& topicName, uint32_t partitionId, uint64_t offset,
+                                 std::function<void()> callback) const {
+    getTopic(topicName)->getPartition(partitionId).notifyWhenAvailable(offset, std::move(callback));
 }
 
 // Utility: Returns list of all topic names managed by this broker
 std::vector<std::string> Broker::listTopics() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
     std::vector<std::string> topics;
     for (const auto& topic : topics_) {
         topics.push_back(topic.first);
@@ -95,9 +208,39 @@ void Broker::checkTopicExists(const std::string& topicName) const {
     }
 }
 
+// Internal: Returns a shared handle to specified topic, throws if it does not exist
+std::shared_ptr<Topic> Broker::getTopic(const std::string& topicName) const {
+    std::lock_guard lock(mutex_);
+    checkTopicExists(topicName);
+    return topics_.at(topicName);
+}
+
+// Internal: Marks fetched messages and bytes on the partition and topic meters, and records
+// a fetch span for traced messages (startTicks is 0 when tracing was off at the start)
+void Broker::recordFetched(const std::string& topicName, Partition& partition,
+                           const std::vector<Message>& messages, uint64_t startTicks) const {
+    if (messages.empty()) {
+        return;
+    }
+    
+    uint64_t bytes = 0;
+    uint64_t endTicks = (startTicks != 0) ? Tracer::now() : 0;
+    for (const auto& message : messages) {
+        bytes += message.getSizeBytes();
+        if (startTicks != 0) {
+            Tracer::getInstance().record(message.getTraceId(), "broker.fetch", startTicks, endTicks);
+        }
+    }
+    
+    auto now = Meter::Clock::now();
+    partition.getThroughput().markOut(messages.size(), bytes, now);
+    Metrics& metrics = Metrics::getInstance();
+    metrics.recordMessagesOut(metrics.topicMetrics(topicName), messages.size(), bytes);
+}
+
 // Metadata: Returns metadata for all topics managed by this broker
 std::vector<TopicMetadata> Broker::getTopicsMetadata() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
     std::vector<TopicMetadata> topicsMetadata;
     
     for (const auto& [topicName, topic] : topics_) {
@@ -113,9 +256,11 @@ std::vector<TopicMetadata> Broker::getTopicsMetadata() const {
             partitionMeta.messageCount = topic->getPartition(i).size();
             partitionMeta.firstOffset = (partitionMeta.messageCount > 0) ? 0 : 0;
             partitionMeta.lastOffset = (partitionMeta.messageCount > 0) ? partitionMeta.messageCount - 1 : 0;
+            partitionMeta.throughput = topic->getPartition(i).getThroughputRates();
             
             topicMeta.partitions.push_back(partitionMeta);
         }
+        topicMeta.throughput = Metrics::getInstance().getTopicThroughput(topicName);
         
         topicsMetadata.push_back(topicMeta);
     }
@@ -125,7 +270,7 @@ std::vector<TopicMetadata> Broker::getTopicsMetadata() const {
 
 // Metadata: Returns metadata for partitions of specified topic
 std::vector<PartitionMetadata> Broker::getPartitionMetadata(const std::string& topicName) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
     checkTopicExists(topicName);
     
     std::vector<PartitionMetadata> partitionsMetadata;
@@ -137,6 +282,7 @@ std::vector<PartitionMetadata> Broker::getPartitionMetadata(const std::string& t
         partitionMeta.messageCount = topic.getPartition(i).size();
         partitionMeta.firstOffset = (partitionMeta.messageCount > 0) ? 0 : 0;
         partitionMeta.lastOffset = (partitionMeta.messageCount > 0) ? partitionMeta.messageCount - 1 : 0;
+        partitionMeta.throughput = topic.getPartition(i).getThroughputRates();
         
         partitionsMetadata.push_back(partitionMeta);
     }
@@ -165,6 +311,169 @@ size_t Broker::getTotalProcessedMessages() const {
     return asyncWriter_->getTotalProcessedMessages();
 }
 
+// Async writer management: Moves a topic to another writer scheduling class
+void Broker::setSchedulingClass(const std::string& topicName, const SchedulingClass& schedulingClass) {
+    {
+        std::lock_guard lock(mutex_);
+        checkTopicExists(topicName);
+    }
+    asyncWriter_->setSchedulingClass(topicName, schedulingClass);
+}
+
+// Async writer management: Returns the writer scheduling class of a topic
+SchedulingClass Broker::getSchedulingClass(const std::string& topicName) const {
+    return asyncWriter_->getSchedulingClass(topicName);
+}
+
+// Offsets: Commits an offset for a group and waits until it is durable
+void Broker::commitOffset(const std::string& groupId, const std::string& topicName, uint32_t partitionId, uint64_t offset) {
+    offsetStore_->commitSync(groupId, topicName, partitionId, offset);
+    lagTracker_->recordCommit(groupId, topicName, partitionId, offset);
+    refreshGroupLag(groupId, topicName);
+}
+
+// Offsets: Commits an offset for a group; it is persisted with the next batched append
+void Broker::commitOffsetAsync(const std::string& groupId, const std::string& topicName, uint32_t partitionId, uint64_t offset) {
+    offsetStore_->commitAsync(groupId, topicName, partitionId, offset);
+    lagTracker_->recordCommit(groupId, topicName, partitionId, offset);
+    refreshGroupLag(groupId, topicName);
+}
+
+// Offsets: Returns the latest committed offset for a group and partition, if any
+std::optional<uint64_t> Broker::getCommittedOffset(const std::string& groupId, const std::string& topicName, uint32_t partitionId) const {
+    return offsetStore_->getCommittedOffset(groupId, topicName, partitionId);
+}
+
+// Offsets: Waits until every commit issued so far is durable
+void Broker::flushCommittedOffsets() {
+    offsetStore_->flush();
+}
+
+// Metrics export: Takes a snapshot of the process-wide metrics and of this broker
+MetricsSnapshot Broker::metricsSnapshot() const {
+    MetricsSnapshot snapshot;
+    Metrics::getInstance().collect(snapshot);
+    collectMetrics(snapshot);
+    return snapshot;
+}
+
+// Metrics export: Adds partition offsets, committed offsets and lag per group, and thread
+// statistics. Only the topic map lock is taken, and only to copy the topic handles.
+void Broker::collectMetrics(MetricsSnapshot& snapshot) const {
+    std::vector<std::pair<std::string, std::shared_ptr<Topic>>> topics;
+    {
+        std::lock_guard lock(mutex_);
+        topics.assign(topics_.begin(), topics_.end());
+    }
+    
+    std::unordered_map<std::string, std::shared_ptr<Topic>> topicsByName;
+    for (const auto& [topicName, topic] : topics) {
+        topicsByName.emplace(topicName, topic);
+        snapshot.addCounter("selfkafka_topic_appends_total", {{"broker", id_}, {"topic", topicName}},
+                            static_cast<double>(topic->getAppendCount()));
+        for (size_t i = 0; i < topic->getNumPartitions(); ++i) {
+            MetricLabels labels{{"broker", id_}, {"topic", topicName}, {"partition", std::to_string(i)}};
+            snapshot.addGauge("selfkafka_partition_log_end_offset", labels,
+                              static_cast<double>(topic->getPartition(i).size()));
+            snapshot.addThroughput("selfkafka_partition", labels, topic->getPartition(i).getThroughputRates());
+        }
+    }
+    
+    for (const auto& [groupId, topicName] : lagTracker_->getTrackedGroups()) {
+        auto it = topicsByName.find(topicName);
+        if (it == topicsByName.end()) {
+            continue;
+        }
+        for (size_t i = 0; i < it->second->getNumPartitions(); ++i) {
+            uint32_t partitionId = static_cast<uint32_t>(i);
+            uint64_t logEndOffset = it->second->getPartition(partitionId).size();
+            uint64_t committed = lagTracker_->getCommittedOffset(groupId, topicName, partitionId).value_or(0);
+            MetricLabels labels{{"broker", id_}, {"group", groupId}, {"topic", topicName},
+                                {"partition", std::to_string(partitionId)}};
+            snapshot.addGauge("selfkafka_group_committed_offset", labels, static_cast<double>(committed));
+            snapshot.addGauge("selfkafka_group_partition_lag", std::move(labels),
+                              static_cast<double>(logEndOffset > committed ? logEndOffset - committed : 0));
+        }
+    }
+    
+    MetricLabels brokerLabels{{"broker", id_}};
+    snapshot.addCounter("selfkafka_async_writer_processed_total", brokerLabels,
+                        static_cast<double>(asyncWriter_->getTotalProcessedMessages()));
+    snapshot.addCounter("selfkafka_retention_cleaned_messages_total", brokerLabels,
+                        static_cast<double>(retentionCleaner_->getTotalCleanedMessages()));
+    snapshot.addCounter("selfkafka_retention_cleaned_bytes_total", brokerLabels,
+                        static_cast<double>(retentionCleaner_->getTotalCleanedBytes()));
+    snapshot.addGauge("selfkafka_session_timers_active", brokerLabels,
+                      static_cast<double>(sessionTimers_->getActiveTimers()));
+    snapshot.addCounter("selfkafka_session_timers_expired_total", brokerLabels,
+                        static_cast<double>(sessionTimers_->getTotalExpired()));
+}
+
+// Lag: Returns per-partition lag of a group on a topic (O(partitions)) and refreshes its gauge
+GroupLag Broker::getGroupLag(const std::string& groupId, const std::string& topicName) const {
+    std::shared_ptr<Topic> topic = getTopic(topicName);
+    
+    GroupLag groupLag{groupId, topicName, {}, 0};
+    groupLag.partitions.reserve(topic->getNumPartitions());
+    for (size_t i = 0; i < topic->getNumPartitions(); ++i) {
+        uint32_t partitionId = static_cast<uint32_t>(i);
+        uint64_t logEndOffset = topic->getPartition(partitionId).size();
+        uint64_t committed = lagTracker_->getCommittedOffset(groupId, topicName, partitionId).value_or(0);
+        uint64_t lag = (logEndOffset > committed) ? logEndOffset - committed : 0;
+        
+        groupLag.partitions.push_back({partitionId, logEndOffset, committed, lag});
+        groupLag.totalLag += lag;
+    }
+    
+    Metrics::getInstance().updateConsumerLag(groupId, topicName, groupLag.totalLag);
+    return groupLag;
+}
+
+// Lag: Returns a group's total lag on a topic from two running sums and refreshes its gauge
+uint64_t Broker::getTotalGroupLag(const std::string& groupId, const std::string& topicName) const {
+    return lagTracker_->updateLag(groupId, topicName, getTopic(topicName)->getAppendCount());
+}
+
+// Internal: Refreshes a group's lag gauge after a commit. The commit is already recorded,
+// so a topic that does not exist (or no longer does) is skipped rather than reported.
+void Broker::refreshGroupLag(const std::string& groupId, const std::string& topicName) const {
+    std::shared_ptr<Topic> topic;
+    {
+        std::lock_guard lock(mutex_);
+        auto it = topics_.find(topicName);
+        if (it == topics_.end()) {
+            return;
+        }
+        topic = it->second;
+    }
+    lagTracker_->updateLag(groupId, topicName, topic->getAppendCount());
+}
+
+// Sessions: Returns the timer wheel that tracks consumer session deadlines
+TimerWheel& Broker::getSessionTimers() {
+    return *sessionTimers_;
+}
+
+// Groups: Returns the group metadata store, creating the default backend on first use
+std::shared_ptr<GroupMetadataStore> Broker::getGroupMetadataStore() {
+    std::lock_guard<std::mutex> lock(groupMetadataMutex_);
+    if (!groupMetadataStore_) {
+        if (dataDirectory_.empty()) {
+            groupMetadataStore_ = std::make_shared<PostgresGroupStore>();
+        } else {
+            auto directory = std::filesystem::path(dataDirectory_) / "__group_metadata";
+            groupMetadataStore_ = std::make_shared<FileGroupStore>(directory.string());
+        }
+    }
+    return groupMetadataStore_;
+}
+
+// Groups: Replaces the group metadata store used by groups created afterwards
+void Broker::setGroupMetadataStore(std::shared_ptr<GroupMetadataStore> store) {
+    std::lock_guard<std::mutex> lock(groupMetadataMutex_);
+    groupMetadataStore_ = std::move(store);
+}
+
 // Retention management: Starts the retention cleaner
 void Broker::startRetentionCleaner() {
     retentionCleaner_->start();
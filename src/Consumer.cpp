@@ -1,20 +1,73 @@
 #include "Consumer.h"
+#include "CoroutineExecutor.h"
+#include "Tracer.h"
+
+#include <algorithm>
+
+namespace {
+
+// Batch size used by next() to refill its local buffer
+constexpr size_t kNextBatchRecords = 500;
+constexpr uint64_t kNextBatchBytes = 1024 * 1024;
+
+} // namespace
 
 // Constructor: Initializes consumer for specified topic
 Consumer::Consumer(Broker& broker, const std::string& topicName):
+    Consumer(broker, topicName, "") {}
+
+// Constructor: Initializes consumer for specified topic that resumes from and commits to groupId's offsets
+Consumer::Consumer(Broker& broker, const std::string& topicName, const std::string& groupId):
     broker_(broker),
-    topicName_(topicName) {}
+    topicName_(topicName),
+    groupId_(groupId),
+    assigned_(false),
+    nextPartitionIndex_(0),
+    metrics_(&Metrics::getInstance().topicMetrics(topicName)) {}
+
+// Destructor: Detaches the prefetch session before an owned fetcher is stopped
+Consumer::~Consumer() {
+    if (fetchSession_) {
+        fetchSession_->close();
+    }
+}
+
+// Core: Polls a batch of records across all assigned partitions, with one broker fetch per
+// partition. Waits up to 'timeout' for new appends when nothing is available.
+ConsumerRecords Consumer::poll(size_t maxRecords, uint64_t maxBytes, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    ConsumerRecords records;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    ensureAssignment();
+
+    while (true) {
+        // Sample the append counter before fetching so an append in between still wakes us
+        uint64_t seenAppends = broker_.getAppendCount(topicName_);
+        fetchAssigned(records, maxRecords, maxBytes);
+
+        auto now = std::chrono::steady_clock::now();
+        if (!records.empty() || now >= deadline) {
+            return records;
+        }
+
+        lock.unlock();
+        broker_.waitForAppend(topicName_, seenAppends,
+                              std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now));
+        lock.lock();
+    }
+}
 
 // Core: Polls for next message from specified partition
 Message Consumer::poll(uint32_t partitionId) {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = offsets_.find(partitionId);
-    uint64_t currentOffset = (it != offsets_.end()) ? it->second : 0;
+    uint64_t currentOffset = positionFor(partitionId);
 
     auto messages = broker_.getMessages(topicName_, partitionId, currentOffset, currentOffset + 1);
 
     if (!messages.empty()) {
         offsets_[partitionId] = currentOffset + 1;
+        recordDelivered(messages);
         return messages[0];
     }
 
@@ -24,13 +77,12 @@ Message Consumer::poll(uint32_t partitionId) {
 // Core: Blocks until a new message becomes available in specified partition
 void Consumer::waitForMessage(uint32_t partitionId) {
     std::unique_lock<std::mutex> lock(mutex_);
-    auto it = offsets_.find(partitionId);
-    uint64_t currentOffset = (it != offsets_.end()) ? it->second : 0;
+    uint64_t currentOffset = positionFor(partitionId);
 
     while (true) {
+        // Probe the log end rather than fetching, so only the poll() that follows is metered
         bool messageAvailable = cv_.wait_for(lock, std::chrono::milliseconds(100), [this, partitionId, currentOffset] {
-            auto messages = broker_.getMessages(topicName_, partitionId, currentOffset, currentOffset + 1);
-            return !messages.empty();
+            return broker_.getLogEndOffset(topicName_, partitionId) > currentOffset;
         });
 
         if (messageAvailable) {
@@ -39,21 +91,290 @@ void Consumer::waitForMessage(uint32_t partitionId) {
     }
 }
 
-// Management: Commits current offset for specified partition
+// Coroutine: Returns the next record from any assigned partition, suspending until one is appended
+Task<Message> Consumer::next() {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!pendingRecords_.empty()) {
+                Message message = std::move(pendingRecords_.front().second);
+                pendingRecords_.pop_front();
+                co_return message;
+            }
+        }
+
+        // Fetch and buffer under one lock, so a commit never sees the advanced positions
+        // without the records that are still to be returned
+        uint64_t seenAppends = broker_.getAppendCount(topicName_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ensureAssignment();
+            ConsumerRecords records;
+            fetchAssigned(records, kNextBatchRecords, kNextBatchBytes);
+            for (const auto& [partitionId, messages] : records) {
+                for (const auto& message : messages) {
+                    pendingRecords_.emplace_back(partitionId, message);
+                }
+            }
+            if (!pendingRecords_.empty()) {
+                continue;
+            }
+        }
+
+        co_await CallbackAwaiter([this, seenAppends](auto callback) {
+            broker_.notifyOnAppend(topicName_, seenAppends, std::move(callback));
+        });
+    }
+}
+
+// Coroutine: Polls a non-empty batch across assigned partitions, suspending while there is no data
+Task<ConsumerRecords> Consumer::pollAsync(size_t maxRecords, uint64_t maxBytes) {
+    while (true) {
+        uint64_t seenAppends = broker_.getAppendCount(topicName_);
+        ConsumerRecords records = poll(maxRecords, maxBytes, std::chrono::milliseconds(0));
+        if (!records.empty()) {
+            co_return records;
+        }
+
+        co_await CallbackAwaiter([this, seenAppends](auto callback) {
+            broker_.notifyOnAppend(topicName_, seenAppends, std::move(callback));
+        });
+    }
+}
+
+// Coroutine: Suspends until a message is available at the current position of specified partition
+Task<void> Consumer::waitForMessageAsync(uint32_t partitionId) {
+    uint64_t offset = position(partitionId);
+    co_await CallbackAwaiter([this, partitionId, offset](auto callback) {
+        broker_.notifyWhenAvailable(topicName_, partitionId, offset, std::move(callback));
+    });
+}
+
+// Management: Restricts the consumer to the given partitions, dropping records next() buffered
+// from partitions it no longer owns
+void Consumer::assign(const std::vector<uint32_t>& partitions) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (uint32_t partitionId : assignment_) {
+        if (std::find(partitions.begin(), partitions.end(), partitionId) == partitions.end()) {
+            dropPendingRecords(partitionId);
+        }
+    }
+    assignment_ = partitions;
+    assigned_ = true;
+    nextPartitionIndex_ = 0;
+    if (fetchSession_) {
+        fetchSession_->assign(partitions);
+    }
+}
+
+// Getter: Returns the assigned partitions (all partitions until assign() is called)
+std::vector<uint32_t> Consumer::assignment() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (assigned_) {
+        return assignment_;
+    }
+
+    std::vector<uint32_t> partitions(broker_.getNumPartitions(topicName_));
+    for (size_t i = 0; i < partitions.size(); ++i) {
+        partitions[i] = static_cast<uint32_t>(i);
+    }
+    return partitions;
+}
+
+// Prefetching: Starts a dedicated fetcher thread that buffers up to maxBufferedBytes ahead
+void Consumer::enablePrefetch(uint64_t maxBufferedBytes) {
+    auto fetcher = std::make_unique<Fetcher>(broker_);
+    fetcher->start();
+    enablePrefetch(*fetcher, maxBufferedBytes);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ownedFetcher_ = std::move(fetcher);
+}
+
+// Prefetching: Buffers up to maxBufferedBytes ahead using a shared fetcher (must outlive the consumer)
+void Consumer::enablePrefetch(Fetcher& fetcher, uint64_t maxBufferedBytes) {
+    auto session = fetcher.openSession(topicName_, maxBufferedBytes);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fetchSession_) {
+        fetchSession_->close();
+    }
+    if (assigned_) {
+        session->assign(assignment_);
+    }
+    fetchSession_ = std::move(session);
+}
+
+// Management: Commits current offset for specified partition (durably, for a group consumer)
 void Consumer::commit(uint32_t partitionId, uint64_t offset) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        offsets_[partitionId] = offset;
+    }
+    if (!groupId_.empty()) {
+        broker_.commitOffset(groupId_, topicName_, partitionId, offset);
+    }
+}
+
+// Management: Commits an offset without waiting; commits are coalesced into batched log appends
+void Consumer::commitAsync(uint32_t partitionId, uint64_t offset) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        offsets_[partitionId] = offset;
+    }
+    if (!groupId_.empty()) {
+        broker_.commitOffsetAsync(groupId_, topicName_, partitionId, offset);
+    }
+}
+
+// Management: Commits the current position of every consumed partition without waiting
+void Consumer::commitAsync() {
+    if (groupId_.empty()) {
+        return;
+    }
+    for (const auto& [partitionId, offset] : currentPositions()) {
+        broker_.commitOffsetAsync(groupId_, topicName_, partitionId, offset);
+    }
+}
+
+// Management: Commits the current position of every consumed partition and waits until durable
+void Consumer::commitSync() {
+    commitAsync();
+    if (!groupId_.empty()) {
+        broker_.flushCommittedOffsets();
+    }
+}
+
+// Management: Moves the position of specified partition, discarding prefetched records and
+// the ones next() buffered
+void Consumer::seek(uint32_t partitionId, uint64_t offset) {
     std::lock_guard<std::mutex> lock(mutex_);
+    dropPendingRecords(partitionId);
     offsets_[partitionId] = offset;
+    if (fetchSession_) {
+        fetchSession_->seek(partitionId, offset);
+    }
 }
 
 // Getter: Returns current offset position for specified partition
 uint64_t Consumer::position(uint32_t partitionId) const {
     std::lock_guard<std::mutex> lock(mutex_);
     auto it = offsets_.find(partitionId);
-    return (it != offsets_.end()) ? it->second : 0;
+    if (it != offsets_.end()) {
+        return it->second;
+    }
+    return groupId_.empty() ? 0 : broker_.getCommittedOffset(groupId_, topicName_, partitionId).value_or(0);
+}
+
+// Getter: Returns the group whose committed offsets this consumer uses (empty if none)
+const std::string& Consumer::getGroupId() const {
+    return groupId_;
 }
 
 // Management: Resets offset to beginning (0) for specified partition
 void Consumer::reset(uint32_t partitionId) {
-    std::lock_guard<std::mutex> lock(mutex_);   
-    offsets_[partitionId] = 0;
+    seek(partitionId, 0);
+}
+
+// Internal: Resolves the default assignment (every partition of the topic); caller holds mutex_
+void Consumer::ensureAssignment() {
+    if (assigned_) {
+        return;
+    }
+
+    size_t numPartitions = broker_.getNumPartitions(topicName_);
+    assignment_.clear();
+    for (size_t i = 0; i < numPartitions; ++i) {
+        assignment_.push_back(static_cast<uint32_t>(i));
+    }
+    assigned_ = true;
+}
+
+// Internal: Fills the batch with one fetch per assigned partition until a limit is reached; caller holds mutex_
+void Consumer::fetchAssigned(ConsumerRecords& records, size_t maxRecords, uint64_t maxBytes) {
+    if (assignment_.empty()) {
+        return;
+    }
+
+    size_t numAssigned = assignment_.size();
+    size_t startIndex = nextPartitionIndex_ % numAssigned;
+    nextPartitionIndex_ = startIndex + 1;
+
+    for (size_t i = 0; i < numAssigned; ++i) {
+        if (records.count() >= maxRecords || records.sizeBytes() >= maxBytes) {
+            break;
+        }
+
+        uint32_t partitionId = assignment_[(startIndex + i) % numAssigned];
+        uint64_t& currentOffset = positionFor(partitionId);
+        size_t recordBudget = maxRecords - records.count();
+        uint64_t byteBudget = maxBytes - records.sizeBytes();
+
+        // Serve from the prefetch buffer first, fall back to a direct fetch when it is empty
+        std::vector<Message> messages;
+        if (fetchSession_) {
+            fetchSession_->take(partitionId, currentOffset, recordBudget, byteBudget, messages);
+        }
+        if (messages.empty()) {
+            messages = broker_.fetch(topicName_, partitionId, currentOffset, recordBudget, byteBudget);
+            if (fetchSession_ && !messages.empty()) {
+                fetchSession_->advance(partitionId, messages.back().getOffset() + 1);
+            }
+        }
+        if (!messages.empty()) {
+            currentOffset = messages.back().getOffset() + 1;
+            recordDelivered(messages);
+            records.add(partitionId, std::move(messages));
+        }
+    }
+}
+
+// Internal: Returns the position of a partition, starting from the group's committed offset; caller holds mutex_
+uint64_t& Consumer::positionFor(uint32_t partitionId) {
+    auto it = offsets_.find(partitionId);
+    if (it != offsets_.end()) {
+        return it->second;
+    }
+
+    uint64_t start = 0;
+    if (!groupId_.empty()) {
+        start = broker_.getCommittedOffset(groupId_, topicName_, partitionId).value_or(0);
+    }
+    return offsets_.emplace(partitionId, start).first->second;
+}
+
+// Internal: Records the produce-to-consume latency of delivered messages
+void Consumer::recordDelivered(const std::vector<Message>& messages) {
+    auto now = std::chrono::system_clock::now();
+    for (const auto& message : messages) {
+        Metrics::getInstance().recordEndToEnd(*metrics_, now - message.getTimestamp());
+        Tracer::getInstance().recordInstant(message.getTraceId(), "consumer.deliver");
+    }
+}
+
+// Internal: Discards the records next() buffered from one partition and moves its position
+// back to the first of them, as they were never returned; caller holds mutex_
+void Consumer::dropPendingRecords(uint32_t partitionId) {
+    auto first = std::find_if(pendingRecords_.begin(), pendingRecords_.end(),
+                              [partitionId](const auto& record) { return record.first == partitionId; });
+    if (first == pendingRecords_.end()) {
+        return;
+    }
+    offsets_[partitionId] = first->second.getOffset();
+    std::erase_if(pendingRecords_, [partitionId](const auto& record) { return record.first == partitionId; });
+}
+
+// Internal: Snapshots the positions of every partition consumed so far. Records next() has
+// buffered but not returned are not consumed yet: a partition's position is its first one.
+std::vector<std::pair<uint32_t, uint64_t>> Consumer::currentPositions() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_map<uint32_t, uint64_t> positions = offsets_;
+    std::unordered_map<uint32_t, bool> seen;
+    for (const auto& [partitionId, message] : pendingRecords_) {
+        if (!seen[partitionId]) {
+            seen[partitionId] = true;
+            positions[partitionId] = message.getOffset();
+        }
+    }
+    return std::vector<std::pair<uint32_t, uint64_t>>(positions.begin(), positions.end());
 }
\ No newline at end of file
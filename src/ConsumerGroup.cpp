@@ -1,35 +1,33 @@
 #include "ConsumerGroup.h"
+#include "Metrics.h"
+
+#include <queue>
+#include <stdexcept>
 
 ConsumerGroup::ConsumerGroup(const std::string& groupId, Broker& broker, const std::string& topicName):
+        ConsumerGroup(groupId, broker, topicName, broker.getGroupMetadataStore()) {}
+
+ConsumerGroup::ConsumerGroup(const std::string& groupId, Broker& broker, const std::string& topicName,
+                             std::shared_ptr<GroupMetadataStore> store):
         groupId_(groupId),
         broker_(broker),
         topicName_(topicName),
-        running_(true),
-        connection_(nullptr),
-        connectionString_("dbname=selfkafka user=" + std::string(getenv("USER") ? getenv("USER") : "postgres")) {
-    
-    
-    connection_ = PQconnectdb(connectionString_.c_str());
-    if (PQstatus(connection_) != CONNECTION_OK) {
-        std::cerr << "Connection to database failed: " << PQerrorMessage(connection_) << std::endl;
-        PQfinish(connection_);
-        connection_ = nullptr;
-    } else {
-        std::cout << "Connected to PostgreSQL database" << std::endl;
-    }
+        running_(false),
+        metadataWriter_(std::make_unique<GroupMetadataWriter>(std::move(store), groupId, topicName)) {
     
-    loadFromDatabase();
+    loadMetadata();
+    metadataWriter_->start();
 }
 
 ConsumerGroup::~ConsumerGroup() {
     stop();
-    if (connection_) {
-        PQfinish(connection_);
-    }
+    metadataWriter_->stop();
+    metadataWriter_->join();
 }
 
-void ConsumerGroup::addConsumer(std::shared_ptr<Consumer> consumer) {
-    std::lock_guard<std::mutex> lock(consumersMutex_);
+// Membership: Adds a dynamic member under a generated id and rebalances; returns the id
+std::string ConsumerGroup::addConsumer(std::shared_ptr<Consumer> consumer) {
+    std::lock_guard lock(consumersMutex_);
     
     auto now = std::chrono::system_clock::now();
     auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
@@ -39,89 +37,217 @@ void ConsumerGroup::addConsumer(std::shared_ptr<Consumer> consumer) {
     consumersMap_[consumerId] = consumer;
     
     lastHeartbeats_[consumerId] = now;
+    if (running_.load()) {
+        scheduleSessionLocked(consumerId);
+    }
     
-    rebalance();
-    saveToDatabase();
+    rebalanceLocked();
+    saveMetadata();
+    return consumerId;
 }
 
+// Membership: Adds a static member whose id is its groupInstanceId. If the id is already
+// known (a live member being replaced, or one within its grace period after leaving), the
+// new consumer takes over the held partitions without a rebalance.
+std::string ConsumerGroup::addConsumer(std::shared_ptr<Consumer> consumer, const std::string& groupInstanceId) {
+    if (groupInstanceId.empty()) {
+        throw std::invalid_argument("Group instance id must not be empty");
+    }
+    
+    std::lock_guard lock(consumersMutex_);
+    bool rejoining = staticMembers_.contains(groupInstanceId);
+    
+    auto departedIt = departedMembers_.find(groupInstanceId);
+    if (departedIt != departedMembers_.end()) {
+        broker_.getSessionTimers().cancel(departedIt->second.graceTimer);
+        departedMembers_.erase(departedIt);
+    }
+    
+    // A previous incarnation still registered under this id is fenced off
+    auto currentIt = consumersMap_.find(groupInstanceId);
+    if (currentIt != consumersMap_.end()) {
+        auto it = std::find(consumers_.begin(), consumers_.end(), currentIt->second);
+        if (it != consumers_.end()) {
+            consumers_.erase(it);
+        }
+    }
+    
+    staticMembers_.insert(groupInstanceId);
+    consumers_.push_back(consumer);
+    consumersMap_[groupInstanceId] = consumer;
+    lastHeartbeats_[groupInstanceId] = std::chrono::system_clock::now();
+    
+    if (running_.load()) {
+        auto timerIt = sessionTimers_.find(groupInstanceId);
+        if (timerIt != sessionTimers_.end()) {
+            broker_.getSessionTimers().cancel(timerIt->second);
+        }
+        scheduleSessionLocked(groupInstanceId);
+    }
+    
+    if (rejoining) {
+        assignLocked(groupInstanceId);
+        if (rebalanceListener_.onPartitionsAssigned) {
+            rebalanceListener_.onPartitionsAssigned(groupInstanceId, memberAssignments_[groupInstanceId]);
+        }
+        staticRejoins_++;
+    } else {
+        rebalanceLocked();
+    }
+    saveMetadata();
+    return groupInstanceId;
+}
+
+// Membership: Removes a member. Static members only depart: their partitions are held for
+// the grace period in case they rejoin.
 void ConsumerGroup::removeConsumer(std::shared_ptr<Consumer> consumer) {
-    std::lock_guard<std::mutex> lock(consumersMutex_);
+    std::lock_guard lock(consumersMutex_);
     
-    auto it = std::find(consumers_.begin(), consumers_.end(), consumer);
-    if (it != consumers_.end()) {
-        consumers_.erase(it);
+    for (const auto& [consumerId, member] : consumersMap_) {
+        if (member == consumer) {
+            std::string memberId = consumerId; // Copy: the map entry is erased
+            if (staticMembers_.contains(memberId)) {
+                departStaticMemberLocked(memberId);
+            } else {
+                removeConsumerLocked(memberId);
+            }
+            return;
+        }
+    }
+}
+
+// Membership: Removes a static member for good (e.g. scale-down) and rebalances
+void ConsumerGroup::removeStaticMember(const std::string& groupInstanceId) {
+    std::lock_guard lock(consumersMutex_);
+    removeConsumerLocked(groupInstanceId);
+}
+
+// Membership: Removes a member, releases its partitions and rebalances; caller holds consumersMutex_
+void ConsumerGroup::removeConsumerLocked(const std::string& consumerId) {
+    auto departedIt = departedMembers_.find(consumerId);
+    if (departedIt != departedMembers_.end()) {
+        broker_.getSessionTimers().cancel(departedIt->second.graceTimer);
+        departedMembers_.erase(departedIt);
     }
     
-    for (auto mapIt = consumersMap_.begin(); mapIt != consumersMap_.end(); ++mapIt) {
-        if (mapIt->second == consumer) {
-            std::string consumerId = mapIt->first;
-            consumersMap_.erase(mapIt);
-            lastHeartbeats_.erase(consumerId);
-            break;
+    auto mapIt = consumersMap_.find(consumerId);
+    if (mapIt != consumersMap_.end()) {
+        auto it = std::find(consumers_.begin(), consumers_.end(), mapIt->second);
+        if (it != consumers_.end()) {
+            consumers_.erase(it);
         }
+        consumersMap_.erase(mapIt);
+    } else if (!staticMembers_.contains(consumerId)) {
+        return;
     }
+    staticMembers_.erase(consumerId);
+    lastHeartbeats_.erase(consumerId);
     
-    for (auto assignIt = partitionAssignments_.begin(); assignIt != partitionAssignments_.end();) {
-        if (assignIt->second == consumer) {
-            assignIt = partitionAssignments_.erase(assignIt);
-        } else {
-            ++assignIt;
+    auto timerIt = sessionTimers_.find(consumerId);
+    if (timerIt != sessionTimers_.end()) {
+        broker_.getSessionTimers().cancel(timerIt->second);
+        sessionTimers_.erase(timerIt);
+    }
+    
+    // Partitions of a departed member are released without a revocation callback
+    auto assignedIt = memberAssignments_.find(consumerId);
+    if (assignedIt != memberAssignments_.end()) {
+        for (uint32_t partitionId : assignedIt->second) {
+            partitionAssignments_.erase(partitionId);
+        }
+        memberAssignments_.erase(assignedIt);
+    }
+    
+    rebalanceLocked();
+    saveMetadata();
+}
+
+// Membership: Detaches a static member's consumer but keeps its partitions until the grace
+// period ends; caller holds consumersMutex_
+void ConsumerGroup::departStaticMemberLocked(const std::string& consumerId) {
+    auto mapIt = consumersMap_.find(consumerId);
+    if (mapIt != consumersMap_.end()) {
+        auto it = std::find(consumers_.begin(), consumers_.end(), mapIt->second);
+        if (it != consumers_.end()) {
+            consumers_.erase(it);
         }
+        consumersMap_.erase(mapIt);
+    }
+    lastHeartbeats_.erase(consumerId);
+    
+    auto timerIt = sessionTimers_.find(consumerId);
+    if (timerIt != sessionTimers_.end()) {
+        broker_.getSessionTimers().cancel(timerIt->second);
+        sessionTimers_.erase(timerIt);
     }
     
-    rebalance();
-    saveToDatabase();
+    DepartedMember& departed = departedMembers_[consumerId];
+    departed.departedAt = std::chrono::system_clock::now();
+    departed.graceTimer = 0;
+    if (running_.load()) {
+        scheduleGraceLocked(consumerId);
+    }
+    saveMetadata();
 }
 
+// Membership: Records a heartbeat and pushes the member's session deadline out (O(1))
 void ConsumerGroup::sendHeartbeat(const std::string& consumerId) {
-    std::lock_guard<std::mutex> lock(consumersMutex_);
+    std::lock_guard lock(consumersMutex_);
     lastHeartbeats_[consumerId] = std::chrono::system_clock::now();
+    
+    auto timerIt = sessionTimers_.find(consumerId);
+    if (timerIt != sessionTimers_.end()) {
+        broker_.getSessionTimers().extend(timerIt->second, TimerWheel::Clock::now() + heartbeatTimeout_);
+    }
 }
 
-// Lifecycle: Starts the heartbeat monitoring thread
+// Lifecycle: Starts session tracking for every current member
 void ConsumerGroup::start() {
+    std::lock_guard lock(consumersMutex_);
     if (running_.load()) {
         return;  
     }
     
     running_.store(true);
-    heartbeatMonitorThread_ = std::thread(&ConsumerGroup::heartbeatMonitor, this);
+    for (const auto& [consumerId, consumer] : consumersMap_) {
+        scheduleSessionLocked(consumerId);
+    }
+    for (const auto& [consumerId, departed] : departedMembers_) {
+        scheduleGraceLocked(consumerId);
+    }
 }
 
-// Lifecycle: Stops the heartbeat monitoring thread
+// Lifecycle: Stops session tracking; returns once no expiry callback is running
 void ConsumerGroup::stop() {
-    if (!running_.load()) {
-        return;  
+    std::unordered_map<std::string, TimerWheel::TimerId> sessionTimers;
+    {
+        std::lock_guard lock(consumersMutex_);
+        if (!running_.load()) {
+            return;  
+        }
+        
+        running_.store(false);
+        sessionTimers.swap(sessionTimers_);
+        for (auto& [consumerId, departed] : departedMembers_) {
+            sessionTimers.emplace("grace:" + consumerId, departed.graceTimer);
+            departed.graceTimer = 0;
+        }
     }
     
-    running_.store(false);
-    if (heartbeatMonitorThread_.joinable()) {
-        heartbeatMonitorThread_.join();
+    // Expiry callbacks take consumersMutex_, so wait for them without holding it
+    for (const auto& [consumerId, timerId] : sessionTimers) {
+        broker_.getSessionTimers().cancelSync(timerId);
     }
 }
 
 std::vector<uint32_t> ConsumerGroup::getAssignedPartitions(const std::string& consumerId) const {
-    std::lock_guard<std::mutex> lock(consumersMutex_);
-    std::vector<uint32_t> assignedPartitions;
-    
-    auto consumerIt = consumersMap_.find(consumerId);
-    if (consumerIt == consumersMap_.end()) {
-        return assignedPartitions; 
-    }
-    
-    auto consumer = consumerIt->second;
-    
-    for (const auto& [partitionId, assignedConsumer] : partitionAssignments_) {
-        if (assignedConsumer == consumer) {
-            assignedPartitions.push_back(partitionId);
-        }
-    }
-    
-    return assignedPartitions;
+    std::lock_guard lock(consumersMutex_);
+    auto it = memberAssignments_.find(consumerId);
+    return (it != memberAssignments_.end()) ? it->second : std::vector<uint32_t>();
 }
 
 size_t ConsumerGroup::getConsumerCount() const {
-    std::lock_guard<std::mutex> lock(consumersMutex_);
+    std::lock_guard lock(consumersMutex_);
     return consumers_.size();
 }
 
@@ -130,7 +256,7 @@ std::string ConsumerGroup::getGroupId() const {
 }
 
 std::vector<std::string> ConsumerGroup::getActiveConsumers() const {
-    std::lock_guard<std::mutex> lock(consumersMutex_);
+    std::lock_guard lock(consumersMutex_);
     std::vector<std::string> activeConsumers;
     
     for (const auto& [consumerId, lastHeartbeat] : lastHeartbeats_) {
@@ -145,7 +271,7 @@ std::vector<std::string> ConsumerGroup::getActiveConsumers() const {
 }
 
 bool ConsumerGroup::isConsumerActive(const std::string& consumerId) const {
-    std::lock_guard<std::mutex> lock(consumersMutex_);
+    std::lock_guard lock(consumersMutex_);
     auto it = lastHeartbeats_.find(consumerId);
     if (it == lastHeartbeats_.end()) {
         return false;  
@@ -156,200 +282,269 @@ bool ConsumerGroup::isConsumerActive(const std::string& consumerId) const {
     return timeSinceLastHeartbeat < heartbeatTimeout_;
 }
 
+// Rebalancing: Recomputes assignments for the current members
 void ConsumerGroup::rebalance() {
-    partitionAssignments_.clear();
-    
-    if (consumers_.empty()) {
-        return;  
-    }
-    
-    // Get number of partitions for this topic
-    // Note: We need to add a method to Broker to get partition count
-    // For now, let's assume we know the partition count
-    size_t numPartitions = 3;  // TODO: Get from broker
-    
-    // Round-robin assignment: distribute partitions evenly among consumers
-    for (size_t partitionId = 0; partitionId < numPartitions; ++partitionId) {
-        size_t consumerIndex = partitionId % consumers_.size();
-        partitionAssignments_[static_cast<uint32_t>(partitionId)] = consumers_[consumerIndex];
-    }
+    std::lock_guard lock(consumersMutex_);
+    rebalanceLocked();
 }
 
-// Background: Monitors consumer heartbeats and removes inactive consumers
-void ConsumerGroup::heartbeatMonitor() {
-    while (running_.load()) {
-        std::this_thread::sleep_for(std::chrono::seconds(30));
-        
-        if (!running_.load()) break;
-        
-        std::lock_guard<std::mutex> lock(consumersMutex_);
-        auto now = std::chrono::system_clock::now();
-        
-        std::vector<std::shared_ptr<Consumer>> deadConsumers;
-        
-        for (auto it = lastHeartbeats_.begin(); it != lastHeartbeats_.end();) {
-            auto timeSinceLastHeartbeat = now - it->second;
-            if (timeSinceLastHeartbeat >= heartbeatTimeout_) {
-                auto consumerIt = consumersMap_.find(it->first);
-                if (consumerIt != consumersMap_.end()) {
-                    deadConsumers.push_back(consumerIt->second);
-                }
-                it = lastHeartbeats_.erase(it);
-            } else {
-                ++it;
-            }
-        }
-        
-        for (auto& deadConsumer : deadConsumers) {
-            removeConsumer(deadConsumer);
-        }
-    }
+// Rebalancing: Installs callbacks for incremental revocations and assignments
+void ConsumerGroup::setRebalanceListener(RebalanceListener listener) {
+    std::lock_guard lock(consumersMutex_);
+    rebalanceListener_ = std::move(listener);
 }
 
-// Persistence: Saves consumer group state to database
-void ConsumerGroup::saveToDatabase() {
-    if (!connection_) {
-        std::cerr << "No database connection available" << std::endl;
-        return;
+// Statistics: Returns the number of rebalances that moved at least one partition
+uint64_t ConsumerGroup::getRebalanceCount() const {
+    std::lock_guard lock(consumersMutex_);
+    return rebalanceCount_;
+}
+
+// Statistics: Returns the total number of partition ownership changes
+uint64_t ConsumerGroup::getPartitionMovements() const {
+    std::lock_guard lock(consumersMutex_);
+    return partitionMovements_;
+}
+
+// Rebalancing: Sticky, cooperative assignment; caller holds consumersMutex_.
+// Every member's quota is floor(P/C) or ceil(P/C); members keep the partitions they own
+// up to their quota, only the overflow is revoked, and unowned partitions go to the least
+// loaded members through a min-heap, so a rebalance costs O(P log C).
+void ConsumerGroup::rebalanceLocked() {
+    size_t numPartitions = broker_.getNumPartitions(topicName_);
+    
+    // Forget partitions that no longer exist or whose owner left
+    for (auto it = partitionAssignments_.begin(); it != partitionAssignments_.end();) {
+        if (it->first >= numPartitions || !isMemberLocked(it->second)) {
+            it = partitionAssignments_.erase(it);
+        } else {
+            ++it;
+        }
     }
-    
-    
-    PGresult* result = PQexec(connection_, "BEGIN");
-    if (PQresultStatus(result) != PGRES_COMMAND_OK) {
-        std::cerr << "BEGIN command failed: " << PQerrorMessage(connection_) << std::endl;
-        PQclear(result);
-        return;
+    for (auto it = memberAssignments_.begin(); it != memberAssignments_.end();) {
+        if (!isMemberLocked(it->first)) {
+            it = memberAssignments_.erase(it);
+        } else {
+            auto& owned = it->second;
+            owned.erase(std::remove_if(owned.begin(), owned.end(),
+                                       [numPartitions](uint32_t partitionId) { return partitionId >= numPartitions; }),
+                        owned.end());
+            ++it;
+        }
     }
-    PQclear(result);
     
-    std::string insertGroup = "INSERT INTO consumer_groups (group_id, topic_name) VALUES ($1, $2) "
-                             "ON CONFLICT (group_id) DO UPDATE SET topic_name = $2, updated_at = CURRENT_TIMESTAMP";
-    const char* values[2] = {groupId_.c_str(), topicName_.c_str()};
-    result = PQexecParams(connection_, insertGroup.c_str(), 2, nullptr, values, nullptr, nullptr, 0);
-    if (PQresultStatus(result) != PGRES_COMMAND_OK) {
-        std::cerr << "Insert consumer group failed: " << PQerrorMessage(connection_) << std::endl;
-        PQclear(result);
-        PQexec(connection_, "ROLLBACK");
+    if (consumersMap_.empty() && departedMembers_.empty()) {
         return;
     }
-    PQclear(result);
     
-    std::string deleteConsumers = "DELETE FROM consumers WHERE group_id = $1";
-    const char* deleteValues[1] = {groupId_.c_str()};
-    result = PQexecParams(connection_, deleteConsumers.c_str(), 1, nullptr, deleteValues, nullptr, nullptr, 0);
-    if (PQresultStatus(result) != PGRES_COMMAND_OK) {
-        std::cerr << "Delete consumers failed: " << PQerrorMessage(connection_) << std::endl;
-        PQclear(result);
-        PQexec(connection_, "ROLLBACK");
-        return;
+    // Quotas: the members already owning the most partitions get the ceil(P/C) slots.
+    // Departed static members count as members, so their partitions stay held.
+    std::vector<std::string> members;
+    members.reserve(consumersMap_.size() + departedMembers_.size());
+    for (const auto& [consumerId, consumer] : consumersMap_) {
+        members.push_back(consumerId);
+    }
+    for (const auto& [consumerId, departed] : departedMembers_) {
+        members.push_back(consumerId);
+    }
+    std::sort(members.begin(), members.end(), [this](const std::string& a, const std::string& b) {
+        size_t countA = memberAssignments_.contains(a) ? memberAssignments_.at(a).size() : 0;
+        size_t countB = memberAssignments_.contains(b) ? memberAssignments_.at(b).size() : 0;
+        return countA != countB ? countA > countB : a < b;
+    });
+    
+    size_t base = numPartitions / members.size();
+    size_t extra = numPartitions % members.size();
+    std::unordered_map<std::string, size_t> quotas;
+    for (size_t i = 0; i < members.size(); ++i) {
+        quotas[members[i]] = base + (i < extra ? 1 : 0);
     }
-    PQclear(result);
     
-    for (const auto& [consumerId, consumer] : consumersMap_) {
-        auto lastHeartbeat = lastHeartbeats_.find(consumerId);
-        if (lastHeartbeat != lastHeartbeats_.end()) {
-            std::string insertConsumer = "INSERT INTO consumers (consumer_id, group_id, last_heartbeat) VALUES ($1, $2, to_timestamp($3))";
-            auto heartbeatTime = std::chrono::system_clock::to_time_t(lastHeartbeat->second);
-            std::string heartbeatStr = std::to_string(heartbeatTime);
-            const char* consumerValues[3] = {consumerId.c_str(), groupId_.c_str(), heartbeatStr.c_str()};
-            
-            result = PQexecParams(connection_, insertConsumer.c_str(), 3, nullptr, consumerValues, nullptr, nullptr, 0);
-            if (PQresultStatus(result) != PGRES_COMMAND_OK) {
-                std::cerr << "Insert consumer failed: " << PQerrorMessage(connection_) << std::endl;
-                PQclear(result);
-                PQexec(connection_, "ROLLBACK");
-                return;
-            }
-            PQclear(result);
-            
-            for (const auto& [partitionId, assignedConsumer] : partitionAssignments_) {
-                if (assignedConsumer == consumer) {
-                    std::string insertAssignment = "INSERT INTO partition_assignments (group_id, consumer_id, partition_id) VALUES ($1, $2, $3)";
-                    std::string partitionStr = std::to_string(partitionId);
-                    const char* assignmentValues[3] = {groupId_.c_str(), consumerId.c_str(), partitionStr.c_str()};
-                    
-                    result = PQexecParams(connection_, insertAssignment.c_str(), 3, nullptr, assignmentValues, nullptr, nullptr, 0);
-                    if (PQresultStatus(result) != PGRES_COMMAND_OK) {
-                        std::cerr << "Insert assignment failed: " << PQerrorMessage(connection_) << std::endl;
-                        PQclear(result);
-                        PQexec(connection_, "ROLLBACK");
-                        return;
-                    }
-                    PQclear(result);
-                }
+    // Revoke only the overflow above each member's quota
+    std::unordered_map<std::string, std::vector<uint32_t>> revoked;
+    for (const auto& consumerId : members) {
+        auto& owned = memberAssignments_[consumerId];
+        size_t quota = quotas[consumerId];
+        if (owned.size() > quota) {
+            std::sort(owned.begin(), owned.end());
+            for (size_t i = quota; i < owned.size(); ++i) {
+                partitionAssignments_.erase(owned[i]);
+                revoked[consumerId].push_back(owned[i]);
             }
+            owned.resize(quota);
         }
     }
     
-    result = PQexec(connection_, "COMMIT");
-    if (PQresultStatus(result) != PGRES_COMMAND_OK) {
-        std::cerr << "COMMIT command failed: " << PQerrorMessage(connection_) << std::endl;
-        PQclear(result);
-        return;
+    // Hand unowned partitions to the least loaded members
+    using Load = std::pair<size_t, std::string>;
+    std::priority_queue<Load, std::vector<Load>, std::greater<Load>> underloaded;
+    for (const auto& consumerId : members) {
+        size_t owned = memberAssignments_[consumerId].size();
+        if (owned < quotas[consumerId]) {
+            underloaded.emplace(owned, consumerId);
+        }
     }
-    PQclear(result);
     
-    std::cout << "Saved ConsumerGroup " << groupId_ << " to PostgreSQL" << std::endl;
-}
-
-// Persistence: Loads consumer group state from database
-void ConsumerGroup::loadFromDatabase() {
-    if (!connection_) {
-        std::cout << "No database connection available for loading" << std::endl;
-        return;
+    std::unordered_map<std::string, std::vector<uint32_t>> assigned;
+    for (uint32_t partitionId = 0; partitionId < numPartitions && !underloaded.empty(); ++partitionId) {
+        if (partitionAssignments_.contains(partitionId)) {
+            continue;
+        }
+        
+        auto [owned, consumerId] = underloaded.top();
+        underloaded.pop();
+        
+        partitionAssignments_[partitionId] = consumerId;
+        memberAssignments_[consumerId].push_back(partitionId);
+        assigned[consumerId].push_back(partitionId);
+        
+        if (owned + 1 < quotas[consumerId]) {
+            underloaded.emplace(owned + 1, consumerId);
+        }
     }
     
-    std::string checkGroup = "SELECT group_id FROM consumer_groups WHERE group_id = $1";
-    const char* checkValues[1] = {groupId_.c_str()};
-    PGresult* result = PQexecParams(connection_, checkGroup.c_str(), 1, nullptr, checkValues, nullptr, nullptr, 0);
-    
-    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
-        std::cerr << "Check group failed: " << PQerrorMessage(connection_) << std::endl;
-        PQclear(result);
+    if (revoked.empty() && assigned.empty()) {
         return;
     }
     
-    if (PQntuples(result) == 0) {
-        PQclear(result);
-        std::string insertGroup = "INSERT INTO consumer_groups (group_id, topic_name) VALUES ($1, $2)";
-        const char* insertValues[2] = {groupId_.c_str(), topicName_.c_str()};
-        result = PQexecParams(connection_, insertGroup.c_str(), 2, nullptr, insertValues, nullptr, nullptr, 0);
-        if (PQresultStatus(result) != PGRES_COMMAND_OK) {
-            std::cerr << "Insert group failed: " << PQerrorMessage(connection_) << std::endl;
+    // Cooperative hand-off: all revocations first, then the new assignments
+    for (const auto& [consumerId, partitions] : revoked) {
+        assignLocked(consumerId);
+        if (rebalanceListener_.onPartitionsRevoked) {
+            rebalanceListener_.onPartitionsRevoked(consumerId, partitions);
         }
-        PQclear(result);
-        std::cout << "Created new ConsumerGroup " << groupId_ << " in PostgreSQL" << std::endl;
-        return;
     }
-    PQclear(result);
-    
-    std::string loadConsumers = "SELECT c.consumer_id, c.last_heartbeat, pa.partition_id "
-                               "FROM consumers c "
-                               "LEFT JOIN partition_assignments pa ON c.consumer_id = pa.consumer_id "
-                               "WHERE c.group_id = $1";
-    const char* loadValues[1] = {groupId_.c_str()};
-    result = PQexecParams(connection_, loadConsumers.c_str(), 1, nullptr, loadValues, nullptr, nullptr, 0);
+    for (const auto& [consumerId, partitions] : assigned) {
+        assignLocked(consumerId);
+        if (rebalanceListener_.onPartitionsAssigned) {
+            rebalanceListener_.onPartitionsAssigned(consumerId, partitions);
+        }
+        partitionMovements_ += partitions.size();
+    }
+    rebalanceCount_++;
+}
+
+// Configuration: Sets how long a member may go without a heartbeat
+void ConsumerGroup::setSessionTimeout(std::chrono::seconds timeout) {
+    std::lock_guard lock(consumersMutex_);
+    heartbeatTimeout_ = timeout;
+}
+
+// Configuration: Sets how long a departed static member's partitions are held
+void ConsumerGroup::setStaticMemberGracePeriod(std::chrono::seconds gracePeriod) {
+    std::lock_guard lock(consumersMutex_);
+    staticGracePeriod_ = gracePeriod;
+}
+
+// Statistics: Returns how many static members rejoined without a rebalance
+uint64_t ConsumerGroup::getStaticRejoinCount() const {
+    std::lock_guard lock(consumersMutex_);
+    return staticRejoins_;
+}
+
+// Membership: True for live members and for departed static members still in their grace
+// period; caller holds consumersMutex_
+bool ConsumerGroup::isMemberLocked(const std::string& consumerId) const {
+    return consumersMap_.contains(consumerId) || departedMembers_.contains(consumerId);
+}
+
+// Membership: Narrows a live member's consumer to its partitions; caller holds consumersMutex_
+void ConsumerGroup::assignLocked(const std::string& consumerId) {
+    auto it = consumersMap_.find(consumerId);
+    if (it != consumersMap_.end()) {
+        it->second->assign(memberAssignments_[consumerId]);
+    }
+}
+
+// Sessions: Arms the member's session timer; caller holds consumersMutex_. The callback
+// learns its own id (written before the callback can take the lock) so it can tell
+// whether it is still the member's current timer.
+void ConsumerGroup::scheduleSessionLocked(const std::string& consumerId) {
+    auto deadline = TimerWheel::Clock::now() + heartbeatTimeout_;
+    auto timerId = std::make_shared<TimerWheel::TimerId>(0);
+    *timerId = broker_.getSessionTimers().schedule(deadline, [this, consumerId, timerId]() {
+        expireSession(consumerId, *timerId);
+    });
+    sessionTimers_[consumerId] = *timerId;
+}
+
+// Sessions: Arms the grace timer of a departed static member; caller holds consumersMutex_
+void ConsumerGroup::scheduleGraceLocked(const std::string& consumerId) {
+    auto deadline = TimerWheel::Clock::now() + staticGracePeriod_;
+    auto timerId = std::make_shared<TimerWheel::TimerId>(0);
+    *timerId = broker_.getSessionTimers().schedule(deadline, [this, consumerId, timerId]() {
+        expireDepartedMember(consumerId, *timerId);
+    });
+    departedMembers_[consumerId].graceTimer = *timerId;
+}
+
+// Sessions: Releases the partitions of a static member that did not rejoin in time
+void ConsumerGroup::expireDepartedMember(const std::string& consumerId, TimerWheel::TimerId timerId) {
+    std::lock_guard lock(consumersMutex_);
+    auto departedIt = departedMembers_.find(consumerId);
+    if (!running_.load() || departedIt == departedMembers_.end() || departedIt->second.graceTimer != timerId) {
+        return; // Stopped, or the member rejoined (and maybe left again) while the timer was firing
+    }
     
-    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
-        std::cerr << "Load consumers failed: " << PQerrorMessage(connection_) << std::endl;
-        PQclear(result);
-        return;
+    SK_LOGF(LogLevel::WARN, "Static member {} did not rejoin group {}", consumerId, groupId_);
+    removeConsumerLocked(consumerId);
+}
+
+// Sessions: Removes a member whose session deadline passed without a heartbeat
+void ConsumerGroup::expireSession(const std::string& consumerId, TimerWheel::TimerId timerId) {
+    std::lock_guard lock(consumersMutex_);
+    auto timerIt = sessionTimers_.find(consumerId);
+    if (!running_.load() || timerIt == sessionTimers_.end() || timerIt->second != timerId) {
+        return; // Stopped, or the member left or rejoined while the timer was firing
     }
     
-    int numRows = PQntuples(result);
-    std::cout << "Loaded " << numRows << " consumer records from PostgreSQL" << std::endl;
+    sessionTimers_.erase(timerIt);
+    SK_LOGF(LogLevel::WARN, "Consumer {} session expired in group {}", consumerId, groupId_);
+    removeConsumerLocked(consumerId);
+}
+
+// Persistence: Snapshots members and assignments for the background writer (no I/O under the lock)
+void ConsumerGroup::saveMetadata() {
+    GroupState state;
+    state.groupId = groupId_;
+    state.topicName = topicName_;
     
-    for (int i = 0; i < numRows; ++i) {
-        std::string consumerId = PQgetvalue(result, i, 0);
-        std::string heartbeatStr = PQgetvalue(result, i, 1);
-        
-        if (!heartbeatStr.empty()) {
-            time_t heartbeatTime = std::stol(heartbeatStr);
-            auto heartbeat = std::chrono::system_clock::from_time_t(heartbeatTime);
-            lastHeartbeats_[consumerId] = heartbeat;
+    for (const auto& [consumerId, consumer] : consumersMap_) {
+        auto lastHeartbeat = lastHeartbeats_.find(consumerId);
+        if (lastHeartbeat != lastHeartbeats_.end()) {
+            state.members.emplace(consumerId, lastHeartbeat->second);
+        }
+    }
+    for (const auto& [consumerId, departed] : departedMembers_) {
+        state.members.emplace(consumerId, departed.departedAt);
+    }
+    for (const auto& [partitionId, consumerId] : partitionAssignments_) {
+        if (state.members.contains(consumerId)) {
+            state.assignments.emplace(partitionId, consumerId);
         }
     }
     
-    PQclear(result);
-    std::cout << "Loaded ConsumerGroup " << groupId_ << " from PostgreSQL" << std::endl;
-}
\ No newline at end of file
+    metadataWriter_->submit(std::move(state));
+}
+
+// Persistence: Loads consumer group state from the metadata store. The store does not
+// record which members were static, and none of them is connected yet, so each is restored
+// as a departed static member: it keeps its partitions for the grace period (armed by
+// start()), a consumer rejoining under its id takes them over without a rebalance, and
+// the partitions of members that do not come back are released when the timer fires.
+void ConsumerGroup::loadMetadata() {
+    GroupState state = metadataWriter_->load();
+    for (const auto& [consumerId, heartbeat] : state.members) {
+        staticMembers_.insert(consumerId);
+        departedMembers_[consumerId].departedAt = heartbeat;
+    }
+    for (const auto& [partitionId, consumerId] : state.assignments) {
+        if (departedMembers_.contains(consumerId)) {
+            partitionAssignments_[partitionId] = consumerId;
+            memberAssignments_[consumerId].push_back(partitionId);
+        }
+    }
+    for (auto& [consumerId, partitions] : memberAssignments_) {
+        std::sort(partitions.begin(), partitions.end());
+    }
+}
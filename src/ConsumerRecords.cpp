@@ -0,0 +1,65 @@
+#include "ConsumerRecords.h"
+
+// Constructor: Creates an empty batch
+ConsumerRecords::ConsumerRecords() :
+    count_(0),
+    sizeBytes_(0) {}
+
+// Building: Adds the records fetched from one partition (empty batches are skipped)
+void ConsumerRecords::add(uint32_t partitionId, std::vector<Message>&& messages) {
+    if (messages.empty()) {
+        return;
+    }
+
+    count_ += messages.size();
+    for (const auto& message : messages) {
+        sizeBytes_ += message.getSizeBytes();
+    }
+    partitions_.emplace_back(partitionId, std::move(messages));
+}
+
+// Accessor: Returns the records of one partition (empty if none were fetched)
+const std::vector<Message>& ConsumerRecords::records(uint32_t partitionId) const {
+    static const std::vector<Message> empty;
+    for (const auto& [id, messages] : partitions_) {
+        if (id == partitionId) {
+            return messages;
+        }
+    }
+    return empty;
+}
+
+// Accessor: Returns the partitions that contributed records, in fetch order
+std::vector<uint32_t> ConsumerRecords::partitions() const {
+    std::vector<uint32_t> ids;
+    ids.reserve(partitions_.size());
+    for (const auto& [id, messages] : partitions_) {
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+// Accessor: Returns the total number of records in the batch
+size_t ConsumerRecords::count() const {
+    return count_;
+}
+
+// Accessor: Returns the total payload size (key + value) of the batch
+uint64_t ConsumerRecords::sizeBytes() const {
+    return sizeBytes_;
+}
+
+// Accessor: Checks if the batch has no records
+bool ConsumerRecords::empty() const {
+    return count_ == 0;
+}
+
+// Iteration: Beginning of the (partitionId, messages) pairs
+ConsumerRecords::const_iterator ConsumerRecords::begin() const {
+    return partitions_.begin();
+}
+
+// Iteration: End of the (partitionId, messages) pairs
+ConsumerRecords::const_iterator ConsumerRecords::end() const {
+    return partitions_.end();
+}
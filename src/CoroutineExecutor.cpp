@@ -0,0 +1,149 @@
+#include "CoroutineExecutor.h"
+#include "Metrics.h"
+
+#include <algorithm>
+
+namespace {
+
+thread_local CoroutineExecutor* currentExecutor = nullptr;
+
+// Fire-and-forget coroutine frame used by spawn(); destroys itself when it finishes
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept {}
+    };
+};
+
+DetachedTask runDetached(CoroutineExecutor& executor, Task<void> task) {
+    co_await executor.schedule();
+    try {
+        co_await task;
+    } catch (const std::exception& e) {
+        Metrics::getInstance().logError("Unhandled exception in spawned task: " + std::string(e.what()));
+    }
+}
+
+} // namespace
+
+// Constructor: Initializes the executor (threads start with start())
+CoroutineExecutor::CoroutineExecutor(size_t numThreads) :
+    numThreads_(std::max<size_t>(numThreads, 1)),
+    running_(false),
+    totalResumed_(0) {}
+
+// Destructor: Stops the worker threads
+CoroutineExecutor::~CoroutineExecutor() {
+    stop();
+    join();
+}
+
+// Lifecycle: Starts the worker threads
+void CoroutineExecutor::start() {
+    if (running_.load()) {
+        return;
+    }
+
+    running_.store(true);
+    for (size_t i = 0; i < numThreads_; ++i) {
+        workers_.emplace_back(&CoroutineExecutor::workerThread, this);
+    }
+}
+
+// Lifecycle: Stops the worker threads once the ready queue is drained
+void CoroutineExecutor::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(readyMutex_);
+        running_.store(false);
+    }
+    readyCv_.notify_all();
+}
+
+// Lifecycle: Waits for the worker threads to finish
+void CoroutineExecutor::join() {
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+
+// Scheduling: Queues a suspended coroutine to be resumed by a worker
+void CoroutineExecutor::post(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> lock(readyMutex_);
+        ready_.push_back(handle);
+    }
+    readyCv_.notify_one();
+}
+
+// Scheduling: Returns the executor running the calling thread, or nullptr
+CoroutineExecutor* CoroutineExecutor::current() {
+    return currentExecutor;
+}
+
+// Scheduling: Returns an awaitable that continues the caller on this executor
+CoroutineExecutor::ScheduleAwaiter CoroutineExecutor::schedule() {
+    return ScheduleAwaiter{*this};
+}
+
+// Statistics: Returns the number of coroutines waiting to be resumed
+size_t CoroutineExecutor::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(readyMutex_);
+    return ready_.size();
+}
+
+// Statistics: Returns the number of coroutine resumptions so far
+uint64_t CoroutineExecutor::getTotalResumed() const {
+    return totalResumed_.load();
+}
+
+// Statistics: Checks if the executor is running
+bool CoroutineExecutor::isRunning() const {
+    return running_.load();
+}
+
+// Background: Resumes ready coroutines until stopped and drained
+void CoroutineExecutor::workerThread() {
+    currentExecutor = this;
+
+    while (true) {
+        std::coroutine_handle<> handle;
+        {
+            std::unique_lock<std::mutex> lock(readyMutex_);
+            readyCv_.wait(lock, [this] { return !ready_.empty() || !running_.load(); });
+            if (ready_.empty()) {
+                break;
+            }
+            handle = ready_.front();
+            ready_.pop_front();
+        }
+
+        totalResumed_.fetch_add(1);
+        handle.resume();
+    }
+
+    currentExecutor = nullptr;
+}
+
+// Scheduling: Resumes a coroutine on an executor, or inline without one
+void resumeOn(CoroutineExecutor* executor, std::coroutine_handle<> handle) {
+    if (executor) {
+        executor->post(handle);
+    } else {
+        handle.resume();
+    }
+}
+
+// Scheduling: Starts a task on the executor without awaiting it
+void spawn(CoroutineExecutor& executor, Task<void> task) {
+    runDetached(executor, std::move(task));
+}
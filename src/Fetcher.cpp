@@ -0,0 +1,309 @@
+#include "Fetcher.h"
+#include "Broker.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <chrono>
+
+// Constructor: Creates an empty session for one consumer of a topic
+FetchSession::FetchSession(Fetcher& fetcher, std::string topicName, uint64_t maxBufferedBytes) :
+    fetcher_(fetcher),
+    topicName_(std::move(topicName)),
+    maxBufferedBytes_(maxBufferedBytes),
+    bufferedBytes_(0),
+    closed_(false) {}
+
+// Consumer: Moves prefetched records at 'position' into 'out'. Records below 'position'
+// (already read by a direct fetch) are dropped. If the buffer is ahead of 'position'
+// (a seek back), it is discarded and refilled from there. Returns the number of records taken.
+size_t FetchSession::take(uint32_t partitionId, uint64_t position, size_t maxRecords, uint64_t maxBytes,
+                          std::vector<Message>& out) {
+    size_t taken = 0;
+    bool wakeFetcher = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        PartitionBuffer& buffer = buffers_[partitionId];
+
+        wakeFetcher = skipBelow(buffer, position);
+
+        uint64_t bufferedOffset = buffer.messages.empty() ? buffer.nextFetchOffset
+                                                          : buffer.messages.front().getOffset();
+        if (bufferedOffset != position) {
+            resetBuffer(buffer, position);
+            wakeFetcher = true;
+        } else {
+            uint64_t bytes = 0;
+            while (!buffer.messages.empty() && taken < maxRecords) {
+                uint64_t messageBytes = buffer.messages.front().getSizeBytes();
+                if (taken > 0 && bytes + messageBytes > maxBytes) {
+                    break;
+                }
+                bytes += messageBytes;
+                buffer.bytes -= messageBytes;
+                bufferedBytes_ -= messageBytes;
+                out.push_back(std::move(buffer.messages.front()));
+                buffer.messages.pop_front();
+                ++taken;
+            }
+            wakeFetcher |= taken > 0;
+        }
+    }
+
+    if (wakeFetcher) {
+        fetcher_.notify();
+    }
+    return taken;
+}
+
+// Consumer: Records that a direct fetch moved the consumer to 'position', so the fetcher
+// continues from there instead of fetching those records again
+void FetchSession::advance(uint32_t partitionId, uint64_t position) {
+    bool wakeFetcher;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wakeFetcher = skipBelow(buffers_[partitionId], position);
+    }
+    if (wakeFetcher) {
+        fetcher_.notify();
+    }
+}
+
+// Consumer: Drops the buffers of partitions that are no longer assigned
+void FetchSession::assign(const std::vector<uint32_t>& partitions) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = buffers_.begin(); it != buffers_.end();) {
+        if (std::find(partitions.begin(), partitions.end(), it->first) == partitions.end()) {
+            bufferedBytes_ -= it->second.bytes;
+            it = buffers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Consumer: Discards the partition's buffer and restarts prefetching at 'offset'
+void FetchSession::seek(uint32_t partitionId, uint64_t offset) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        resetBuffer(buffers_[partitionId], offset);
+    }
+    fetcher_.notify();
+}
+
+// Consumer: Detaches the session; the fetcher forgets it on its next pass
+void FetchSession::close() {
+    closed_.store(true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.clear();
+    bufferedBytes_ = 0;
+}
+
+// Statistics: Returns the bytes currently buffered across all partitions
+uint64_t FetchSession::getBufferedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bufferedBytes_;
+}
+
+// Getter: Returns the topic this session prefetches from
+const std::string& FetchSession::getTopicName() const {
+    return topicName_;
+}
+
+// Statistics: Checks if the session was closed
+bool FetchSession::isClosed() const {
+    return closed_.load();
+}
+
+// Internal: Lists the partitions below their share of the byte budget
+std::vector<FetchSession::FetchTarget> FetchSession::collectTargets() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<FetchTarget> targets;
+    if (buffers_.empty()) {
+        return targets;
+    }
+
+    uint64_t partitionBudget = std::max<uint64_t>(maxBufferedBytes_ / buffers_.size(), 1);
+    for (const auto& [partitionId, buffer] : buffers_) {
+        if (buffer.bytes < partitionBudget) {
+            targets.push_back({partitionId, buffer.nextFetchOffset, partitionBudget - buffer.bytes, buffer.epoch});
+        }
+    }
+    return targets;
+}
+
+// Internal: Appends fetched records unless the buffer was reset while the fetch was in flight
+void FetchSession::deliver(const FetchTarget& target, std::vector<Message>&& messages) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = buffers_.find(target.partitionId);
+    if (it == buffers_.end() || it->second.epoch != target.epoch || closed_.load()) {
+        return;
+    }
+
+    PartitionBuffer& buffer = it->second;
+    for (auto& message : messages) {
+        uint64_t messageBytes = message.getSizeBytes();
+        buffer.bytes += messageBytes;
+        bufferedBytes_ += messageBytes;
+        buffer.messages.push_back(std::move(message));
+    }
+    // A direct fetch may have moved the next fetch past this one while it was in flight
+    buffer.nextFetchOffset = std::max(buffer.nextFetchOffset, buffer.messages.back().getOffset() + 1);
+}
+
+// Internal: Drops buffered records below 'position' and moves the next fetch up to it;
+// returns true if anything changed. Caller holds mutex_.
+bool FetchSession::skipBelow(PartitionBuffer& buffer, uint64_t position) {
+    bool changed = false;
+    while (!buffer.messages.empty() && buffer.messages.front().getOffset() < position) {
+        uint64_t messageBytes = buffer.messages.front().getSizeBytes();
+        buffer.bytes -= messageBytes;
+        bufferedBytes_ -= messageBytes;
+        buffer.messages.pop_front();
+        changed = true;
+    }
+    if (buffer.messages.empty() && buffer.nextFetchOffset < position) {
+        buffer.nextFetchOffset = position;
+        changed = true;
+    }
+    return changed;
+}
+
+// Internal: Clears a buffer and repositions it; caller holds mutex_
+void FetchSession::resetBuffer(PartitionBuffer& buffer, uint64_t offset) {
+    bufferedBytes_ -= buffer.bytes;
+    buffer.messages.clear();
+    buffer.bytes = 0;
+    buffer.nextFetchOffset = offset;
+    buffer.epoch++;
+}
+
+// Constructor: Initializes the fetcher
+Fetcher::Fetcher(Broker& broker) :
+    broker_(broker),
+    running_(false),
+    maxRecordsPerFetch_(500),
+    totalFetchedMessages_(0),
+    wakeRequested_(false) {}
+
+// Destructor: Stops the fetcher thread
+Fetcher::~Fetcher() {
+    stop();
+    join();
+}
+
+// Lifecycle: Starts the background fetcher thread
+void Fetcher::start() {
+    if (running_.load()) {
+        return;
+    }
+
+    running_.store(true);
+    fetcherThread_ = std::thread(&Fetcher::fetcherThread, this);
+}
+
+// Lifecycle: Stops the background fetcher thread
+void Fetcher::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    running_.store(false);
+    notify();
+}
+
+// Lifecycle: Waits for the fetcher thread to finish
+void Fetcher::join() {
+    if (fetcherThread_.joinable()) {
+        fetcherThread_.join();
+    }
+}
+
+// Sessions: Opens a prefetch session with its own byte budget
+std::shared_ptr<FetchSession> Fetcher::openSession(const std::string& topicName, uint64_t maxBufferedBytes) {
+    auto session = std::make_shared<FetchSession>(*this, topicName, maxBufferedBytes);
+    {
+        std::lock_guard<std::mutex> lock(sessionsMutex_);
+        sessions_.push_back(session);
+    }
+    notify();
+    return session;
+}
+
+// Wake-up: Requests another fetch pass (under wakeMutex_, so it cannot slip in between the
+// fetcher thread checking the flag and starting to wait)
+void Fetcher::notify() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakeRequested_.store(true);
+    }
+    wakeCv_.notify_one();
+}
+
+// Statistics: Returns total number of prefetched messages
+uint64_t Fetcher::getTotalFetchedMessages() const {
+    return totalFetchedMessages_.load();
+}
+
+// Statistics: Checks if fetcher is running
+bool Fetcher::isRunning() const {
+    return running_.load();
+}
+
+// Configuration: Sets the record limit of a single broker fetch
+void Fetcher::setMaxRecordsPerFetch(size_t maxRecords) {
+    maxRecordsPerFetch_.store(std::max<size_t>(maxRecords, 1));
+}
+
+// Background: Keeps every open session's buffers filled up to their byte budget
+void Fetcher::fetcherThread() {
+    while (running_.load()) {
+        std::vector<std::shared_ptr<FetchSession>> sessions;
+        {
+            std::lock_guard<std::mutex> lock(sessionsMutex_);
+            for (auto it = sessions_.begin(); it != sessions_.end();) {
+                auto session = it->lock();
+                if (!session || session->isClosed()) {
+                    it = sessions_.erase(it);
+                } else {
+                    sessions.push_back(std::move(session));
+                    ++it;
+                }
+            }
+        }
+
+        wakeRequested_.store(false);
+        bool fetchedAny = false;
+        for (auto& session : sessions) {
+            fetchedAny |= fillSession(*session);
+        }
+
+        if (!fetchedAny) {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wakeCv_.wait_for(lock, std::chrono::milliseconds(5), [this] {
+                return wakeRequested_.load() || !running_.load();
+            });
+        }
+    }
+}
+
+// Internal: Runs one fetch per under-budget partition of a session (outside the session lock)
+bool Fetcher::fillSession(FetchSession& session) {
+    bool fetchedAny = false;
+
+    for (const auto& target : session.collectTargets()) {
+        try {
+            auto messages = broker_.fetch(session.getTopicName(), target.partitionId, target.offset,
+                                          maxRecordsPerFetch_.load(), target.budgetBytes);
+            if (!messages.empty()) {
+                totalFetchedMessages_.fetch_add(messages.size());
+                session.deliver(target, std::move(messages));
+                fetchedAny = true;
+            }
+        } catch (const std::exception& e) {
+            Metrics::getInstance().logError("Prefetch failed for topic " + session.getTopicName() + 
+                                            " partition " + std::to_string(target.partitionId) + ": " + e.what());
+        }
+    }
+
+    return fetchedAny;
+}
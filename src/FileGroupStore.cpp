@@ -0,0 +1,378 @@
+#include "FileGroupStore.h"
+#include "Metrics.h"
+#include "RecordIO.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using recordio::checksum;
+using recordio::appendValue;
+using recordio::readValue;
+
+constexpr uint8_t kRecordMagic = 0x47;
+constexpr size_t kRecordHeaderSize = 1 + 4; // magic, payload length
+constexpr size_t kChecksumSize = 4;
+
+void appendString(std::string& buffer, const std::string& value) {
+    appendValue<uint32_t>(buffer, static_cast<uint32_t>(value.size()));
+    buffer.append(value);
+}
+
+// Bounds-checked cursor over a record payload
+class PayloadReader {
+public:
+    PayloadReader(const char* data, size_t size) : data_(data), size_(size), position_(0) {}
+
+    template <typename T>
+    bool read(T& value) {
+        if (size_ - position_ < sizeof(T)) {
+            return false;
+        }
+        value = readValue<T>(data_ + position_);
+        position_ += sizeof(T);
+        return true;
+    }
+
+    bool readString(std::string& value) {
+        uint32_t length;
+        if (!read(length) || size_ - position_ < length) {
+            return false;
+        }
+        value.assign(data_ + position_, length);
+        position_ += length;
+        return true;
+    }
+
+    bool atEnd() const {
+        return position_ == size_;
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t position_;
+};
+
+bool decodePayload(const char* data, size_t size, std::string& groupId, std::string& topicName, GroupStateDiff& diff) {
+    PayloadReader reader(data, size);
+    uint32_t count;
+    if (!reader.readString(groupId) || !reader.readString(topicName)) {
+        return false;
+    }
+
+    if (!reader.read(count)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string consumerId;
+        int64_t heartbeatMs;
+        if (!reader.readString(consumerId) || !reader.read(heartbeatMs)) {
+            return false;
+        }
+        auto heartbeat = std::chrono::system_clock::time_point(std::chrono::milliseconds(heartbeatMs));
+        diff.upsertedMembers.emplace_back(std::move(consumerId), heartbeat);
+    }
+
+    if (!reader.read(count)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string consumerId;
+        if (!reader.readString(consumerId)) {
+            return false;
+        }
+        diff.removedMembers.push_back(std::move(consumerId));
+    }
+
+    if (!reader.read(count)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t partitionId;
+        std::string consumerId;
+        if (!reader.read(partitionId) || !reader.readString(consumerId)) {
+            return false;
+        }
+        diff.upsertedAssignments.emplace_back(partitionId, std::move(consumerId));
+    }
+
+    if (!reader.read(count)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t partitionId;
+        if (!reader.read(partitionId)) {
+            return false;
+        }
+        diff.removedAssignments.push_back(partitionId);
+    }
+
+    return reader.atEnd();
+}
+
+} // namespace
+
+// Constructor: Recovers group state from the snapshot and journal under 'directory'
+FileGroupStore::FileGroupStore(std::string directory) :
+    directory_(std::move(directory)),
+    journalFd_(-1),
+    journalLength_(0),
+    recordsInJournal_(0),
+    syncWrites_(false),
+    snapshotThreshold_(1000),
+    totalAppends_(0),
+    totalSnapshots_(0) {
+    std::filesystem::create_directories(directory_);
+    journalPath_ = (std::filesystem::path(directory_) / "journal.log").string();
+    snapshotPath_ = (std::filesystem::path(directory_) / "snapshot.log").string();
+    std::filesystem::remove(snapshotPath_ + ".tmp");
+
+    replay(snapshotPath_);
+    recordsInJournal_ = 0;
+    size_t validJournal = replay(journalPath_);
+    if (std::filesystem::exists(journalPath_) && validJournal < std::filesystem::file_size(journalPath_)) {
+        Metrics::getInstance().logWarn("Truncating torn tail of group journal " + journalPath_);
+        std::filesystem::resize_file(journalPath_, validJournal);
+    }
+
+    journalFd_ = ::open(journalPath_.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (journalFd_ < 0) {
+        throw std::runtime_error("Cannot open group journal " + journalPath_ + ": " + std::strerror(errno));
+    }
+    journalLength_ = std::filesystem::file_size(journalPath_);
+
+    Metrics::getInstance().logInfo("Recovered " + std::to_string(groups_.size()) + " consumer groups from " + directory_);
+}
+
+// Destructor: Syncs and closes the journal
+FileGroupStore::~FileGroupStore() {
+    if (journalFd_ >= 0) {
+        ::fsync(journalFd_);
+        ::close(journalFd_);
+    }
+}
+
+// Persistence: Returns the group's state, journaling the registration of a new group
+GroupState FileGroupStore::load(const std::string& groupId, const std::string& topicName) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = groups_.find(groupId);
+    if (it != groups_.end() && it->second.topicName == topicName) {
+        return it->second;
+    }
+
+    std::string record;
+    encodeRecord(record, groupId, topicName, GroupStateDiff());
+    try {
+        recordio::appendToLog(journalFd_, record, journalLength_, "Group journal", syncWrites_.load());
+        recordsInJournal_++;
+        totalAppends_++;
+    } catch (const std::exception& e) {
+        Metrics::getInstance().logError("Error registering group " + groupId + ": " + e.what());
+    }
+
+    GroupState& state = groups_[groupId];
+    state.groupId = groupId;
+    state.topicName = topicName;
+    return state;
+}
+
+// Persistence: Appends the diff as one journal record, then applies it in memory. A failed
+// append is cut back, so the journal never holds a torn record with diffs after it.
+bool FileGroupStore::apply(const std::string& groupId, const std::string& topicName, const GroupStateDiff& diff) {
+    std::string record;
+    encodeRecord(record, groupId, topicName, diff);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+        recordio::appendToLog(journalFd_, record, journalLength_, "Group journal", syncWrites_.load());
+    } catch (const std::exception& e) {
+        Metrics::getInstance().logError("Error appending to group journal: " + std::string(e.what()));
+        return false;
+    }
+
+    GroupState& state = groups_[groupId];
+    state.groupId = groupId;
+    state.topicName = topicName;
+    applyToState(state, diff);
+    recordsInJournal_++;
+    totalAppends_++;
+
+    if (recordsInJournal_ >= snapshotThreshold_.load()) {
+        try {
+            snapshot();
+        } catch (const std::exception& e) {
+            Metrics::getInstance().logError("Error writing group snapshot: " + std::string(e.what()));
+        }
+    }
+    return true;
+}
+
+// Status: The embedded store is always available once constructed
+bool FileGroupStore::isAvailable() const {
+    return true;
+}
+
+// Status: Backend name for logs
+std::string FileGroupStore::getName() const {
+    return "file:" + directory_;
+}
+
+// Configuration: fsync every journal append (off by default)
+void FileGroupStore::setSyncWrites(bool syncWrites) {
+    syncWrites_.store(syncWrites);
+}
+
+// Configuration: Sets the journal length (in records) that triggers a snapshot
+void FileGroupStore::setSnapshotThreshold(uint64_t journalRecords) {
+    snapshotThreshold_.store(journalRecords > 0 ? journalRecords : 1);
+}
+
+// Statistics: Returns the number of journal appends
+uint64_t FileGroupStore::getTotalAppends() const {
+    return totalAppends_.load();
+}
+
+// Statistics: Returns the number of snapshots written
+uint64_t FileGroupStore::getTotalSnapshots() const {
+    return totalSnapshots_.load();
+}
+
+// Internal: Serializes one diff (magic, payload length, payload, checksum)
+void FileGroupStore::encodeRecord(std::string& buffer, const std::string& groupId, const std::string& topicName,
+                                  const GroupStateDiff& diff) {
+    size_t start = buffer.size();
+    buffer.push_back(static_cast<char>(kRecordMagic));
+    appendValue<uint32_t>(buffer, 0); // Payload length, patched below
+
+    appendString(buffer, groupId);
+    appendString(buffer, topicName);
+
+    appendValue<uint32_t>(buffer, static_cast<uint32_t>(diff.upsertedMembers.size()));
+    for (const auto& [consumerId, heartbeat] : diff.upsertedMembers) {
+        appendString(buffer, consumerId);
+        appendValue<int64_t>(buffer, std::chrono::duration_cast<std::chrono::milliseconds>(
+                                         heartbeat.time_since_epoch()).count());
+    }
+
+    appendValue<uint32_t>(buffer, static_cast<uint32_t>(diff.removedMembers.size()));
+    for (const auto& consumerId : diff.removedMembers) {
+        appendString(buffer, consumerId);
+    }
+
+    appendValue<uint32_t>(buffer, static_cast<uint32_t>(diff.upsertedAssignments.size()));
+    for (const auto& [partitionId, consumerId] : diff.upsertedAssignments) {
+        appendValue<uint32_t>(buffer, partitionId);
+        appendString(buffer, consumerId);
+    }
+
+    appendValue<uint32_t>(buffer, static_cast<uint32_t>(diff.removedAssignments.size()));
+    for (uint32_t partitionId : diff.removedAssignments) {
+        appendValue<uint32_t>(buffer, partitionId);
+    }
+
+    uint32_t payloadLength = static_cast<uint32_t>(buffer.size() - start - kRecordHeaderSize);
+    std::memcpy(buffer.data() + start + 1, &payloadLength, sizeof(payloadLength));
+    appendValue<uint32_t>(buffer, checksum(buffer.data() + start, buffer.size() - start));
+}
+
+// Internal: Applies a diff to an in-memory snapshot (removed members take their assignments along)
+void FileGroupStore::applyToState(GroupState& state, const GroupStateDiff& diff) {
+    for (const auto& [consumerId, heartbeat] : diff.upsertedMembers) {
+        state.members[consumerId] = heartbeat;
+    }
+    for (const auto& [partitionId, consumerId] : diff.upsertedAssignments) {
+        state.assignments[partitionId] = consumerId;
+    }
+    for (uint32_t partitionId : diff.removedAssignments) {
+        state.assignments.erase(partitionId);
+    }
+    for (const auto& consumerId : diff.removedMembers) {
+        state.members.erase(consumerId);
+        std::erase_if(state.assignments, [&consumerId](const auto& entry) { return entry.second == consumerId; });
+    }
+}
+
+// Internal: Applies every valid record of a file to groups_; returns the valid prefix length
+size_t FileGroupStore::replay(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        return 0;
+    }
+    std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    size_t position = 0;
+    while (position + kRecordHeaderSize <= data.size()) {
+        const char* record = data.data() + position;
+        if (static_cast<uint8_t>(record[0]) != kRecordMagic) {
+            break;
+        }
+
+        uint32_t payloadLength = readValue<uint32_t>(record + 1);
+        size_t recordSize = kRecordHeaderSize + payloadLength + kChecksumSize;
+        if (data.size() - position < recordSize) {
+            break;
+        }
+
+        size_t bodySize = recordSize - kChecksumSize;
+        if (readValue<uint32_t>(record + bodySize) != checksum(record, bodySize)) {
+            break;
+        }
+
+        std::string groupId;
+        std::string topicName;
+        GroupStateDiff diff;
+        if (!decodePayload(record + kRecordHeaderSize, payloadLength, groupId, topicName, diff)) {
+            break;
+        }
+
+        GroupState& state = groups_[groupId];
+        state.groupId = groupId;
+        state.topicName = topicName;
+        applyToState(state, diff);
+        recordsInJournal_++;
+        position += recordSize;
+    }
+
+    return position;
+}
+
+// Internal: Writes every group's full state to a new snapshot and empties the journal;
+// caller holds mutex_. Replaying an old journal over a newer snapshot is harmless, since
+// each record only sets rows to their latest values.
+void FileGroupStore::snapshot() {
+    std::string buffer;
+    for (const auto& [groupId, state] : groups_) {
+        GroupStateDiff full;
+        full.upsertedMembers.assign(state.members.begin(), state.members.end());
+        full.upsertedAssignments.assign(state.assignments.begin(), state.assignments.end());
+        encodeRecord(buffer, groupId, state.topicName, full);
+    }
+
+    std::string temporaryPath = snapshotPath_ + ".tmp";
+    int fd = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + temporaryPath + ": " + std::strerror(errno));
+    }
+    try {
+        recordio::writeFully(fd, buffer, "Group snapshot");
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    // The journal may only be emptied once the new snapshot is durably in place
+    recordio::renameDurably(temporaryPath, snapshotPath_, "Group snapshot");
+
+    if (::ftruncate(journalFd_, 0) != 0) {
+        throw std::runtime_error("Cannot truncate group journal: " + std::string(std::strerror(errno)));
+    }
+    journalLength_ = 0;
+    recordsInJournal_ = 0;
+    totalSnapshots_++;
+}
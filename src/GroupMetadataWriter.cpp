@@ -0,0 +1,139 @@
+#include "GroupMetadataWriter.h"
+
+// Constructor: Creates a writer for one group on top of a shared store
+GroupMetadataWriter::GroupMetadataWriter(std::shared_ptr<GroupMetadataStore> store, std::string groupId,
+                                         std::string topicName) :
+    store_(std::move(store)),
+    groupId_(std::move(groupId)),
+    topicName_(std::move(topicName)),
+    submittedSequence_(0),
+    attemptedSequence_(0),
+    running_(false),
+    totalWrites_(0),
+    totalCoalesced_(0) {
+    persisted_.groupId = groupId_;
+    persisted_.topicName = topicName_;
+}
+
+// Destructor: Writes the last submitted snapshot
+GroupMetadataWriter::~GroupMetadataWriter() {
+    stop();
+    join();
+}
+
+// Lifecycle: Starts the writer thread
+void GroupMetadataWriter::start() {
+    if (running_.load() || !store_->isAvailable()) {
+        return;
+    }
+
+    running_.store(true);
+    writerThread_ = std::thread(&GroupMetadataWriter::writerThread, this);
+}
+
+// Lifecycle: Asks the writer thread to finish after the pending snapshot
+void GroupMetadataWriter::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(false);
+    }
+    pendingCv_.notify_all();
+}
+
+// Lifecycle: Waits for the writer thread to finish
+void GroupMetadataWriter::join() {
+    if (writerThread_.joinable()) {
+        writerThread_.join();
+    }
+}
+
+// Persistence: Loads the stored group, which becomes the base for the first diff
+GroupState GroupMetadataWriter::load() {
+    persisted_ = store_->load(groupId_, topicName_);
+    return persisted_;
+}
+
+// Persistence: Hands a snapshot to the writer; a newer snapshot replaces an unwritten one
+void GroupMetadataWriter::submit(GroupState state) {
+    if (!store_->isAvailable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_) {
+            totalCoalesced_++;
+        }
+        pending_ = std::move(state);
+        submittedSequence_++;
+    }
+    pendingCv_.notify_one();
+}
+
+// Persistence: Waits until the writer has attempted every snapshot submitted so far
+void GroupMetadataWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t target = submittedSequence_;
+    attemptedCv_.wait(lock, [this, target] { return attemptedSequence_ >= target || !running_.load(); });
+}
+
+// Statistics: Returns true when the store can persist snapshots
+bool GroupMetadataWriter::isAvailable() const {
+    return store_->isAvailable();
+}
+
+// Statistics: Returns the number of diffs applied to the store
+uint64_t GroupMetadataWriter::getTotalWrites() const {
+    return totalWrites_.load();
+}
+
+// Statistics: Returns the number of snapshots superseded before they were written
+uint64_t GroupMetadataWriter::getTotalCoalesced() const {
+    return totalCoalesced_.load();
+}
+
+// Status: Check if the writer thread is running
+bool GroupMetadataWriter::isRunning() const {
+    return running_.load();
+}
+
+// Background: Writes the latest snapshot as a diff; failed writes are retried after a pause
+void GroupMetadataWriter::writerThread() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        pendingCv_.wait(lock, [this] { return pending_.has_value() || !running_.load(); });
+        if (!pending_) {
+            break;
+        }
+
+        GroupState state = std::move(*pending_);
+        pending_.reset();
+        uint64_t sequence = submittedSequence_;
+        lock.unlock();
+
+        GroupStateDiff diff = GroupStateDiff::between(persisted_, state);
+        bool persisted = diff.empty() || store_->apply(groupId_, topicName_, diff);
+        if (persisted) {
+            totalWrites_ += diff.empty() ? 0 : 1;
+            persisted_ = std::move(state);
+        }
+
+        lock.lock();
+        attemptedSequence_ = sequence;
+        attemptedCv_.notify_all();
+
+        if (!persisted && running_.load()) {
+            if (!pending_) {
+                pending_ = std::move(state);
+            }
+            pendingCv_.wait_for(lock, std::chrono::seconds(1), [this] { return !running_.load(); });
+        }
+    }
+
+    attemptedCv_.notify_all();
+}
@@ -0,0 +1,38 @@
+#include "GroupState.h"
+
+// Diff: Computes the member and assignment rows that changed between two snapshots
+GroupStateDiff GroupStateDiff::between(const GroupState& before, const GroupState& after) {
+    GroupStateDiff diff;
+
+    for (const auto& [consumerId, heartbeat] : after.members) {
+        auto it = before.members.find(consumerId);
+        if (it == before.members.end() || it->second != heartbeat) {
+            diff.upsertedMembers.emplace_back(consumerId, heartbeat);
+        }
+    }
+    for (const auto& [consumerId, heartbeat] : before.members) {
+        if (!after.members.contains(consumerId)) {
+            diff.removedMembers.push_back(consumerId);
+        }
+    }
+
+    for (const auto& [partitionId, consumerId] : after.assignments) {
+        auto it = before.assignments.find(partitionId);
+        if (it == before.assignments.end() || it->second != consumerId) {
+            diff.upsertedAssignments.emplace_back(partitionId, consumerId);
+        }
+    }
+    for (const auto& [partitionId, consumerId] : before.assignments) {
+        if (!after.assignments.contains(partitionId)) {
+            diff.removedAssignments.push_back(partitionId);
+        }
+    }
+
+    return diff;
+}
+
+// Diff: True when both snapshots persist to the same rows
+bool GroupStateDiff::empty() const {
+    return upsertedMembers.empty() && removedMembers.empty() &&
+           upsertedAssignments.empty() && removedAssignments.empty();
+}
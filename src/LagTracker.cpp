@@ -0,0 +1,116 @@
+#include "LagTracker.h"
+#include "Metrics.h"
+
+// Constructor: Starts with no tracked groups
+LagTracker::LagTracker() {}
+
+// Updates: Refreshes the lag gauge of every group consuming the topic after an append
+void TopicLag::refresh(uint64_t logEndSum) const {
+    if (!tracking_.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Entry* entry : groups_) {
+        uint64_t committedSum = entry->committedSum.load(std::memory_order_relaxed);
+        entry->lagGauge->store((logEndSum > committedSum) ? logEndSum - committedSum : 0, std::memory_order_relaxed);
+    }
+}
+
+// Updates: Replaces the partition's committed offset and adjusts the running sum
+void LagTracker::recordCommit(const std::string& groupId, const std::string& topicName, uint32_t partitionId,
+                              uint64_t offset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    GroupTopicOffsets& entry = offsets_[makeKey(groupId, topicName)];
+    if (entry.groupId.empty()) {
+        entry.groupId = groupId;
+        entry.topicName = topicName;
+        entry.lagGauge = &Metrics::getInstance().consumerLagGauge(groupId, topicName);
+
+        TopicLag& topicLag = *topicLagLocked(topicName);
+        std::lock_guard<std::mutex> topicLock(topicLag.mutex_);
+        topicLag.groups_.push_back(&entry);
+        topicLag.tracking_.store(true, std::memory_order_release);
+    }
+
+    uint64_t& committed = entry.committed[partitionId];
+    entry.committedSum.store(entry.committedSum.load(std::memory_order_relaxed) - committed + offset,
+                             std::memory_order_relaxed);
+    committed = offset;
+}
+
+// Updates: Computes a group's total lag on a topic and stores it in the gauge
+uint64_t LagTracker::updateLag(const std::string& groupId, const std::string& topicName, uint64_t logEndSum) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = offsets_.find(makeKey(groupId, topicName));
+    if (it == offsets_.end()) {
+        Metrics::getInstance().updateConsumerLag(groupId, topicName, logEndSum); // Nothing committed yet
+        return logEndSum;
+    }
+    uint64_t lag = lagOf(it->second, logEndSum);
+    it->second.lagGauge->store(lag, std::memory_order_relaxed);
+    return lag;
+}
+
+// Lookup: Returns the sum of committed offsets over the group's partitions of a topic
+uint64_t LagTracker::getCommittedSum(const std::string& groupId, const std::string& topicName) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = offsets_.find(makeKey(groupId, topicName));
+    return (it != offsets_.end()) ? it->second.committedSum.load(std::memory_order_relaxed) : 0;
+}
+
+// Lookup: Returns the committed offset of one partition, if any
+std::optional<uint64_t> LagTracker::getCommittedOffset(const std::string& groupId, const std::string& topicName,
+                                                       uint32_t partitionId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = offsets_.find(makeKey(groupId, topicName));
+    if (it == offsets_.end()) {
+        return std::nullopt;
+    }
+    auto partitionIt = it->second.committed.find(partitionId);
+    if (partitionIt == it->second.committed.end()) {
+        return std::nullopt;
+    }
+    return partitionIt->second;
+}
+
+// Lookup: Returns every (group, topic) pair with at least one commit
+std::vector<std::pair<std::string, std::string>> LagTracker::getTrackedGroups() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<std::string, std::string>> groups;
+    groups.reserve(offsets_.size());
+    for (const auto& [key, entry] : offsets_) {
+        groups.emplace_back(entry.groupId, entry.topicName);
+    }
+    return groups;
+}
+
+// Lookup: Returns the topic's handle, which the broker keeps on the Topic for appends
+std::shared_ptr<TopicLag> LagTracker::getTopicLag(const std::string& topicName) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return topicLagLocked(topicName);
+}
+
+// Utility: Finds or creates a topic's handle; caller holds mutex_
+std::shared_ptr<TopicLag>& LagTracker::topicLagLocked(const std::string& topicName) {
+    std::shared_ptr<TopicLag>& topicLag = topics_[topicName];
+    if (!topicLag) {
+        topicLag = std::make_shared<TopicLag>();
+    }
+    return topicLag;
+}
+
+// Utility: Log end offset sum minus committed sum, never negative
+uint64_t LagTracker::lagOf(const GroupTopicOffsets& entry, uint64_t logEndSum) {
+    uint64_t committedSum = entry.committedSum.load(std::memory_order_relaxed);
+    return (logEndSum > committedSum) ? logEndSum - committedSum : 0;
+}
+
+// Utility: Map key for a group and topic, separated by '\0'
+std::string LagTracker::makeKey(const std::string& groupId, const std::string& topicName) {
+    std::string key;
+    key.reserve(groupId.size() + topicName.size() + 1);
+    key.append(groupId).push_back('\0');
+    key.append(topicName);
+    return key;
+}
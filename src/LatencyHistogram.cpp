@@ -0,0 +1,139 @@
+#include "LatencyHistogram.h"
+
+#include <bit>
+#include <vector>
+
+// Destructor: Frees the shards that were allocated
+LatencyHistogram::~LatencyHistogram() {
+    for (auto& shard : shards_) {
+        delete shard.load();
+    }
+}
+
+// Recording: Adds one latency sample
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    recordValue(latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0);
+}
+
+// Recording: Adds one sample given in nanoseconds
+void LatencyHistogram::recordValue(uint64_t nanos) {
+    Shard& shard = shardForThread();
+    shard.counts[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+    shard.total.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(nanos, std::memory_order_relaxed);
+
+    uint64_t max = shard.max.load(std::memory_order_relaxed);
+    while (nanos > max && !shard.max.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+// Reads: Merges the shards and computes count, mean, p50/p99/p999 and max
+LatencySnapshot LatencyHistogram::snapshot() const {
+    std::vector<uint64_t> counts(kBuckets, 0);
+    LatencySnapshot result;
+    uint64_t sum = 0;
+
+    for (const auto& slot : shards_) {
+        const Shard* shard = slot.load(std::memory_order_acquire);
+        if (shard == nullptr) {
+            continue;
+        }
+        for (size_t i = 0; i < kBuckets; ++i) {
+            counts[i] += shard->counts[i].load(std::memory_order_relaxed);
+        }
+        sum += shard->sum.load(std::memory_order_relaxed);
+        result.max = std::max(result.max, shard->max.load(std::memory_order_relaxed));
+    }
+
+    // Count from the merged buckets so the percentiles are consistent with it
+    for (uint64_t count : counts) {
+        result.count += count;
+    }
+    if (result.count == 0) {
+        return result;
+    }
+    result.mean = static_cast<double>(sum) / static_cast<double>(result.count);
+
+    const std::array<std::pair<double, uint64_t*>, 3> targets = {{
+        {0.50, &result.p50}, {0.99, &result.p99}, {0.999, &result.p999}
+    }};
+    size_t target = 0;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets && target < targets.size(); ++i) {
+        seen += counts[i];
+        while (target < targets.size() &&
+               static_cast<double>(seen) >= targets[target].first * static_cast<double>(result.count)) {
+            *targets[target].second = std::min(bucketUpperBound(i), result.max);
+            target++;
+        }
+    }
+    return result;
+}
+
+// Reads: Returns the number of samples recorded
+uint64_t LatencyHistogram::getCount() const {
+    uint64_t total = 0;
+    for (const auto& slot : shards_) {
+        const Shard* shard = slot.load(std::memory_order_acquire);
+        if (shard != nullptr) {
+            total += shard->total.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+// Reads: Zeroes every shard (samples racing with the reset may survive it)
+void LatencyHistogram::reset() {
+    for (auto& slot : shards_) {
+        Shard* shard = slot.load(std::memory_order_acquire);
+        if (shard == nullptr) {
+            continue;
+        }
+        for (auto& count : shard->counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        shard->total.store(0, std::memory_order_relaxed);
+        shard->sum.store(0, std::memory_order_relaxed);
+        shard->max.store(0, std::memory_order_relaxed);
+    }
+}
+
+// Bucket layout: Values below kSubBuckets map one to one; above that each power of two is
+// split into kHalfSubBuckets equal buckets. Values past the range share the last bucket.
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<size_t>(value);
+    }
+
+    size_t msb = 63 - static_cast<size_t>(std::countl_zero(value));
+    size_t shift = msb - (kSubBucketBits - 1);
+    size_t index = kSubBuckets + (shift - 1) * kHalfSubBuckets + static_cast<size_t>((value >> shift) - kHalfSubBuckets);
+    return std::min(index, kBuckets - 1);
+}
+
+// Bucket layout: Inverse of bucketIndex, giving the bucket's largest value
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+
+    size_t shift = (index - kSubBuckets) / kHalfSubBuckets + 1;
+    uint64_t subBucket = (index - kSubBuckets) % kHalfSubBuckets + kHalfSubBuckets;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+// Helper: Returns the calling thread's shard, allocating it on first use
+LatencyHistogram::Shard& LatencyHistogram::shardForThread() {
+    std::atomic<Shard*>& slot = shards_[ShardedCounter::threadIndex() % kShards];
+    Shard* shard = slot.load(std::memory_order_acquire);
+    if (shard != nullptr) {
+        return *shard;
+    }
+
+    Shard* created = new Shard();
+    if (slot.compare_exchange_strong(shard, created, std::memory_order_acq_rel)) {
+        return *created;
+    }
+    delete created; // Another thread of this shard won the race
+    return *shard;
+}
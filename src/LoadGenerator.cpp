@@ -0,0 +1,511 @@
+#include "LoadGenerator.h"
+#include "Producer.h"
+#include "Consumer.h"
+
+#include <cmath>
+#include <numbers>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Splits "a:b:c" into its fields
+std::vector<std::string> splitFields(const std::string& spec, char separator) {
+    std::vector<std::string> fields;
+    std::stringstream stream(spec);
+    std::string field;
+    while (std::getline(stream, field, separator)) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+double parseNumber(const std::string& text, const std::string& spec) {
+    try {
+        size_t used = 0;
+        double value = std::stod(text, &used);
+        if (used != text.size()) {
+            throw std::invalid_argument(text);
+        }
+        return value;
+    } catch (const std::exception&) {
+        throw std::invalid_argument("Invalid number '" + text + "' in '" + spec + "'");
+    }
+}
+
+std::string formatNumber(double value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+} // namespace
+
+// Factory: Every key equally likely
+KeyDistribution KeyDistribution::uniform(uint64_t keys) {
+    return KeyDistribution(Kind::Uniform, keys);
+}
+
+// Factory: Key rank r drawn with probability proportional to 1 / r^exponent (key-0 hottest)
+KeyDistribution KeyDistribution::zipfian(uint64_t keys, double exponent) {
+    if (exponent <= 0) {
+        throw std::invalid_argument("Zipfian exponent must be positive");
+    }
+    KeyDistribution distribution(Kind::Zipfian, keys);
+    distribution.exponent_ = exponent;
+    distribution.cdf_.resize(keys);
+    double sum = 0.0;
+    for (uint64_t rank = 1; rank <= keys; ++rank) {
+        sum += 1.0 / std::pow(static_cast<double>(rank), exponent);
+        distribution.cdf_[rank - 1] = sum;
+    }
+    for (double& value : distribution.cdf_) {
+        value /= sum;
+    }
+    return distribution;
+}
+
+// Factory: The first hotKeyFraction of the keys receive hotTrafficFraction of the messages
+KeyDistribution KeyDistribution::hotspot(uint64_t keys, double hotKeyFraction, double hotTrafficFraction) {
+    if (hotKeyFraction <= 0 || hotKeyFraction > 1 || hotTrafficFraction < 0 || hotTrafficFraction > 1) {
+        throw std::invalid_argument("Hotspot fractions must be in (0, 1] and [0, 1]");
+    }
+    KeyDistribution distribution(Kind::Hotspot, keys);
+    distribution.hotKeyFraction_ = hotKeyFraction;
+    distribution.hotTrafficFraction_ = hotTrafficFraction;
+    return distribution;
+}
+
+// Factory: Parses uniform, zipf:S or hotspot:KEY_FRACTION:TRAFFIC_FRACTION
+KeyDistribution KeyDistribution::parse(const std::string& spec, uint64_t keys) {
+    std::vector<std::string> fields = splitFields(spec, ':');
+    if (fields.size() == 1 && fields[0] == "uniform") {
+        return uniform(keys);
+    }
+    if (fields.size() == 2 && fields[0] == "zipf") {
+        return zipfian(keys, parseNumber(fields[1], spec));
+    }
+    if (fields.size() == 3 && fields[0] == "hotspot") {
+        return hotspot(keys, parseNumber(fields[1], spec), parseNumber(fields[2], spec));
+    }
+    throw std::invalid_argument("Key distribution must be uniform, zipf:S or hotspot:KEYS:TRAFFIC, got '" + spec + "'");
+}
+
+// Constructor: Common fields; the factories fill in the kind's parameters
+KeyDistribution::KeyDistribution(Kind kind, uint64_t keys) :
+    kind_(kind),
+    keys_(keys),
+    exponent_(0.0),
+    hotKeyFraction_(0.0),
+    hotTrafficFraction_(0.0) {
+    if (keys == 0) {
+        throw std::invalid_argument("Key count must be positive");
+    }
+}
+
+// Sampling: Returns the next key index
+uint64_t KeyDistribution::next(std::mt19937_64& rng) const {
+    switch (kind_) {
+        case Kind::Zipfian: {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+            return std::min<uint64_t>(static_cast<uint64_t>(it - cdf_.begin()), keys_ - 1);
+        }
+        case Kind::Hotspot: {
+            uint64_t hotKeys = std::max<uint64_t>(1, static_cast<uint64_t>(keys_ * hotKeyFraction_));
+            bool hot = hotKeys == keys_ || std::bernoulli_distribution(hotTrafficFraction_)(rng);
+            if (hot) {
+                return std::uniform_int_distribution<uint64_t>(0, hotKeys - 1)(rng);
+            }
+            return std::uniform_int_distribution<uint64_t>(hotKeys, keys_ - 1)(rng);
+        }
+        case Kind::Uniform:
+        default:
+            return std::uniform_int_distribution<uint64_t>(0, keys_ - 1)(rng);
+    }
+}
+
+// Getter: Returns the number of distinct keys
+uint64_t KeyDistribution::getKeyCount() const {
+    return keys_;
+}
+
+// Utility: Returns the distribution in its spec form
+std::string KeyDistribution::describe() const {
+    switch (kind_) {
+        case Kind::Zipfian:
+            return "zipf:" + formatNumber(exponent_);
+        case Kind::Hotspot:
+            return "hotspot:" + formatNumber(hotKeyFraction_) + ":" + formatNumber(hotTrafficFraction_);
+        case Kind::Uniform:
+        default:
+            return "uniform";
+    }
+}
+
+// Factory: Every payload the same size
+PayloadSizeDistribution PayloadSizeDistribution::fixed(size_t bytes) {
+    return PayloadSizeDistribution({Bucket{bytes, bytes, 1.0}});
+}
+
+// Factory: Parses fixed:N or a comma-separated histogram of MIN-MAX:WEIGHT buckets
+PayloadSizeDistribution PayloadSizeDistribution::parse(const std::string& spec) {
+    if (spec.rfind("fixed:", 0) == 0) {
+        return fixed(static_cast<size_t>(parseNumber(spec.substr(6), spec)));
+    }
+
+    std::vector<Bucket> buckets;
+    for (const auto& entry : splitFields(spec, ',')) {
+        std::vector<std::string> parts = splitFields(entry, ':');
+        std::vector<std::string> range = parts.empty() ? parts : splitFields(parts[0], '-');
+        if (parts.size() != 2 || range.size() != 2) {
+            throw std::invalid_argument("Payload histogram buckets must be MIN-MAX:WEIGHT, got '" + entry + "'");
+        }
+        buckets.push_back(Bucket{static_cast<size_t>(parseNumber(range[0], spec)),
+                                 static_cast<size_t>(parseNumber(range[1], spec)), parseNumber(parts[1], spec)});
+    }
+    return PayloadSizeDistribution(std::move(buckets));
+}
+
+// Constructor: Validates the buckets and builds the cumulative weights
+PayloadSizeDistribution::PayloadSizeDistribution(std::vector<Bucket> buckets) :
+    buckets_(std::move(buckets)) {
+    if (buckets_.empty()) {
+        throw std::invalid_argument("Payload histogram needs at least one bucket");
+    }
+    double total = 0.0;
+    for (const auto& bucket : buckets_) {
+        if (bucket.minBytes > bucket.maxBytes || bucket.weight < 0) {
+            throw std::invalid_argument("Payload bucket needs MIN <= MAX and a non-negative weight");
+        }
+        total += bucket.weight;
+        cdf_.push_back(total);
+    }
+    if (total <= 0) {
+        throw std::invalid_argument("Payload histogram weights must not all be zero");
+    }
+    for (double& value : cdf_) {
+        value /= total;
+    }
+}
+
+// Sampling: Picks a bucket by weight, then a size uniformly within it
+size_t PayloadSizeDistribution::next(std::mt19937_64& rng) const {
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    size_t index = std::min<size_t>(std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin(), buckets_.size() - 1);
+    const Bucket& bucket = buckets_[index];
+    return std::uniform_int_distribution<size_t>(bucket.minBytes, bucket.maxBytes)(rng);
+}
+
+// Getter: Returns the largest payload the distribution can produce
+size_t PayloadSizeDistribution::getMaxBytes() const {
+    size_t maxBytes = 0;
+    for (const auto& bucket : buckets_) {
+        maxBytes = std::max(maxBytes, bucket.maxBytes);
+    }
+    return maxBytes;
+}
+
+// Utility: Returns the distribution in its spec form
+std::string PayloadSizeDistribution::describe() const {
+    if (buckets_.size() == 1 && buckets_[0].minBytes == buckets_[0].maxBytes) {
+        return "fixed:" + std::to_string(buckets_[0].minBytes);
+    }
+    std::string out;
+    for (const auto& bucket : buckets_) {
+        out += (out.empty() ? "" : ",") + std::to_string(bucket.minBytes) + "-" + std::to_string(bucket.maxBytes) +
+               ":" + formatNumber(bucket.weight);
+    }
+    return out;
+}
+
+// Factory: Same rate throughout
+RateSchedule RateSchedule::constant(double rate) {
+    return RateSchedule(Kind::Constant, rate, 0, 0, 0);
+}
+
+// Factory: Sinusoidal day/night cycle around meanRate
+RateSchedule RateSchedule::diurnal(double meanRate, double amplitude, double periodSeconds) {
+    if (amplitude < 0 || amplitude > 1 || periodSeconds <= 0) {
+        throw std::invalid_argument("Diurnal schedule needs 0 <= amplitude <= 1 and a positive period");
+    }
+    return RateSchedule(Kind::Diurnal, meanRate, amplitude, periodSeconds, 0);
+}
+
+// Factory: peakRate for the first burstSeconds of every period, baseRate in between
+RateSchedule RateSchedule::burst(double baseRate, double peakRate, double periodSeconds, double burstSeconds) {
+    if (periodSeconds <= 0 || burstSeconds < 0 || burstSeconds > periodSeconds) {
+        throw std::invalid_argument("Burst schedule needs a positive period and 0 <= burst length <= period");
+    }
+    return RateSchedule(Kind::Burst, baseRate, peakRate, periodSeconds, burstSeconds);
+}
+
+// Factory: Parses constant:R, diurnal:MEAN:AMPLITUDE:PERIOD or burst:BASE:PEAK:PERIOD:LENGTH
+RateSchedule RateSchedule::parse(const std::string& spec) {
+    std::vector<std::string> fields = splitFields(spec, ':');
+    std::vector<double> values;
+    for (size_t i = 1; i < fields.size(); ++i) {
+        values.push_back(parseNumber(fields[i], spec));
+    }
+    if (!fields.empty() && fields[0] == "constant" && values.size() == 1) {
+        return constant(values[0]);
+    }
+    if (!fields.empty() && fields[0] == "diurnal" && values.size() == 3) {
+        return diurnal(values[0], values[1], values[2]);
+    }
+    if (!fields.empty() && fields[0] == "burst" && values.size() == 4) {
+        return burst(values[0], values[1], values[2], values[3]);
+    }
+    throw std::invalid_argument("Rate must be constant:R, diurnal:MEAN:AMP:PERIOD or burst:BASE:PEAK:PERIOD:LEN, got '" +
+                                spec + "'");
+}
+
+// Constructor: Stores the kind's parameters
+RateSchedule::RateSchedule(Kind kind, double a, double b, double c, double d) :
+    kind_(kind),
+    a_(a),
+    b_(b),
+    c_(c),
+    d_(d) {
+    if (a < 0 || b < 0) {
+        throw std::invalid_argument("Rates must not be negative");
+    }
+}
+
+// Schedule: Returns the target messages/sec at elapsedSeconds into the run
+double RateSchedule::rateAt(double elapsedSeconds) const {
+    switch (kind_) {
+        case Kind::Diurnal:
+            return a_ * (1.0 + b_ * std::sin(2.0 * std::numbers::pi * elapsedSeconds / c_));
+        case Kind::Burst:
+            return std::fmod(elapsedSeconds, c_) < d_ ? b_ : a_;
+        case Kind::Constant:
+        default:
+            return a_;
+    }
+}
+
+// Utility: Returns the schedule in its spec form
+std::string RateSchedule::describe() const {
+    switch (kind_) {
+        case Kind::Diurnal:
+            return "diurnal:" + formatNumber(a_) + ":" + formatNumber(b_) + ":" + formatNumber(c_);
+        case Kind::Burst:
+            return "burst:" + formatNumber(a_) + ":" + formatNumber(b_) + ":" + formatNumber(c_) + ":" +
+                   formatNumber(d_);
+        case Kind::Constant:
+        default:
+            return "constant:" + formatNumber(a_);
+    }
+}
+
+// Constructor: Creates the topic if needed and fixes the run seed
+LoadGenerator::LoadGenerator(Broker& broker, LoadGeneratorConfig config) :
+    broker_(broker),
+    config_(std::move(config)),
+    seed_(config_.seed != 0 ? config_.seed : (static_cast<uint64_t>(std::random_device()()) << 32 | std::random_device()())),
+    running_(false),
+    activeProducers_(0),
+    totalProduced_(0),
+    totalProducedBytes_(0),
+    consumedPerConsumer_(config_.consumers),
+    positions_(config_.partitions) {
+    if (config_.producers == 0 || config_.partitions == 0) {
+        throw std::invalid_argument("Load generator needs at least one producer and one partition");
+    }
+    if (config_.slowConsumers > config_.consumers) {
+        throw std::invalid_argument("Slow consumers cannot outnumber consumers");
+    }
+    if (!broker_.hasTopic(config_.topicName)) {
+        broker_.createTopic(config_.topicName, config_.partitions);
+    } else if (broker_.getNumPartitions(config_.topicName) != config_.partitions) {
+        throw std::invalid_argument("Topic " + config_.topicName + " exists with a different partition count");
+    }
+    for (size_t partition = 0; partition < config_.partitions; ++partition) {
+        positions_[partition].store(broker_.getLogEndOffset(config_.topicName, partition));
+    }
+}
+
+// Destructor: Stops the run if still going
+LoadGenerator::~LoadGenerator() {
+    stop();
+}
+
+// Lifecycle: Starts the producer and consumer threads
+void LoadGenerator::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(reportMutex_);
+        startTime_ = std::chrono::steady_clock::now();
+    }
+    activeProducers_.store(config_.producers);
+    Metrics::getInstance().logInfo("LoadGenerator started (seed " + std::to_string(seed_) + ")");
+
+    for (size_t i = 0; i < config_.producers; ++i) {
+        threads_.emplace_back(&LoadGenerator::producerThread, this, i);
+    }
+    for (size_t i = 0; i < config_.consumers; ++i) {
+        threads_.emplace_back(&LoadGenerator::consumerThread, this, i);
+    }
+}
+
+// Lifecycle: Ends the run early and waits for the threads
+void LoadGenerator::stop() {
+    running_.store(false);
+    join();
+}
+
+// Lifecycle: Waits until the run ends (duration elapsed or stop())
+void LoadGenerator::join() {
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    std::lock_guard<std::mutex> lock(reportMutex_);
+    if (!threads_.empty()) {
+        threads_.clear();
+        stopTime_ = std::chrono::steady_clock::now();
+        running_.store(false);
+    }
+}
+
+// Status: Returns true while producers are still sending
+bool LoadGenerator::isRunning() const {
+    return running_.load() && activeProducers_.load() > 0;
+}
+
+// Getter: Returns the seed this run's generators were derived from
+uint64_t LoadGenerator::getSeed() const {
+    return seed_;
+}
+
+// Statistics: Returns the number of messages sent
+uint64_t LoadGenerator::getTotalProduced() const {
+    return totalProduced_.load();
+}
+
+// Statistics: Returns the number of messages received by all consumers
+uint64_t LoadGenerator::getTotalConsumed() const {
+    uint64_t total = 0;
+    for (const auto& consumed : consumedPerConsumer_) {
+        total += consumed.load();
+    }
+    return total;
+}
+
+// Statistics: Returns counts, per-partition appends and lag so far
+LoadGeneratorReport LoadGenerator::getReport() const {
+    LoadGeneratorReport report;
+    report.seed = seed_;
+    {
+        std::lock_guard<std::mutex> lock(reportMutex_);
+        if (startTime_ != std::chrono::steady_clock::time_point()) {
+            auto end = (stopTime_ > startTime_) ? stopTime_ : std::chrono::steady_clock::now();
+            report.elapsedSeconds = std::chrono::duration<double>(end - startTime_).count();
+        }
+    }
+    report.produced = totalProduced_.load();
+    report.producedBytes = totalProducedBytes_.load();
+    for (const auto& consumed : consumedPerConsumer_) {
+        report.consumedPerConsumer.push_back(consumed.load());
+        report.consumed += consumed.load();
+    }
+
+    uint64_t appended = 0;
+    uint64_t hottest = 0;
+    for (size_t partition = 0; partition < config_.partitions; ++partition) {
+        uint64_t logEnd = broker_.getLogEndOffset(config_.topicName, partition);
+        report.appendedPerPartition.push_back(logEnd);
+        report.lagPerPartition.push_back(logEnd - std::min(logEnd, positions_[partition].load()));
+        appended += logEnd;
+        hottest = std::max(hottest, logEnd);
+    }
+    report.hottestPartitionShare = appended > 0 ? static_cast<double>(hottest) / static_cast<double>(appended) : 0.0;
+    return report;
+}
+
+// Background: Sends keyed messages paced to this producer's share of the scheduled rate.
+// When it falls behind by more than 100ms it resumes from now instead of catching up.
+void LoadGenerator::producerThread(size_t index) {
+    std::seed_seq seedSequence{seed_, static_cast<uint64_t>(index)};
+    std::mt19937_64 rng(seedSequence);
+    Producer producer(broker_);
+
+    std::string payload(config_.payloadSizes.getMaxBytes(), '\0');
+    for (char& c : payload) {
+        c = static_cast<char>('a' + rng() % 26);
+    }
+
+    auto next = std::chrono::steady_clock::now();
+    while (running_.load()) {
+        double elapsed = elapsedSeconds();
+        if (elapsed >= std::chrono::duration<double>(config_.duration).count()) {
+            break;
+        }
+
+        double rate = config_.rate.rateAt(elapsed) / static_cast<double>(config_.producers);
+        auto now = std::chrono::steady_clock::now();
+        if (rate <= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            next = std::chrono::steady_clock::now();
+            continue;
+        }
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / rate));
+        if (next > now) {
+            std::this_thread::sleep_until(next);
+        } else if (now - next > std::chrono::milliseconds(100)) {
+            next = now;
+        }
+
+        std::string key = "key-" + std::to_string(config_.keys.next(rng));
+        size_t size = config_.payloadSizes.next(rng);
+        producer.send(config_.topicName, key, std::string(payload.data(), size));
+        totalProduced_.fetch_add(1, std::memory_order_relaxed);
+        totalProducedBytes_.fetch_add(key.size() + size, std::memory_order_relaxed);
+    }
+    activeProducers_.fetch_sub(1);
+}
+
+// Background: Polls this consumer's share of the partitions; slow consumers sleep
+// slowConsumerDelay per record to build up lag on their partitions
+void LoadGenerator::consumerThread(size_t index) {
+    std::vector<uint32_t> assigned;
+    for (size_t partition = index; partition < config_.partitions; partition += config_.consumers) {
+        assigned.push_back(static_cast<uint32_t>(partition));
+    }
+    if (assigned.empty()) {
+        return;
+    }
+
+    Consumer consumer(broker_, config_.topicName);
+    consumer.assign(assigned);
+    for (uint32_t partition : assigned) {
+        consumer.seek(partition, positions_[partition].load());
+    }
+    bool slow = index >= config_.consumers - config_.slowConsumers;
+
+    while (running_.load() && elapsedSeconds() < std::chrono::duration<double>(config_.duration).count()) {
+        ConsumerRecords records = consumer.poll(500, 1 << 20, std::chrono::milliseconds(100));
+        for (const auto& [partition, messages] : records) {
+            if (!messages.empty()) {
+                positions_[partition].store(messages.back().getOffset() + 1);
+            }
+        }
+        consumedPerConsumer_[index].fetch_add(records.count(), std::memory_order_relaxed);
+        if (slow && records.count() > 0) {
+            auto delay = config_.slowConsumerDelay * static_cast<int64_t>(records.count());
+            std::chrono::steady_clock::time_point wake = std::chrono::steady_clock::now() + delay;
+            std::chrono::steady_clock::time_point end = startTime_ + config_.duration;
+            std::this_thread::sleep_until(std::min(wake, end)); // Never past the end of the run
+        }
+    }
+}
+
+// Internal: Returns seconds since start (startTime_ is fixed before any thread runs)
+double LoadGenerator::elapsedSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+}
@@ -5,21 +5,24 @@ Message::Message(std::string key, std::string value):
         offset_(0),
         key_(std::move(key)),
         value_(std::move(value)),
-        timestamp_(std::chrono::system_clock::now()) {}
+        timestamp_(std::chrono::system_clock::now()),
+        traceId_(0) {}
 
 // Constructor: Creates a message with specified offset
 Message::Message(std::string key, std::string value, uint64_t offset):
         offset_(offset),
         key_(std::move(key)),
         value_(std::move(value)),
-        timestamp_(std::chrono::system_clock::now()) {}
+        timestamp_(std::chrono::system_clock::now()),
+        traceId_(0) {}
 
 // Constructor: Creates a message with specified offset and timestamp
 Message::Message(std::string key, std::string value, uint64_t offset, std::chrono::system_clock::time_point timestamp):
         offset_(offset),
         key_(std::move(key)),
         value_(std::move(value)),
-        timestamp_(timestamp) {}
+        timestamp_(timestamp),
+        traceId_(0) {}
 
 // Getter: Returns the unique offset of this message in the partition
 uint64_t Message::getOffset() const {
@@ -41,6 +44,26 @@ std::chrono::system_clock::time_point Message::getTimestamp() const {
     return timestamp_;
 }
 
+// Getter: Returns the payload size (key + value) in bytes
+size_t Message::getSizeBytes() const {
+    return key_.size() + value_.size();
+}
+
+// Getter: Returns the trace id (0 when the message is not traced)
+uint64_t Message::getTraceId() const {
+    return traceId_;
+}
+
+// Setter: Marks the message as traced under traceId
+void Message::setTraceId(uint64_t traceId) {
+    traceId_ = traceId;
+}
+
+// Setter: Assigns the message's offset in its partition
+void Message::setOffset(uint64_t offset) {
+    offset_ = offset;
+}
+
 // Utility: Converts message to string representation for debugging
 std::string Message::toString() const {
     std::ostringstream oss;
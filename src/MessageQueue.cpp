@@ -1,4 +1,5 @@
 #include "MessageQueue.h"
+#include "Tracer.h"
 
 // Constructor: Initializes the message queue
 MessageQueue::MessageQueue() : shutdown_(false) {}
@@ -9,40 +10,66 @@ MessageQueue::~MessageQueue() {
 }
 
 // Producer: Adds a message to the queue (copy version)
-void MessageQueue::push(const Message& message) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!shutdown_.load()) {
-        queue_.push(message);
-        cv_.notify_one();
+bool MessageQueue::push(const Message& message) {
+    TraceSpan span(message.getTraceId(), "queue.push");
+    std::lock_guard lock(mutex_);
+    if (shutdown_.load()) {
+        return false;
     }
+    queue_.push(QueuedMessage{message, std::chrono::steady_clock::now(), nullptr, enqueueTicks(message)});
+    cv_.notify_one();
+    return true;
 }
 
 // Producer: Adds a message to the queue (move version)
-void MessageQueue::push(Message&& message) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!shutdown_.load()) {
-        queue_.push(std::move(message));
-        cv_.notify_one();
+bool MessageQueue::push(Message&& message) {
+    TraceSpan span(message.getTraceId(), "queue.push");
+    std::lock_guard lock(mutex_);
+    if (shutdown_.load()) {
+        return false;
+    }
+    uint64_t ticks = enqueueTicks(message);
+    queue_.push(QueuedMessage{std::move(message), std::chrono::steady_clock::now(), nullptr, ticks});
+    cv_.notify_one();
+    return true;
+}
+
+// Producer: Adds a message with a callback invoked once the message is written (or fails).
+// On a shut-down queue the callback is invoked right away with the error.
+bool MessageQueue::push(Message&& message, std::function<void(std::exception_ptr)> onAppended) {
+    TraceSpan span(message.getTraceId(), "queue.push");
+    {
+        std::lock_guard lock(mutex_);
+        if (!shutdown_.load()) {
+            uint64_t ticks = enqueueTicks(message);
+            queue_.push(QueuedMessage{std::move(message), std::chrono::steady_clock::now(), std::move(onAppended), ticks});
+            cv_.notify_one();
+            return true;
+        }
+    }
+    if (onAppended) {
+        onAppended(std::make_exception_ptr(std::runtime_error("MessageQueue is shutdown")));
     }
+    return false;
 }
 
 // Consumer: Blocks until a message is available and returns it
 Message MessageQueue::pop() {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock lock(mutex_);
     cv_.wait(lock, [this] { return !queue_.empty() || shutdown_.load(); });
     
     if (shutdown_.load() && queue_.empty()) {
         throw std::runtime_error("MessageQueue is shutdown and empty");
     }
     
-    Message message = std::move(queue_.front());
+    Message message = std::move(queue_.front().message);
     queue_.pop();
     return message;
 }
 
 // Consumer: Tries to pop a message with timeout
 bool MessageQueue::tryPop(Message& message, std::chrono::milliseconds timeout) {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock lock(mutex_);
     bool result = cv_.wait_for(lock, timeout, [this] { 
         return !queue_.empty() || shutdown_.load(); 
     });
@@ -51,26 +78,54 @@ bool MessageQueue::tryPop(Message& message, std::chrono::milliseconds timeout) {
         return false;
     }
     
-    message = std::move(queue_.front());
+    message = std::move(queue_.front().message);
     queue_.pop();
     return true;
 }
 
+// Consumer: Pops the front entry (message, enqueue time, callback) without waiting
+bool MessageQueue::tryPopFront(QueuedMessage& entry) {
+    std::lock_guard lock(mutex_);
+    if (queue_.empty()) {
+        return false;
+    }
+
+    entry = std::move(queue_.front());
+    queue_.pop();
+    return true;
+}
+
+// Consumer: Peeks at the payload size of the front message without removing it
+bool MessageQueue::frontSize(uint64_t& sizeBytes) const {
+    std::lock_guard lock(mutex_);
+    if (queue_.empty()) {
+        return false;
+    }
+
+    sizeBytes = queue_.front().message.getSizeBytes();
+    return true;
+}
+
 // Utility: Returns current queue size
 size_t MessageQueue::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
     return queue_.size();
 }
 
 // Utility: Checks if queue is empty
 bool MessageQueue::empty() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
     return queue_.empty();
 }
 
 // Management: Shuts down the queue
 void MessageQueue::shutdown() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
     shutdown_.store(true);
     cv_.notify_all();
 }
+
+// Helper: Returns the enqueue timestamp of a traced message (0 for untraced ones)
+uint64_t MessageQueue::enqueueTicks(const Message& message) {
+    return message.getTraceId() != 0 ? Tracer::now() : 0;
+}
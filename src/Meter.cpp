@@ -0,0 +1,132 @@
+#include "Meter.h"
+
+#include <cmath>
+
+namespace {
+
+// Per-tick smoothing factors for 1, 5 and 15 minute windows
+const std::array<double, 3> kAlphas = {
+    1.0 - std::exp(-1.0 / 60.0),
+    1.0 - std::exp(-1.0 / 300.0),
+    1.0 - std::exp(-1.0 / 900.0)
+};
+
+} // namespace
+
+// Constructor: Starts the first tick interval now
+Meter::Meter() :
+    startNs_(toNs(Clock::now())),
+    lastTickNs_(startNs_.load()),
+    countAtLastTick_(0),
+    instantRate_(0.0),
+    initialized_(false) {
+    for (auto& rate : rates_) {
+        rate.store(0.0);
+    }
+}
+
+// Hot path: Records count events
+void Meter::mark(uint64_t count) {
+    mark(count, Clock::now());
+}
+
+// Hot path: Records count events observed at 'now'
+void Meter::mark(uint64_t count, Clock::time_point now) {
+    tickIfNecessary(toNs(now));
+    count_.add(count);
+}
+
+// Reads: Returns the number of events since creation or reset
+uint64_t Meter::getCount() const {
+    return count_.load();
+}
+
+// Reads: Returns the count and rates, catching up on ticks that passed without marks
+MeterRates Meter::getRates() const {
+    int64_t nowNs = toNs(Clock::now());
+    tickIfNecessary(nowNs);
+
+    MeterRates result;
+    result.count = count_.load();
+    result.instantRate = instantRate_.load(std::memory_order_relaxed);
+    double elapsedSeconds = static_cast<double>(nowNs - startNs_.load(std::memory_order_relaxed)) / 1e9;
+    result.meanRate = elapsedSeconds > 0 ? static_cast<double>(result.count) / elapsedSeconds : 0.0;
+    result.oneMinuteRate = rates_[0].load(std::memory_order_relaxed);
+    result.fiveMinuteRate = rates_[1].load(std::memory_order_relaxed);
+    result.fifteenMinuteRate = rates_[2].load(std::memory_order_relaxed);
+    return result;
+}
+
+// Reads: Zeroes the count and the rates (marks racing with the reset may survive it)
+void Meter::reset() {
+    int64_t nowNs = toNs(Clock::now());
+    count_.reset();
+    startNs_.store(nowNs);
+    lastTickNs_.store(nowNs);
+    countAtLastTick_.store(0);
+    instantRate_.store(0.0);
+    for (auto& rate : rates_) {
+        rate.store(0.0);
+    }
+    initialized_.store(false);
+}
+
+// Helper: Folds the events of every elapsed tick into the averages. Only the thread whose
+// compare-and-swap moves lastTickNs_ forward does the work; the others return at once.
+// Events of the first elapsed tick are attributed to it and any further ticks count as idle.
+void Meter::tickIfNecessary(int64_t nowNs) const {
+    const int64_t intervalNs = std::chrono::nanoseconds(kTickInterval).count();
+    int64_t lastTick = lastTickNs_.load(std::memory_order_relaxed);
+    if (nowNs - lastTick < intervalNs) {
+        return;
+    }
+
+    int64_t ticks = (nowNs - lastTick) / intervalNs;
+    if (!lastTickNs_.compare_exchange_strong(lastTick, lastTick + ticks * intervalNs, std::memory_order_relaxed)) {
+        return;
+    }
+
+    uint64_t count = count_.load();
+    uint64_t previous = countAtLastTick_.exchange(count, std::memory_order_relaxed);
+    double instant = static_cast<double>(count >= previous ? count - previous : 0) /
+                     std::chrono::duration<double>(kTickInterval).count();
+    instantRate_.store(ticks == 1 ? instant : 0.0, std::memory_order_relaxed);
+
+    bool initialized = initialized_.exchange(true, std::memory_order_relaxed);
+    for (size_t i = 0; i < kWindows; ++i) {
+        double rate = initialized ? rates_[i].load(std::memory_order_relaxed) + kAlphas[i] *
+                                    (instant - rates_[i].load(std::memory_order_relaxed)) : instant;
+        rate *= std::pow(1.0 - kAlphas[i], static_cast<double>(ticks - 1));
+        rates_[i].store(rate, std::memory_order_relaxed);
+    }
+}
+
+// Helper: Converts a steady clock time point to nanoseconds
+int64_t Meter::toNs(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+// Throughput: Records messages and bytes written
+void ThroughputMeters::markIn(uint64_t messages, uint64_t bytes, Meter::Clock::time_point now) {
+    messagesIn.mark(messages, now);
+    bytesIn.mark(bytes, now);
+}
+
+// Throughput: Records messages and bytes read
+void ThroughputMeters::markOut(uint64_t messages, uint64_t bytes, Meter::Clock::time_point now) {
+    messagesOut.mark(messages, now);
+    bytesOut.mark(bytes, now);
+}
+
+// Throughput: Returns the rates of all four meters
+ThroughputRates ThroughputMeters::getRates() const {
+    return ThroughputRates{messagesIn.getRates(), bytesIn.getRates(), messagesOut.getRates(), bytesOut.getRates()};
+}
+
+// Throughput: Zeroes all four meters
+void ThroughputMeters::reset() {
+    messagesIn.reset();
+    bytesIn.reset();
+    messagesOut.reset();
+    bytesOut.reset();
+}
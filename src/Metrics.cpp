@@ -9,46 +9,154 @@ Metrics& Metrics::getInstance() {
     return instance;
 }
 
+// Constructor: Starts the background logger
+Metrics::Metrics() {
+    logger_.start();
+}
+
+// Destructor: Writes pending log records
+Metrics::~Metrics() {
+    logger_.stop();
+    logger_.join();
+}
+
+// Registry: Finds a registry entry under the shared lock, creating it under the exclusive lock
+template <typename T>
+T& Metrics::resolve(std::unordered_map<std::string, std::unique_ptr<T>>& registry, std::shared_mutex& mutex,
+                    const std::string& name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = registry.find(name);
+        if (it != registry.end()) {
+            return *it->second;
+        }
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto& entry = registry[name];
+    if (!entry) {
+        entry = std::make_unique<T>();
+    }
+    return *entry;
+}
+
 // Message counters: Increment sent messages counter
 void Metrics::incrementMessagesSent() {
-    messagesSent_.fetch_add(1);
-    logDebug("Message sent (total: " + std::to_string(messagesSent_.load()) + ")");
+    messagesSent_.add();
+    SK_LOG_DEBUG("Message sent (total: " + std::to_string(messagesSent_.load()) + ")");
 }
 
 // Message counters: Increment received messages counter
 void Metrics::incrementMessagesReceived() {
-    messagesReceived_.fetch_add(1);
-    logDebug("Message received (total: " + std::to_string(messagesReceived_.load()) + ")");
+    messagesReceived_.add();
+    SK_LOG_DEBUG("Message received (total: " + std::to_string(messagesReceived_.load()) + ")");
 }
 
 // Message counters: Increment processed messages counter
 void Metrics::incrementMessagesProcessed() {
-    messagesProcessed_.fetch_add(1);
-    logDebug("Message processed (total: " + std::to_string(messagesProcessed_.load()) + ")");
+    messagesProcessed_.add();
+    SK_LOG_DEBUG("Message processed (total: " + std::to_string(messagesProcessed_.load()) + ")");
 }
 
 // Message counters: Increment dropped messages counter
 void Metrics::incrementMessagesDropped() {
-    messagesDropped_.fetch_add(1);
-    logWarn("Message dropped (total: " + std::to_string(messagesDropped_.load()) + ")");
+    messagesDropped_.add();
+    SK_LOG_WARN("Message dropped (total: " + std::to_string(messagesDropped_.load()) + ")");
+}
+
+// Registry: Returns the metrics of a topic, creating them on first use
+Metrics::TopicMetrics& Metrics::topicMetrics(const std::string& topicName) {
+    return resolve(topics_, registryMutex_, topicName);
+}
+
+// Registry: Returns the metrics of a scheduling class, creating them on first use
+Metrics::SchedulingClassMetrics& Metrics::schedulingClassMetrics(const std::string& className) {
+    return resolve(schedulingClasses_, registryMutex_, className);
+}
+
+// Registry: Returns a named counter, creating it on first use
+ShardedCounter& Metrics::counter(const std::string& name) {
+    return resolve(counters_, registryMutex_, name);
+}
+
+// Registry: Returns the value of a named counter (0 when it was never created)
+uint64_t Metrics::getCounter(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    auto it = counters_.find(name);
+    return (it != counters_.end()) ? it->second->load() : 0;
+}
+
+// Registry: Returns the contention statistics of a lock site
+LockSiteMetrics& Metrics::lockSiteMetrics(const std::string& site) {
+    return resolve(lockSites_, registryMutex_, site);
 }
 
 // Queue metrics: Update queue size for specific topic
 void Metrics::updateQueueSize(const std::string& topicName, size_t size) {
-    std::lock_guard<std::mutex> lock(queueMetricsMutex_);
-    queueSizes_[topicName].store(size);
-    logDebug("Queue size updated for topic " + topicName + ": " + std::to_string(size));
+    updateQueueSize(topicMetrics(topicName), size);
+}
+
+// Queue metrics: Update queue size through a resolved handle
+void Metrics::updateQueueSize(TopicMetrics& topic, size_t size) {
+    topic.queueSize.store(size, std::memory_order_relaxed);
+    SK_LOG_DEBUG("Queue size updated: " + std::to_string(size));
 }
 
 // Queue metrics: Record processing time for specific topic
-void Metrics::recordProcessingTime(const std::string& topicName, std::chrono::milliseconds time) {
-    std::lock_guard<std::mutex> lock(queueMetricsMutex_);
-    
-    double timeMs = static_cast<double>(time.count());
-    totalProcessingTime_[topicName].fetch_add(timeMs);
-    processingCount_[topicName].fetch_add(1);
+void Metrics::recordProcessingTime(const std::string& topicName, std::chrono::nanoseconds time) {
+    recordProcessingTime(topicMetrics(topicName), time);
+}
+
+// Queue metrics: Record processing time through a resolved handle
+void Metrics::recordProcessingTime(TopicMetrics& topic, std::chrono::nanoseconds time) {
+    topic.processingTimeNs.add(static_cast<uint64_t>(std::max<int64_t>(time.count(), 0)));
+    topic.processingCount.add();
+    topic.appendDuration.record(time);
+    SK_LOG_DEBUG("Processing time: " + std::to_string(time.count()) + "ns");
+}
+
+// Latency histograms: Record the time from enqueue in the async writer to the completed append
+void Metrics::recordEnqueueToAppend(TopicMetrics& topic, std::chrono::nanoseconds latency) {
+    topic.enqueueToAppend.record(latency);
+}
+
+// Latency histograms: Record the time from a message's timestamp to its delivery to a consumer
+void Metrics::recordEndToEnd(TopicMetrics& topic, std::chrono::nanoseconds latency) {
+    topic.endToEnd.record(latency);
+}
+
+// Throughput meters: Record messages and bytes appended to a topic
+void Metrics::recordMessagesIn(TopicMetrics& topic, uint64_t messages, uint64_t bytes) {
+    topic.throughput.markIn(messages, bytes);
+}
+
+// Throughput meters: Record messages and bytes fetched from a topic
+void Metrics::recordMessagesOut(TopicMetrics& topic, uint64_t messages, uint64_t bytes) {
+    topic.throughput.markOut(messages, bytes);
+}
+
+// Scheduling metrics: Record how long a message waited in its writer lane
+void Metrics::recordQueueDelay(const std::string& className, std::chrono::microseconds delay) {
+    recordQueueDelay(schedulingClassMetrics(className), delay);
+}
+
+// Scheduling metrics: Record a queue delay through a resolved handle
+void Metrics::recordQueueDelay(SchedulingClassMetrics& schedulingClass, std::chrono::microseconds delay) {
+    uint64_t delayUs = static_cast<uint64_t>(delay.count());
+    schedulingClass.totalDelayUs.add(delayUs);
+    schedulingClass.delayCount.add();
     
-    logDebug("Processing time for topic " + topicName + ": " + std::to_string(timeMs) + "ms");
+    // The shared maximum is only written when it grows
+    uint64_t maxDelay = schedulingClass.maxDelayUs.load(std::memory_order_relaxed);
+    while (delayUs > maxDelay &&
+           !schedulingClass.maxDelayUs.compare_exchange_weak(maxDelay, delayUs, std::memory_order_relaxed)) {
+    }
+}
+
+// Lag metrics: Sets the last observed lag of a group on a topic
+void Metrics::updateConsumerLag(const std::string& groupId, const std::string& topicName, uint64_t lag) {
+    std::lock_guard lock(lagMutex_);
+    consumerLag_[{groupId, topicName}].store(lag);
 }
 
 // Getters: Get total sent messages count
@@ -73,26 +181,115 @@ uint64_t Metrics::getMessagesDropped() const {
 
 // Getters: Get queue size for specific topic
 size_t Metrics::getQueueSize(const std::string& topicName) const {
-    std::lock_guard<std::mutex> lock(queueMetricsMutex_);
-    auto it = queueSizes_.find(topicName);
-    return (it != queueSizes_.end()) ? it->second.load() : 0;
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    auto it = topics_.find(topicName);
+    return (it != topics_.end()) ? it->second->queueSize.load() : 0;
 }
 
 // Getters: Get average processing time for specific topic
 double Metrics::getAverageProcessingTime(const std::string& topicName) const {
-    std::lock_guard<std::mutex> lock(queueMetricsMutex_);
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    
+    auto it = topics_.find(topicName);
+    if (it == topics_.end()) {
+        return 0.0;
+    }
     
-    auto timeIt = totalProcessingTime_.find(topicName);
-    auto countIt = processingCount_.find(topicName);
+    uint64_t count = it->second->processingCount.load();
+    if (count == 0) return 0.0;
+    
+    return static_cast<double>(it->second->processingTimeNs.load()) / 1e6 / count;
+}
+
+// Getters: Get append duration percentiles for specific topic
+LatencySnapshot Metrics::getAppendLatency(const std::string& topicName) const {
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    auto it = topics_.find(topicName);
+    return (it != topics_.end()) ? it->second->appendDuration.snapshot() : LatencySnapshot{};
+}
+
+// Getters: Get enqueue-to-append latency percentiles for specific topic
+LatencySnapshot Metrics::getEnqueueToAppendLatency(const std::string& topicName) const {
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    auto it = topics_.find(topicName);
+    return (it != topics_.end()) ? it->second->enqueueToAppend.snapshot() : LatencySnapshot{};
+}
+
+// Getters: Get produce-to-consume latency percentiles for specific topic
+LatencySnapshot Metrics::getEndToEndLatency(const std::string& topicName) const {
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    auto it = topics_.find(topicName);
+    return (it != topics_.end()) ? it->second->endToEnd.snapshot() : LatencySnapshot{};
+}
+
+// Getter: Returns the messages and bytes in/out rates of a topic
+ThroughputRates Metrics::getTopicThroughput(const std::string& topicName) const {
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    auto it = topics_.find(topicName);
+    return (it != topics_.end()) ? it->second->throughput.getRates() : ThroughputRates{};
+}
+
+// Getters: Get average queue delay (microseconds) for specific scheduling class
+double Metrics::getAverageQueueDelay(const std::string& className) const {
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
     
-    if (timeIt == totalProcessingTime_.end() || countIt == processingCount_.end()) {
+    auto it = schedulingClasses_.find(className);
+    if (it == schedulingClasses_.end()) {
         return 0.0;
     }
     
-    uint64_t count = countIt->second.load();
+    uint64_t count = it->second->delayCount.load();
     if (count == 0) return 0.0;
     
-    return timeIt->second.load() / count;
+    return static_cast<double>(it->second->totalDelayUs.load()) / count;
+}
+
+// Getters: Get maximum queue delay (microseconds) for specific scheduling class
+uint64_t Metrics::getMaxQueueDelay(const std::string& className) const {
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    auto it = schedulingClasses_.find(className);
+    return (it != schedulingClasses_.end()) ? it->second->maxDelayUs.load() : 0;
+}
+
+// Lag metrics: Returns the lag gauge of a group on a topic, creating it on first use
+std::atomic<uint64_t>& Metrics::consumerLagGauge(const std::string& groupId, const std::string& topicName) {
+    std::lock_guard lock(lagMutex_);
+    return consumerLag_[{groupId, topicName}];
+}
+
+// Getters: Get the last observed lag of a group on a topic
+uint64_t Metrics::getConsumerLag(const std::string& groupId, const std::string& topicName) const {
+    std::lock_guard lock(lagMutex_);
+    auto it = consumerLag_.find({groupId, topicName});
+    return (it != consumerLag_.end()) ? it->second.load() : 0;
+}
+
+// Getter: Returns the number of times a lock site was acquired
+uint64_t Metrics::getLockAcquisitions(const std::string& site) const {
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    auto it = lockSites_.find(site);
+    return (it != lockSites_.end()) ? it->second->acquisitions.load() : 0;
+}
+
+// Getter: Returns the number of acquisitions of a lock site that had to wait
+uint64_t Metrics::getLockContended(const std::string& site) const {
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    auto it = lockSites_.find(site);
+    return (it != lockSites_.end()) ? it->second->contended.load() : 0;
+}
+
+// Getter: Returns the wait time distribution of contended acquisitions of a lock site
+LatencySnapshot Metrics::getLockWaitTime(const std::string& site) const {
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    auto it = lockSites_.find(site);
+    return (it != lockSites_.end()) ? it->second->waitTime.snapshot() : LatencySnapshot{};
+}
+
+// Getter: Returns the hold time distribution of a lock site
+LatencySnapshot Metrics::getLockHoldTime(const std::string& site) const {
+    std::shared_lock<std::shared_mutex> lock(registryMutex_);
+    auto it = lockSites_.find(site);
+    return (it != lockSites_.end()) ? it->second->holdTime.snapshot() : LatencySnapshot{};
 }
 
 // Logging: Set log level
@@ -101,12 +298,10 @@ void Metrics::setLogLevel(LogLevel level) {
     logInfo("Log level set to " + logLevelToString(level));
 }
 
-// Logging: Main logging method
+// Logging: Main logging method (queued for the background logger)
 void Metrics::log(LogLevel level, const std::string& message) {
-    if (level >= logLevel_.load()) {
-        std::cout << "[" << getCurrentTime() << "] "
-                  << "[" << logLevelToString(level) << "] "
-                  << message << std::endl;
+    if (isLogEnabled(level)) {
+        logger_.log(level, message);
     }
 }
 
@@ -130,6 +325,84 @@ void Metrics::logDebug(const std::string& message) {
     log(LogLevel::DEBUG, message);
 }
 
+// Logging: Returns the background logger (for SK_LOGF)
+AsyncLogger& Metrics::getLogger() {
+    return logger_;
+}
+
+// Logging: Waits until everything logged so far is written
+void Metrics::flushLogs() {
+    logger_.flush();
+}
+
+// Export: Takes a snapshot of every process-wide metric
+MetricsSnapshot Metrics::snapshot() const {
+    MetricsSnapshot result;
+    collect(result);
+    return result;
+}
+
+// Export: Adds every process-wide metric to a snapshot
+void Metrics::collect(MetricsSnapshot& snapshot) const {
+    snapshot.addCounter("selfkafka_messages_sent_total", {}, static_cast<double>(messagesSent_.load()));
+    snapshot.addCounter("selfkafka_messages_received_total", {}, static_cast<double>(messagesReceived_.load()));
+    snapshot.addCounter("selfkafka_messages_processed_total", {}, static_cast<double>(messagesProcessed_.load()));
+    snapshot.addCounter("selfkafka_messages_dropped_total", {}, static_cast<double>(messagesDropped_.load()));
+    
+    {
+        std::shared_lock<std::shared_mutex> lock(registryMutex_);
+        for (const auto& [topicName, topic] : topics_) {
+            MetricLabels labels{{"topic", topicName}};
+            snapshot.addGauge("selfkafka_topic_queue_size", labels, static_cast<double>(topic->queueSize.load()));
+            snapshot.addCounter("selfkafka_topic_processing_seconds_total", labels,
+                                static_cast<double>(topic->processingTimeNs.load()) / 1e9);
+            snapshot.addCounter("selfkafka_topic_processing_total", labels,
+                                static_cast<double>(topic->processingCount.load()));
+            snapshot.addHistogram("selfkafka_topic_append_seconds", labels, topic->appendDuration.snapshot());
+            snapshot.addHistogram("selfkafka_topic_enqueue_to_append_seconds", labels,
+                                  topic->enqueueToAppend.snapshot());
+            snapshot.addHistogram("selfkafka_topic_end_to_end_seconds", labels, topic->endToEnd.snapshot());
+            snapshot.addThroughput("selfkafka_topic", labels, topic->throughput.getRates());
+        }
+        for (const auto& [className, schedulingClass] : schedulingClasses_) {
+            MetricLabels labels{{"class", className}};
+            snapshot.addCounter("selfkafka_scheduling_queue_delay_seconds_total", labels,
+                                static_cast<double>(schedulingClass->totalDelayUs.load()) / 1e6);
+            snapshot.addCounter("selfkafka_scheduling_queue_delay_total", labels,
+                                static_cast<double>(schedulingClass->delayCount.load()));
+            snapshot.addGauge("selfkafka_scheduling_queue_delay_max_seconds", labels,
+                              static_cast<double>(schedulingClass->maxDelayUs.load()) / 1e6);
+        }
+        for (const auto& [name, counter] : counters_) {
+            snapshot.addCounter("selfkafka_counter_total", {{"name", name}}, static_cast<double>(counter->load()));
+        }
+        for (const auto& [site, lockSite] : lockSites_) {
+            MetricLabels labels{{"site", site}};
+            snapshot.addCounter("selfkafka_lock_acquisitions_total", labels,
+                                static_cast<double>(lockSite->acquisitions.load()));
+            snapshot.addCounter("selfkafka_lock_contended_total", labels,
+                                static_cast<double>(lockSite->contended.load()));
+            snapshot.addHistogram("selfkafka_lock_wait_seconds", labels, lockSite->waitTime.snapshot());
+            snapshot.addHistogram("selfkafka_lock_hold_seconds", labels, lockSite->holdTime.snapshot());
+        }
+    }
+    
+    {
+        std::lock_guard lock(lagMutex_);
+        for (const auto& [groupTopic, lag] : consumerLag_) {
+            snapshot.addGauge("selfkafka_consumer_lag", {{"group", groupTopic.first}, {"topic", groupTopic.second}},
+                              static_cast<double>(lag.load()));
+        }
+    }
+    
+    snapshot.addCounter("selfkafka_log_records_written_total", {}, static_cast<double>(logger_.getTotalWritten()));
+    snapshot.addCounter("selfkafka_log_records_dropped_total", {}, static_cast<double>(logger_.getTotalDropped()));
+    snapshot.addCounter("selfkafka_log_records_suppressed_total", {},
+                        static_cast<double>(logger_.getTotalSuppressed()));
+    snapshot.addCounter("selfkafka_log_records_truncated_total", {},
+                        static_cast<double>(logger_.getTotalTruncated()));
+}
+
 // Statistics: Print all metrics
 void Metrics::printStatistics() const {
     std::cout << "\n=== SelfKafka Metrics ===" << std::endl;
@@ -138,24 +411,84 @@ void Metrics::printStatistics() const {
     std::cout << "Messages Processed: " << messagesProcessed_.load() << std::endl;
     std::cout << "Messages Dropped: " << messagesDropped_.load() << std::endl;
     
-    std::lock_guard<std::mutex> lock(queueMetricsMutex_);
-    if (!queueSizes_.empty()) {
-        std::cout << "\nQueue Sizes:" << std::endl;
-        for (const auto& [topicName, size] : queueSizes_) {
-            std::cout << "  " << topicName << ": " << size.load() << " messages" << std::endl;
+    {
+        std::shared_lock<std::shared_mutex> lock(registryMutex_);
+        if (!topics_.empty()) {
+            std::cout << "\nQueue Sizes:" << std::endl;
+            for (const auto& [topicName, topic] : topics_) {
+                std::cout << "  " << topicName << ": " << topic->queueSize.load() << " messages" << std::endl;
+            }
+            
+            std::cout << "\nAverage Processing Times:" << std::endl;
+            for (const auto& [topicName, topic] : topics_) {
+                uint64_t count = topic->processingCount.load();
+                double avgTime = (count > 0) ? static_cast<double>(topic->processingTimeNs.load()) / 1e6 / count : 0.0;
+                std::cout << "  " << topicName << ": " << std::fixed << std::setprecision(2)
+                          << avgTime << "ms" << std::endl;
+            }
+            
+            std::cout << "\nLatency Percentiles (us, p50/p99/p999/max):" << std::endl;
+            auto printLatency = [](const std::string& label, const LatencySnapshot& latency) {
+                if (latency.count == 0) {
+                    return;
+                }
+                std::cout << "    " << label << ": " << std::fixed << std::setprecision(1)
+                          << latency.p50 / 1e3 << " / " << latency.p99 / 1e3 << " / "
+                          << latency.p999 / 1e3 << " / " << latency.max / 1e3
+                          << " (" << latency.count << " samples)" << std::endl;
+            };
+            for (const auto& [topicName, topic] : topics_) {
+                std::cout << "  " << topicName << ":" << std::endl;
+                printLatency("append", topic->appendDuration.snapshot());
+                printLatency("enqueue-to-append", topic->enqueueToAppend.snapshot());
+                printLatency("end-to-end", topic->endToEnd.snapshot());
+            }
+            
+            std::cout << "\nThroughput (1m rate, msgs/s and bytes/s in / out):" << std::endl;
+            for (const auto& [topicName, topic] : topics_) {
+                ThroughputRates rates = topic->throughput.getRates();
+                std::cout << "  " << topicName << ": " << std::fixed << std::setprecision(1)
+                          << rates.messagesIn.oneMinuteRate << " msgs/s, " << rates.bytesIn.oneMinuteRate
+                          << " B/s / " << rates.messagesOut.oneMinuteRate << " msgs/s, "
+                          << rates.bytesOut.oneMinuteRate << " B/s" << std::endl;
+            }
+        }
+        
+        if (!schedulingClasses_.empty()) {
+            std::cout << "\nQueue Delay by Scheduling Class:" << std::endl;
+            for (const auto& [className, schedulingClass] : schedulingClasses_) {
+                uint64_t count = schedulingClass->delayCount.load();
+                double avgDelay = (count > 0) ? static_cast<double>(schedulingClass->totalDelayUs.load()) / count : 0.0;
+                std::cout << "  " << className << ": avg " << std::fixed << std::setprecision(2)
+                          << avgDelay << "us, max " << schedulingClass->maxDelayUs.load() << "us" << std::endl;
+            }
+        }
+        
+        if (!lockSites_.empty()) {
+            std::cout << "\nLock Contention (acquisitions, contended, wait p99/max us, hold p99/max us):" << std::endl;
+            for (const auto& [site, lockSite] : lockSites_) {
+                LatencySnapshot wait = lockSite->waitTime.snapshot();
+                LatencySnapshot hold = lockSite->holdTime.snapshot();
+                std::cout << "  " << site << ": " << lockSite->acquisitions.load() << ", "
+                          << lockSite->contended.load() << ", " << std::fixed << std::setprecision(1)
+                          << wait.p99 / 1e3 << "/" << wait.max / 1e3 << ", "
+                          << hold.p99 / 1e3 << "/" << hold.max / 1e3 << std::endl;
+            }
+        }
+        
+        if (!counters_.empty()) {
+            std::cout << "\nCounters:" << std::endl;
+            for (const auto& [name, counter] : counters_) {
+                std::cout << "  " << name << ": " << counter->load() << std::endl;
+            }
         }
     }
     
-    if (!totalProcessingTime_.empty()) {
-        std::cout << "\nAverage Processing Times:" << std::endl;
-        for (const auto& [topicName, timeAtomic] : totalProcessingTime_) {
-            auto countIt = processingCount_.find(topicName);
-            if (countIt != processingCount_.end()) {
-                uint64_t count = countIt->second.load();
-                double avgTime = (count > 0) ? timeAtomic.load() / count : 0.0;
-                std::cout << "  " << topicName << ": " << std::fixed << std::setprecision(2) 
-                          << avgTime << "ms" << std::endl;
-            }
+    std::lock_guard lock(lagMutex_);
+    if (!consumerLag_.empty()) {
+        std::cout << "\nConsumer Lag:" << std::endl;
+        for (const auto& [groupTopic, lag] : consumerLag_) {
+            std::cout << "  " << groupTopic.first << "/" << groupTopic.second << ": " << lag.load() << " messages" << std::endl;
         }
     }
     std::cout << "========================\n" << std::endl;
@@ -163,30 +496,47 @@ void Metrics::printStatistics() const {
 
 // Statistics: Reset all metrics
 void Metrics::reset() {
-    messagesSent_.store(0);
-    messagesReceived_.store(0);
-    messagesProcessed_.store(0);
-    messagesDropped_.store(0);
+    messagesSent_.reset();
+    messagesReceived_.reset();
+    messagesProcessed_.reset();
+    messagesDropped_.reset();
     
-    std::lock_guard<std::mutex> lock(queueMetricsMutex_);
-    queueSizes_.clear();
-    totalProcessingTime_.clear();
-    processingCount_.clear();
+    {
+        // Handles may be held by hot paths, so entries are zeroed rather than removed
+        std::shared_lock<std::shared_mutex> lock(registryMutex_);
+        for (auto& [topicName, topic] : topics_) {
+            topic->queueSize.store(0);
+            topic->processingTimeNs.reset();
+            topic->processingCount.reset();
+            topic->appendDuration.reset();
+            topic->enqueueToAppend.reset();
+            topic->endToEnd.reset();
+            topic->throughput.reset();
+        }
+        for (auto& [className, schedulingClass] : schedulingClasses_) {
+            schedulingClass->totalDelayUs.reset();
+            schedulingClass->delayCount.reset();
+            schedulingClass->maxDelayUs.store(0);
+        }
+        for (auto& [name, counter] : counters_) {
+            counter->reset();
+        }
+        for (auto& [site, lockSite] : lockSites_) {
+            lockSite->acquisitions.reset();
+            lockSite->contended.reset();
+            lockSite->waitTime.reset();
+            lockSite->holdTime.reset();
+        }
+    }
     
-    logInfo("Metrics reset");
-}
-
-// Helper: Get current time as string
-std::string Metrics::getCurrentTime() const {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
+    {
+        std::lock_guard lock(lagMutex_);
+        for (auto& [groupTopic, lag] : consumerLag_) {
+            lag.store(0); // Kept, LagTracker holds the gauge handles
+        }
+    }
     
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return ss.str();
+    logInfo("Metrics reset");
 }
 
 // Helper: Convert log level to string
@@ -199,3 +549,8 @@ std::string Metrics::logLevelToString(LogLevel level) const {
         default: return "UNKNOWN";
     }
 }
+
+// Lock profiling: Resolves a ProfiledMutex site to its registry entry
+LockSiteMetrics& resolveLockSite(const char* site) {
+    return Metrics::getInstance().lockSiteMetrics(site);
+}
@@ -0,0 +1,191 @@
+#include "MetricsHttpServer.h"
+#include "Metrics.h"
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // Not available on every platform; SO_NOSIGPIPE is set on the socket there
+#endif
+
+// Constructor: Initializes the server without binding
+MetricsHttpServer::MetricsHttpServer(SnapshotProvider provider, uint16_t port) :
+    provider_(std::move(provider)),
+    port_(port),
+    listenFd_(-1),
+    running_(false),
+    totalRequests_(0) {}
+
+// Destructor: Stops the server thread and closes the socket
+MetricsHttpServer::~MetricsHttpServer() {
+    stop();
+    join();
+}
+
+// Lifecycle: Binds the loopback socket and starts the server thread
+void MetricsHttpServer::start() {
+    if (running_.load()) {
+        return;
+    }
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create metrics socket: " + std::string(std::strerror(errno)));
+    }
+    int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port_.load());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(fd, 16) < 0) {
+        std::string error = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("Failed to bind metrics endpoint on port " + std::to_string(port_.load()) +
+                                 ": " + error);
+    }
+
+    socklen_t length = sizeof(address);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    port_.store(ntohs(address.sin_port));
+    listenFd_ = fd;
+
+    running_.store(true);
+    serverThread_ = std::thread(&MetricsHttpServer::serverThread, this);
+    Metrics::getInstance().logInfo("Metrics endpoint listening on 127.0.0.1:" + std::to_string(port_.load()));
+}
+
+// Lifecycle: Signals the server thread to stop (it notices within one poll interval)
+void MetricsHttpServer::stop() {
+    running_.store(false);
+}
+
+// Lifecycle: Waits for the server thread to finish and closes the socket
+void MetricsHttpServer::join() {
+    if (serverThread_.joinable()) {
+        serverThread_.join();
+    }
+    if (listenFd_ >= 0) {
+        ::close(listenFd_);
+        listenFd_ = -1;
+    }
+}
+
+// Status: Returns the bound port
+uint16_t MetricsHttpServer::getPort() const {
+    return port_.load();
+}
+
+// Status: Check if the server thread is running
+bool MetricsHttpServer::isRunning() const {
+    return running_.load();
+}
+
+// Statistics: Returns the number of requests answered
+uint64_t MetricsHttpServer::getTotalRequests() const {
+    return totalRequests_.load();
+}
+
+// Core: Accepts connections, waking every 100ms to check for stop
+void MetricsHttpServer::serverThread() {
+    while (running_.load()) {
+        pollfd listener{listenFd_, POLLIN, 0};
+        if (::poll(&listener, 1, 100) <= 0) {
+            continue;
+        }
+
+        int clientFd = ::accept(listenFd_, nullptr, nullptr);
+        if (clientFd < 0) {
+            continue;
+        }
+        handleConnection(clientFd);
+        ::close(clientFd);
+    }
+}
+
+// Core: Reads one request and answers it
+void MetricsHttpServer::handleConnection(int clientFd) {
+    // A stalled client must not hold up the next scrape for long
+    timeval timeout{1, 0};
+    ::setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+    // A scraper that disconnects early must not raise SIGPIPE where send() lacks MSG_NOSIGNAL
+    int noSigpipe = 1;
+    ::setsockopt(clientFd, SOL_SOCKET, SO_NOSIGPIPE, &noSigpipe, sizeof(noSigpipe));
+#endif
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t received = ::recv(clientFd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    size_t lineEnd = request.find("\r\n");
+    std::string requestLine = request.substr(0, lineEnd);
+    size_t methodEnd = requestLine.find(' ');
+    size_t pathEnd = requestLine.find(' ', methodEnd == std::string::npos ? methodEnd : methodEnd + 1);
+    if (methodEnd == std::string::npos || pathEnd == std::string::npos) {
+        sendResponse(clientFd, "400 Bad Request", "text/plain", "Bad request\n");
+        return;
+    }
+
+    std::string method = requestLine.substr(0, methodEnd);
+    std::string path = requestLine.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+    path = path.substr(0, path.find('?'));
+    totalRequests_.fetch_add(1);
+
+    if (method != "GET") {
+        sendResponse(clientFd, "405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+        return;
+    }
+    if (path != "/metrics" && path != "/metrics.json") {
+        sendResponse(clientFd, "404 Not Found", "text/plain", "Try /metrics or /metrics.json\n");
+        return;
+    }
+
+    // The snapshot walks live broker state; a failure must not take the broker down
+    std::string body;
+    try {
+        body = (path == "/metrics") ? provider_().toPrometheus() : provider_().toJson();
+    } catch (const std::exception& e) {
+        Metrics::getInstance().logError("Metrics snapshot failed: " + std::string(e.what()));
+        sendResponse(clientFd, "500 Internal Server Error", "text/plain", "Metrics snapshot failed\n");
+        return;
+    }
+    if (path == "/metrics") {
+        sendResponse(clientFd, "200 OK", "text/plain; version=0.0.4; charset=utf-8", body);
+    } else {
+        sendResponse(clientFd, "200 OK", "application/json", body);
+    }
+}
+
+// Helper: Writes a complete response with Content-Length
+void MetricsHttpServer::sendResponse(int clientFd, const std::string& status, const std::string& contentType,
+                                     const std::string& body) {
+    std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: " + contentType +
+                           "\r\nContent-Length: " + std::to_string(body.size()) +
+                           "\r\nConnection: close\r\n\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t written = ::send(clientFd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(written);
+    }
+}
@@ -0,0 +1,234 @@
+#include "MetricsSnapshot.h"
+
+#include <map>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// Renders a number the way both formats accept it (integers without a fraction)
+std::string formatNumber(double value) {
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    char buffer[32];
+    if (value == std::floor(value) && std::fabs(value) < 1e15) {
+        std::snprintf(buffer, sizeof(buffer), "%.0f", value);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    }
+    return buffer;
+}
+
+// Escapes a Prometheus label value
+std::string escapeLabel(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// Escapes a JSON string
+std::string escapeJson(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    escaped += buffer;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+// Renders {a="x",b="y"} with optional extra label, or nothing when there are no labels
+std::string formatLabels(const MetricLabels& labels, const std::string& extraName = "",
+                         const std::string& extraValue = "") {
+    if (labels.empty() && extraName.empty()) {
+        return "";
+    }
+    std::string out = "{";
+    bool first = true;
+    for (const auto& [name, value] : labels) {
+        out += (first ? "" : ",") + name + "=\"" + escapeLabel(value) + "\"";
+        first = false;
+    }
+    if (!extraName.empty()) {
+        out += (first ? "" : ",") + extraName + "=\"" + escapeLabel(extraValue) + "\"";
+    }
+    return out + "}";
+}
+
+std::string formatJsonLabels(const MetricLabels& labels) {
+    std::string out = "{";
+    bool first = true;
+    for (const auto& [name, value] : labels) {
+        out += (first ? "\"" : ",\"") + escapeJson(name) + "\":\"" + escapeJson(value) + "\"";
+        first = false;
+    }
+    return out + "}";
+}
+
+} // namespace
+
+// Constructor: Stamps the snapshot with the collection time
+MetricsSnapshot::MetricsSnapshot() :
+    timestamp_(std::chrono::system_clock::now()) {}
+
+// Building: Adds a monotonically increasing value
+void MetricsSnapshot::addCounter(const std::string& name, MetricLabels labels, double value) {
+    samples_.push_back(MetricSample{name, MetricType::Counter, std::move(labels), value});
+}
+
+// Building: Adds a value that can go up and down
+void MetricsSnapshot::addGauge(const std::string& name, MetricLabels labels, double value) {
+    samples_.push_back(MetricSample{name, MetricType::Gauge, std::move(labels), value});
+}
+
+// Building: Adds latency percentiles
+void MetricsSnapshot::addHistogram(const std::string& name, MetricLabels labels, const LatencySnapshot& latency) {
+    histograms_.push_back(HistogramSample{name, std::move(labels), latency});
+}
+
+// Building: Adds a meter as name_total plus name_rate gauges labelled by window
+void MetricsSnapshot::addMeter(const std::string& name, const MetricLabels& labels, const MeterRates& rates) {
+    addCounter(name + "_total", labels, static_cast<double>(rates.count));
+
+    const std::pair<const char*, double> windows[] = {
+        {"instant", rates.instantRate}, {"1m", rates.oneMinuteRate}, {"5m", rates.fiveMinuteRate},
+        {"15m", rates.fifteenMinuteRate}, {"mean", rates.meanRate}
+    };
+    for (const auto& [window, rate] : windows) {
+        MetricLabels windowLabels = labels;
+        windowLabels.emplace_back("window", window);
+        addGauge(name + "_rate", std::move(windowLabels), rate);
+    }
+}
+
+// Building: Adds messages and bytes in and out as four meters under one prefix
+void MetricsSnapshot::addThroughput(const std::string& prefix, const MetricLabels& labels,
+                                    const ThroughputRates& rates) {
+    addMeter(prefix + "_messages_in", labels, rates.messagesIn);
+    addMeter(prefix + "_bytes_in", labels, rates.bytesIn);
+    addMeter(prefix + "_messages_out", labels, rates.messagesOut);
+    addMeter(prefix + "_bytes_out", labels, rates.bytesOut);
+}
+
+// Accessors: Returns the counter and gauge samples
+const std::vector<MetricSample>& MetricsSnapshot::getSamples() const {
+    return samples_;
+}
+
+// Accessors: Returns the latency samples
+const std::vector<HistogramSample>& MetricsSnapshot::getHistograms() const {
+    return histograms_;
+}
+
+// Accessors: Returns when the snapshot was taken
+std::chrono::system_clock::time_point MetricsSnapshot::getTimestamp() const {
+    return timestamp_;
+}
+
+// Accessors: Finds a sample by name and exact labels
+const MetricSample* MetricsSnapshot::find(const std::string& name, const MetricLabels& labels) const {
+    for (const auto& sample : samples_) {
+        if (sample.name == name && sample.labels == labels) {
+            return &sample;
+        }
+    }
+    return nullptr;
+}
+
+// Rendering: Prometheus text exposition format 0.0.4. Latencies become summaries in
+// seconds with 0.5/0.99/0.999 quantiles plus a separate _max gauge.
+std::string MetricsSnapshot::toPrometheus() const {
+    std::string out;
+
+    // Samples of one metric must be contiguous and preceded by a single TYPE line
+    std::map<std::string, std::vector<const MetricSample*>> byName;
+    for (const auto& sample : samples_) {
+        byName[sample.name].push_back(&sample);
+    }
+    for (const auto& [name, samples] : byName) {
+        out += "# TYPE " + name + (samples.front()->type == MetricType::Counter ? " counter\n" : " gauge\n");
+        for (const MetricSample* sample : samples) {
+            out += name + formatLabels(sample->labels) + " " + formatNumber(sample->value) + "\n";
+        }
+    }
+
+    std::map<std::string, std::vector<const HistogramSample*>> histogramsByName;
+    for (const auto& histogram : histograms_) {
+        histogramsByName[histogram.name].push_back(&histogram);
+    }
+    for (const auto& [name, histograms] : histogramsByName) {
+        out += "# TYPE " + name + " summary\n";
+        for (const HistogramSample* histogram : histograms) {
+            const LatencySnapshot& latency = histogram->latency;
+            const std::pair<const char*, uint64_t> quantiles[] = {
+                {"0.5", latency.p50}, {"0.99", latency.p99}, {"0.999", latency.p999}
+            };
+            for (const auto& [quantile, nanos] : quantiles) {
+                out += name + formatLabels(histogram->labels, "quantile", quantile) + " " +
+                       formatNumber(static_cast<double>(nanos) / 1e9) + "\n";
+            }
+            out += name + "_sum" + formatLabels(histogram->labels) + " " +
+                   formatNumber(latency.mean * static_cast<double>(latency.count) / 1e9) + "\n";
+            out += name + "_count" + formatLabels(histogram->labels) + " " +
+                   formatNumber(static_cast<double>(latency.count)) + "\n";
+        }
+        out += "# TYPE " + name + "_max gauge\n";
+        for (const HistogramSample* histogram : histograms) {
+            out += name + "_max" + formatLabels(histogram->labels) + " " +
+                   formatNumber(static_cast<double>(histogram->latency.max) / 1e9) + "\n";
+        }
+    }
+    return out;
+}
+
+// Rendering: JSON object with the samples and latencies (nanoseconds)
+std::string MetricsSnapshot::toJson() const {
+    auto timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(timestamp_.time_since_epoch()).count();
+    std::string out = "{\"timestamp_ms\":" + std::to_string(timestampMs) + ",\"metrics\":[";
+
+    bool first = true;
+    for (const auto& sample : samples_) {
+        out += first ? "" : ",";
+        out += "{\"name\":\"" + escapeJson(sample.name) + "\",\"type\":\"" +
+               (sample.type == MetricType::Counter ? "counter" : "gauge") + "\",\"labels\":" +
+               formatJsonLabels(sample.labels) + ",\"value\":" + formatNumber(sample.value) + "}";
+        first = false;
+    }
+
+    out += "],\"histograms\":[";
+    first = true;
+    for (const auto& histogram : histograms_) {
+        const LatencySnapshot& latency = histogram.latency;
+        out += first ? "" : ",";
+        out += "{\"name\":\"" + escapeJson(histogram.name) + "\",\"labels\":" + formatJsonLabels(histogram.labels) +
+               ",\"count\":" + std::to_string(latency.count) + ",\"mean_ns\":" + formatNumber(latency.mean) +
+               ",\"p50_ns\":" + std::to_string(latency.p50) + ",\"p99_ns\":" + std::to_string(latency.p99) +
+               ",\"p999_ns\":" + std::to_string(latency.p999) + ",\"max_ns\":" + std::to_string(latency.max) + "}";
+        first = false;
+    }
+    return out + "]}";
+}
@@ -0,0 +1,409 @@
+#include "OffsetStore.h"
+#include "Metrics.h"
+#include "RecordIO.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using recordio::checksum;
+using recordio::appendValue;
+using recordio::readValue;
+
+constexpr uint8_t kRecordMagic = 0x4F;
+constexpr size_t kRecordHeaderSize = 1 + 2 + 2 + 4 + 8; // magic, group len, topic len, partition, offset
+constexpr size_t kChecksumSize = 4;
+
+} // namespace
+
+// Hash: Combines group, topic and partition
+size_t OffsetStore::OffsetKeyHash::operator()(const OffsetKey& key) const {
+    size_t hash = std::hash<std::string>()(key.groupId);
+    hash ^= std::hash<std::string>()(key.topicName) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<uint32_t>()(key.partitionId) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+// Constructor: Opens (and recovers) the offset log under dataDirectory; empty means in-memory only
+OffsetStore::OffsetStore(std::string dataDirectory) :
+    dataDirectory_(std::move(dataDirectory)),
+    logFd_(-1),
+    enqueuedSequence_(0),
+    flushedSequence_(0),
+    failedSequence_(0),
+    running_(false),
+    recordsInLog_(0),
+    logLength_(0),
+    compactionThreshold_(10000),
+    totalAppends_(0),
+    totalCommits_(0) {
+    if (dataDirectory_.empty()) {
+        return;
+    }
+
+    std::filesystem::path logDirectory = std::filesystem::path(dataDirectory_) / "__consumer_offsets";
+    std::filesystem::create_directories(logDirectory);
+    logPath_ = (logDirectory / "00000000.log").string();
+
+    recover();
+
+    logFd_ = ::open(logPath_.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (logFd_ < 0) {
+        throw std::runtime_error("Cannot open offset log " + logPath_ + ": " + std::strerror(errno));
+    }
+    logLength_ = std::filesystem::file_size(logPath_);
+}
+
+// Destructor: Flushes outstanding commits and closes the log
+OffsetStore::~OffsetStore() {
+    stop();
+    join();
+    flushPending();
+    if (logFd_ >= 0) {
+        ::close(logFd_);
+    }
+}
+
+// Lifecycle: Starts the background flusher thread (only needed for a durable store)
+void OffsetStore::start() {
+    if (running_.load() || !isDurable()) {
+        return;
+    }
+
+    running_.store(true);
+    flusherThread_ = std::thread(&OffsetStore::flusherThread, this);
+}
+
+// Lifecycle: Stops the background flusher thread
+void OffsetStore::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        running_.store(false);
+    }
+    pendingCv_.notify_all();
+    flushedCv_.notify_all();
+}
+
+// Lifecycle: Waits for the flusher thread to finish
+void OffsetStore::join() {
+    if (flusherThread_.joinable()) {
+        flusherThread_.join();
+    }
+}
+
+// Commits: Records an offset and returns immediately; it is appended with the next batch
+void OffsetStore::commitAsync(const std::string& groupId, const std::string& topicName, uint32_t partitionId, uint64_t offset) {
+    enqueue(groupId, topicName, partitionId, offset);
+}
+
+// Commits: Records an offset and waits until the batch containing it is on disk
+void OffsetStore::commitSync(const std::string& groupId, const std::string& topicName, uint32_t partitionId, uint64_t offset) {
+    uint64_t sequence = enqueue(groupId, topicName, partitionId, offset);
+    waitFlushed(sequence);
+}
+
+// Commits: Waits until every commit issued so far is on disk
+void OffsetStore::flush() {
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        sequence = enqueuedSequence_;
+    }
+    waitFlushed(sequence);
+}
+
+// Lookup: Returns the latest committed offset, if any
+std::optional<uint64_t> OffsetStore::getCommittedOffset(const std::string& groupId, const std::string& topicName,
+                                                        uint32_t partitionId) const {
+    std::lock_guard<std::mutex> lock(indexMutex_);
+    auto it = index_.find(OffsetKey{groupId, topicName, partitionId});
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+// Lookup: Visits every committed offset (group, topic, partition, offset) under the index lock
+void OffsetStore::forEachCommittedOffset(
+    const std::function<void(const std::string&, const std::string&, uint32_t, uint64_t)>& visitor) const {
+    std::lock_guard<std::mutex> lock(indexMutex_);
+    for (const auto& [key, offset] : index_) {
+        visitor(key.groupId, key.topicName, key.partitionId, offset);
+    }
+}
+
+// Statistics: Checks if commits are persisted to disk
+bool OffsetStore::isDurable() const {
+    return !dataDirectory_.empty();
+}
+
+// Statistics: Returns the number of log appends (each may carry many commits)
+uint64_t OffsetStore::getTotalAppends() const {
+    return totalAppends_.load();
+}
+
+// Statistics: Returns the number of commits received
+uint64_t OffsetStore::getTotalCommits() const {
+    return totalCommits_.load();
+}
+
+// Statistics: Checks if the flusher thread is running
+bool OffsetStore::isRunning() const {
+    return running_.load();
+}
+
+// Configuration: Sets the minimum log length (in records) before compaction is considered
+void OffsetStore::setCompactionThreshold(uint64_t minRecords) {
+    compactionThreshold_.store(minRecords);
+}
+
+// Background: Appends each batch of pending commits as a single write
+void OffsetStore::flusherThread() {
+    while (running_.load()) {
+        {
+            std::unique_lock<std::mutex> lock(pendingMutex_);
+            pendingCv_.wait(lock, [this] { return !pending_.empty() || !running_.load(); });
+        }
+
+        if (!flushPending()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Back off before retrying
+        }
+    }
+}
+
+// Internal: Updates the index and queues the commit; returns its flush sequence number
+uint64_t OffsetStore::enqueue(const std::string& groupId, const std::string& topicName, uint32_t partitionId, uint64_t offset) {
+    if (groupId.size() > UINT16_MAX || topicName.size() > UINT16_MAX) {
+        throw std::invalid_argument("Group id or topic name too long for the offset log");
+    }
+
+    OffsetKey key{groupId, topicName, partitionId};
+    totalCommits_.fetch_add(1);
+
+    if (!isDurable()) {
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        index_[std::move(key)] = offset;
+        return 0;
+    }
+
+    uint64_t sequence;
+    {
+        std::scoped_lock lock(indexMutex_, pendingMutex_);
+        index_[key] = offset;
+        pending_[std::move(key)] = offset;
+        sequence = ++enqueuedSequence_;
+    }
+    pendingCv_.notify_one();
+    return sequence;
+}
+
+// Internal: Blocks until 'sequence' is flushed (flushes inline when the thread is not running).
+// Rethrows the write error if the flush covering 'sequence' failed; its commits stay queued
+// and are retried by the next flush.
+void OffsetStore::waitFlushed(uint64_t sequence) {
+    if (!isDurable()) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(pendingMutex_);
+        flushedCv_.wait(lock, [this, sequence] {
+            return flushedSequence_ >= sequence || failedSequence_ >= sequence || !running_.load();
+        });
+        if (flushedSequence_ >= sequence) {
+            return;
+        }
+        if (failedSequence_ >= sequence) {
+            std::rethrow_exception(flushError_);
+        }
+    }
+    flushPending();
+
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    if (flushedSequence_ < sequence && failedSequence_ >= sequence) {
+        std::rethrow_exception(flushError_);
+    }
+}
+
+// Internal: Takes all pending commits and appends them to the log in one write. On a write
+// error the batch is merged back into pending_ (commits made since win) and the waiters of
+// this batch are woken with the error. Returns false if the append failed.
+bool OffsetStore::flushPending() {
+    if (!isDurable()) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> writeLock(writeMutex_);
+
+    OffsetMap batch;
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        batch.swap(pending_);
+        sequence = enqueuedSequence_;
+    }
+
+    if (!batch.empty()) {
+        try {
+            appendRecords(batch);
+        } catch (const std::exception& e) {
+            Metrics::getInstance().logError("Offset log append failed, requeued " + std::to_string(batch.size()) +
+                                            " commits: " + e.what());
+            {
+                std::lock_guard<std::mutex> lock(pendingMutex_);
+                for (auto& [key, offset] : batch) {
+                    pending_.try_emplace(key, offset);
+                }
+                failedSequence_ = std::max(failedSequence_, sequence);
+                flushError_ = std::current_exception();
+            }
+            flushedCv_.notify_all();
+            return false;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        flushedSequence_ = std::max(flushedSequence_, sequence);
+    }
+    flushedCv_.notify_all();
+
+    if (!batch.empty()) {
+        size_t liveKeys;
+        {
+            std::lock_guard<std::mutex> lock(indexMutex_);
+            liveKeys = index_.size();
+        }
+        if (recordsInLog_ > compactionThreshold_.load() && recordsInLog_ > 2 * liveKeys) {
+            try {
+                compact();
+            } catch (const std::exception& e) {
+                // The appended records are durable; compaction is retried after later appends
+                Metrics::getInstance().logError("Offset log compaction failed: " + std::string(e.what()));
+            }
+        }
+    }
+    return true;
+}
+
+// Internal: Appends a batch of records with one write + sync (cut back if it fails, so the
+// retry does not land behind torn bytes); caller holds writeMutex_
+void OffsetStore::appendRecords(const OffsetMap& records) {
+    std::string buffer;
+    for (const auto& [key, offset] : records) {
+        encodeRecord(buffer, key, offset);
+    }
+
+    recordio::appendToLog(logFd_, buffer, logLength_, "Offset log");
+    recordsInLog_ += records.size();
+    totalAppends_.fetch_add(1);
+}
+
+// Internal: Rewrites the log with only the latest offset per key; caller holds writeMutex_
+void OffsetStore::compact() {
+    std::string buffer;
+    size_t records = 0;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        for (const auto& [key, offset] : index_) {
+            encodeRecord(buffer, key, offset);
+            ++records;
+        }
+    }
+
+    std::string compactedPath = logPath_ + ".compacted";
+    int fd = ::open(compactedPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + compactedPath + ": " + std::strerror(errno));
+    }
+    try {
+        recordio::writeFully(fd, buffer, "Offset log");
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+
+    recordio::renameDurably(compactedPath, logPath_, "Compacted offset log");
+    ::close(logFd_);
+    logFd_ = ::open(logPath_.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (logFd_ < 0) {
+        throw std::runtime_error("Cannot reopen offset log " + logPath_ + ": " + std::strerror(errno));
+    }
+    logLength_ = buffer.size();
+
+    Metrics::getInstance().logInfo("Compacted offset log from " + std::to_string(recordsInLog_) +
+                                   " to " + std::to_string(records) + " records");
+    recordsInLog_ = records;
+}
+
+// Internal: Rebuilds the index from the log, truncating a torn tail left by a crash
+void OffsetStore::recover() {
+    std::ifstream input(logPath_, std::ios::binary);
+    if (!input) {
+        return;
+    }
+    std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+
+    size_t position = 0;
+    while (position + kRecordHeaderSize <= data.size()) {
+        const char* record = data.data() + position;
+        if (static_cast<uint8_t>(record[0]) != kRecordMagic) {
+            break;
+        }
+
+        uint16_t groupLength = readValue<uint16_t>(record + 1);
+        uint16_t topicLength = readValue<uint16_t>(record + 3);
+        size_t recordSize = kRecordHeaderSize + groupLength + topicLength + kChecksumSize;
+        if (position + recordSize > data.size()) {
+            break;
+        }
+
+        size_t bodySize = recordSize - kChecksumSize;
+        if (readValue<uint32_t>(record + bodySize) != checksum(record, bodySize)) {
+            break;
+        }
+
+        OffsetKey key;
+        key.partitionId = readValue<uint32_t>(record + 5);
+        uint64_t offset = readValue<uint64_t>(record + 9);
+        key.groupId.assign(record + kRecordHeaderSize, groupLength);
+        key.topicName.assign(record + kRecordHeaderSize + groupLength, topicLength);
+
+        index_[std::move(key)] = offset;
+        recordsInLog_++;
+        position += recordSize;
+    }
+
+    if (position < data.size()) {
+        Metrics::getInstance().logWarn("Truncating " + std::to_string(data.size() - position) +
+                                       " trailing bytes of offset log " + logPath_);
+        std::filesystem::resize_file(logPath_, position);
+    }
+
+    Metrics::getInstance().logInfo("Recovered " + std::to_string(index_.size()) + " committed offsets from " + logPath_);
+}
+
+// Internal: Serializes one record (magic, lengths, partition, offset, group, topic, checksum)
+void OffsetStore::encodeRecord(std::string& buffer, const OffsetKey& key, uint64_t offset) {
+    size_t start = buffer.size();
+    buffer.push_back(static_cast<char>(kRecordMagic));
+    appendValue<uint16_t>(buffer, static_cast<uint16_t>(key.groupId.size()));
+    appendValue<uint16_t>(buffer, static_cast<uint16_t>(key.topicName.size()));
+    appendValue<uint32_t>(buffer, key.partitionId);
+    appendValue<uint64_t>(buffer, offset);
+    buffer.append(key.groupId);
+    buffer.append(key.topicName);
+    appendValue<uint32_t>(buffer, checksum(buffer.data() + start, buffer.size() - start));
+}
@@ -0,0 +1,308 @@
+#include "ParallelConsumer.h"
+#include "Metrics.h"
+
+#include <stdexcept>
+
+namespace {
+constexpr uint64_t kMaxPollBytes = 4 * 1024 * 1024;
+constexpr auto kPollTimeout = std::chrono::milliseconds(100);
+}
+
+// Constructor: Creates the underlying consumer; threads are started by start()
+ParallelConsumer::ParallelConsumer(Broker& broker, const std::string& topicName, const std::string& groupId,
+                                   size_t numWorkers, Handler handler) :
+    broker_(broker),
+    topicName_(topicName),
+    groupId_(groupId),
+    consumer_(std::make_unique<Consumer>(broker, topicName, groupId)),
+    handler_(std::move(handler)),
+    numWorkers_(numWorkers),
+    maxInFlightRecords_(1000),
+    commitInterval_(std::chrono::milliseconds(100)),
+    running_(false),
+    workersExit_(false),
+    totalProcessed_(0),
+    totalCommits_(0) {
+    if (numWorkers_ == 0) {
+        throw std::invalid_argument("ParallelConsumer needs at least one worker");
+    }
+}
+
+// Destructor: Finishes dispatched records and commits them
+ParallelConsumer::~ParallelConsumer() {
+    stop();
+    join();
+}
+
+// Lifecycle: Starts the poll thread and the worker pool
+void ParallelConsumer::start() {
+    if (running_.load()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        workersExit_ = false;
+    }
+    running_.store(true);
+    for (size_t i = 0; i < numWorkers_; ++i) {
+        workerThreads_.emplace_back(&ParallelConsumer::workerThread, this);
+    }
+    pollThread_ = std::thread(&ParallelConsumer::pollThread, this);
+}
+
+// Lifecycle: Stops polling; the poll thread drains the workers before exiting
+void ParallelConsumer::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(false);
+    }
+    capacityCv_.notify_all();
+}
+
+// Lifecycle: Waits for the poll thread and the workers to finish
+void ParallelConsumer::join() {
+    if (pollThread_.joinable()) {
+        pollThread_.join();
+    }
+    for (auto& worker : workerThreads_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workerThreads_.clear();
+}
+
+// Configuration: Sets how many records of one partition may be dispatched but not completed
+void ParallelConsumer::setMaxInFlightRecords(size_t maxRecords) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxInFlightRecords_ = std::max<size_t>(maxRecords, 1);
+}
+
+// Configuration: Sets how often the completed prefix is committed
+void ParallelConsumer::setCommitInterval(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    commitInterval_ = interval;
+}
+
+// Configuration: Returns the underlying consumer
+Consumer& ParallelConsumer::getConsumer() {
+    return *consumer_;
+}
+
+// Statistics: Returns the last committed offset of a partition (0 before the first commit)
+uint64_t ParallelConsumer::getCommittedOffset(uint32_t partitionId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = progress_.find(partitionId);
+    return it != progress_.end() ? it->second.committed : 0;
+}
+
+// Statistics: Returns the number of records handled by the workers
+uint64_t ParallelConsumer::getTotalProcessed() const {
+    return totalProcessed_.load();
+}
+
+// Statistics: Returns the number of offset commits issued
+uint64_t ParallelConsumer::getTotalCommits() const {
+    return totalCommits_.load();
+}
+
+// Status: Check if the consumer is polling
+bool ParallelConsumer::isRunning() const {
+    return running_.load();
+}
+
+// Background: Polls while the in-flight windows have room, dispatches by key and commits
+// the completed prefixes; on stop waits for the workers to drain
+void ParallelConsumer::pollThread() {
+    auto lastCommit = std::chrono::steady_clock::now();
+
+    while (running_.load()) {
+        size_t maxRecords;
+        std::chrono::milliseconds commitInterval;
+        bool hasCapacity;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            capacityCv_.wait_for(lock, kPollTimeout, [this] { return !running_.load() || hasCapacityLocked(); });
+            maxRecords = maxInFlightRecords_;
+            commitInterval = commitInterval_;
+            hasCapacity = hasCapacityLocked();
+        }
+        if (!running_.load()) {
+            break;
+        }
+
+        if (hasCapacity) {
+            ConsumerRecords records = consumer_->poll(maxRecords, kMaxPollBytes, kPollTimeout);
+            if (!records.empty()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (const auto& [partitionId, messages] : records) {
+                    for (const auto& message : messages) {
+                        dispatchLocked(partitionId, Message(message));
+                    }
+                }
+            }
+            workCv_.notify_all();
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastCommit >= commitInterval) {
+            commitCompleted();
+            lastCommit = now;
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        capacityCv_.wait(lock, [this] { return keyQueues_.empty(); });
+    }
+    commitCompleted();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        workersExit_ = true;
+    }
+    workCv_.notify_all();
+}
+
+// Background: Runs the head record of one ready key at a time
+void ParallelConsumer::workerThread() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        workCv_.wait(lock, [this] { return !readyKeys_.empty() || workersExit_; });
+        if (readyKeys_.empty()) {
+            break;
+        }
+
+        std::string key = std::move(readyKeys_.front());
+        readyKeys_.pop_front();
+
+        // The head stays queued while it runs so later records of the key are held back
+        PendingRecord& head = keyQueues_[key].records.front();
+        uint32_t partitionId = head.partitionId;
+        Message message = std::move(head.message);
+        lock.unlock();
+
+        try {
+            handler_(partitionId, message);
+        } catch (const std::exception& e) {
+            Metrics::getInstance().logError("ParallelConsumer handler failed on " + topicName_ + "-" +
+                                            std::to_string(partitionId) + "@" + std::to_string(message.getOffset()) +
+                                            ": " + e.what());
+        } catch (...) {
+            Metrics::getInstance().logError("ParallelConsumer handler failed on " + topicName_ + "-" +
+                                            std::to_string(partitionId) + "@" + std::to_string(message.getOffset()) +
+                                            ": unknown exception");
+        }
+        totalProcessed_++;
+
+        lock.lock();
+        auto it = keyQueues_.find(key);
+        it->second.records.pop_front();
+        if (it->second.records.empty()) {
+            keyQueues_.erase(it);
+        } else {
+            readyKeys_.push_back(std::move(key));
+            workCv_.notify_one();
+        }
+        completeLocked(partitionId, message.getOffset());
+        capacityCv_.notify_one();
+    }
+}
+
+// Dispatch: Queues a record behind earlier records of its key; caller holds mutex_.
+// A record below the completed prefix (the consumer was seeked back, or the partition
+// redelivered after a reassignment) restarts the partition's window at its offset.
+void ParallelConsumer::dispatchLocked(uint32_t partitionId, Message&& message) {
+    uint64_t offset = message.getOffset();
+    auto [progressIt, inserted] = progress_.try_emplace(partitionId);
+    PartitionProgress& progress = progressIt->second;
+    if (inserted) {
+        progress.committed = offset;
+    }
+    if (inserted || offset < progress.nextCommit) {
+        progress.nextCommit = offset;
+        progress.windowBase = offset - offset % 64;
+        progress.dispatchedEnd = offset;
+        progress.completed.clear();
+    }
+    while (progress.windowBase + progress.completed.size() * 64 <= offset) {
+        progress.completed.push_back(0);
+    }
+    progress.dispatchedEnd = std::max(progress.dispatchedEnd, offset + 1);
+
+    std::string key = std::to_string(partitionId);
+    key += '\0';
+    key += message.getKey();
+
+    KeyQueue& queue = keyQueues_[key];
+    bool idle = queue.records.empty();
+    queue.records.push_back(PendingRecord{partitionId, std::move(message)});
+    if (idle) {
+        readyKeys_.push_back(std::move(key));
+    }
+}
+
+// Dispatch: Marks a record done and extends the completed prefix; caller holds mutex_.
+// Records dispatched before the window restarted may complete outside it and are ignored.
+void ParallelConsumer::completeLocked(uint32_t partitionId, uint64_t offset) {
+    PartitionProgress& progress = progress_[partitionId];
+    if (offset < progress.nextCommit || offset >= progress.dispatchedEnd) {
+        return;
+    }
+    uint64_t index = offset - progress.windowBase;
+    progress.completed[index / 64] |= uint64_t{1} << (index % 64);
+
+    while (progress.nextCommit < progress.dispatchedEnd) {
+        uint64_t position = progress.nextCommit - progress.windowBase;
+        uint64_t word = progress.completed[position / 64];
+        if (position % 64 == 0 && word == ~uint64_t{0}) {
+            progress.nextCommit += 64; // Whole word completed
+        } else if ((word >> (position % 64)) & 1) {
+            progress.nextCommit++;
+        } else {
+            break;
+        }
+
+        if (progress.nextCommit - progress.windowBase >= 64) {
+            progress.completed.pop_front();
+            progress.windowBase += 64;
+        }
+    }
+}
+
+// Dispatch: True while every partition has fewer than maxInFlightRecords_ uncompleted records
+bool ParallelConsumer::hasCapacityLocked() const {
+    for (const auto& [partitionId, progress] : progress_) {
+        if (progress.dispatchedEnd - progress.nextCommit >= maxInFlightRecords_) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Offsets: Commits each partition's completed prefix that moved since the last commit
+void ParallelConsumer::commitCompleted() {
+    std::vector<std::pair<uint32_t, uint64_t>> commits;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [partitionId, progress] : progress_) {
+            if (progress.nextCommit != progress.committed) {
+                progress.committed = progress.nextCommit;
+                commits.emplace_back(partitionId, progress.nextCommit);
+            }
+        }
+    }
+
+    for (const auto& [partitionId, offset] : commits) {
+        if (!groupId_.empty()) {
+            broker_.commitOffsetAsync(groupId_, topicName_, partitionId, offset);
+        }
+        totalCommits_++;
+    }
+}
@@ -1,31 +1,70 @@
 #include "Partition.h"
 
+#include <algorithm>
+
 // Constructor: Initializes a partition with given ID
 Partition::Partition(uint32_t id):
     id_(id),
     nextOffset_(0) {}
 
-// Core: Appends a message to this partition and assigns proper offset
+// Core: Appends a copy of a message to this partition and assigns proper offset
 void Partition::append(const Message& message) {
-    // Lock-free atomic operation to get next offset
-    uint64_t offset = nextOffset_.fetch_add(1);
+    append(Message(message));
+}
+
+// Core: Appends a message to this partition and assigns proper offset
+void Partition::append(Message&& message) {
+    throughput_.markIn(1, message.getSizeBytes());
     
-    std::lock_guard<std::mutex> lock(mutex_);
-    Message newMessage(message.getKey(), message.getValue(), offset, message.getTimestamp());
-    messages_.push_back(newMessage);
+    std::vector<std::function<void()>> readyWaiters;
+    {
+        std::lock_guard lock(mutex_);
+        // Offset is taken under the lock so log order matches offsets and readers never
+        // see nextOffset_ ahead of messages_ (size() still reads it without the lock)
+        uint64_t offset = nextOffset_.load(std::memory_order_relaxed);
+        message.setOffset(offset);
+        messages_.push_back(std::move(message));
+        nextOffset_.store(offset + 1, std::memory_order_release);
+        
+        cv_.notify_all();
+        
+        for (auto it = waiters_.begin(); it != waiters_.end();) {
+            if (it->first <= offset) {
+                readyWaiters.push_back(std::move(it->second));
+                it = waiters_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
     
-    cv_.notify_all();
+    // Callbacks run outside the lock so they may read from this partition
+    for (auto& callback : readyWaiters) {
+        callback();
+    }
+}
+
+// Core: Invokes callback once a message with specified offset is available (immediately if it already is)
+void Partition::notifyWhenAvailable(uint64_t offset, std::function<void()> callback) {
+    {
+        std::lock_guard lock(mutex_);
+        if (offset >= nextOffset_.load()) {
+            waiters_.emplace_back(offset, std::move(callback));
+            return;
+        }
+    }
+    callback();
 }
 
 // Core: Blocks until a message with specified offset becomes available
 void Partition::waitForMessage(uint64_t offset) {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock lock(mutex_);
     cv_.wait(lock, [this, offset] {return offset < nextOffset_.load(); }); // Wait until the message is available
 }
 
 // Reader: Retrieves a specific message by its offset
 const Message Partition::getMessage(uint64_t offset) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
     checkConsistency();
 
     if (offset >= nextOffset_.load()) {
@@ -36,7 +75,7 @@ const Message Partition::getMessage(uint64_t offset) const {
 
 // Reader: Retrieves a range of messages from 'from' to 'to' offset
 std::vector<Message> Partition::getMessages(uint64_t from, uint64_t to) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
     checkConsistency();
 
     if (from >= nextOffset_.load()) return {};
@@ -45,17 +84,44 @@ std::vector<Message> Partition::getMessages(uint64_t from, uint64_t to) const {
     return std::vector<Message>(messages_.begin() + from, messages_.begin() + to);
 }
 
+// Reader: Retrieves up to maxRecords messages starting at 'from', stopping once maxBytes
+// of payload is reached. The first message is always returned so an oversized record
+// cannot stall the reader.
+std::vector<Message> Partition::fetch(uint64_t from, size_t maxRecords, uint64_t maxBytes) const {
+    std::lock_guard lock(mutex_);
+    checkConsistency();
+
+    uint64_t end = nextOffset_.load();
+    if (from >= end || maxRecords == 0) return {};
+    end = std::min<uint64_t>(end, from + maxRecords);
+
+    std::vector<Message> messages;
+    messages.reserve(end - from);
+
+    uint64_t bytes = 0;
+    for (uint64_t offset = from; offset < end; ++offset) {
+        const Message& message = messages_[offset];
+        bytes += message.getSizeBytes();
+        if (bytes > maxBytes && !messages.empty()) {
+            break;
+        }
+        messages.push_back(message);
+    }
+
+    return messages;
+}
+
 // Reader: Retrieves all messages in this partition
 std::vector<Message> Partition::getAllMessages() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
     checkConsistency();
     
     return messages_;
 }
 
-// Utility: Returns the total number of messages in this partition
+// Utility: Returns the total number of messages in this partition (without taking the lock,
+// so metric scrapes never wait on appends)
 uint64_t Partition::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     return nextOffset_.load();
 }
 
@@ -64,6 +130,16 @@ uint32_t Partition::getId() const {
     return id_;
 }
 
+// Metrics: Returns the meters of messages and bytes in and out of this partition
+ThroughputMeters& Partition::getThroughput() {
+    return throughput_;
+}
+
+// Metrics: Returns the current throughput rates of this partition
+ThroughputRates Partition::getThroughputRates() const {
+    return throughput_.getRates();
+}
+
 // Internal: Validates data consistency between messages_ and nextOffset_
 void Partition::checkConsistency() const {
     if (messages_.size() != nextOffset_.load()) {
@@ -0,0 +1,293 @@
+#include "PostgresGroupStore.h"
+#include "Metrics.h"
+
+#include <cstdlib>
+#include <string_view>
+
+namespace {
+
+const char* kUpsertGroup =
+    "INSERT INTO consumer_groups (group_id, topic_name) VALUES ($1, $2) "
+    "ON CONFLICT (group_id) DO UPDATE SET topic_name = EXCLUDED.topic_name";
+
+// last_heartbeat is a timestamp without time zone; it holds UTC so reading it back as
+// epoch seconds does not depend on the server's TimeZone setting
+const char* kUpsertConsumers =
+    "INSERT INTO consumers (consumer_id, group_id, last_heartbeat) "
+    "SELECT m.consumer_id, $1, to_timestamp(m.heartbeat) AT TIME ZONE 'UTC' "
+    "FROM unnest($2::text[], $3::float8[]) AS m(consumer_id, heartbeat) "
+    "ON CONFLICT (consumer_id) DO UPDATE SET group_id = EXCLUDED.group_id, last_heartbeat = EXCLUDED.last_heartbeat";
+
+const char* kUpsertAssignments =
+    "INSERT INTO partition_assignments (group_id, consumer_id, partition_id) "
+    "SELECT $1, a.consumer_id, a.partition_id "
+    "FROM unnest($2::text[], $3::int[]) AS a(consumer_id, partition_id) "
+    "ON CONFLICT (group_id, partition_id) DO UPDATE SET consumer_id = EXCLUDED.consumer_id, assigned_at = CURRENT_TIMESTAMP";
+
+const char* kDeleteAssignments =
+    "DELETE FROM partition_assignments WHERE group_id = $1 AND partition_id = ANY($2::int[])";
+
+const char* kDeleteConsumers =
+    "DELETE FROM consumers WHERE group_id = $1 AND consumer_id = ANY($2::text[])";
+
+const char* kLoadGroup =
+    "SELECT c.consumer_id, extract(epoch FROM c.last_heartbeat AT TIME ZONE 'UTC'), pa.partition_id "
+    "FROM consumers c "
+    "LEFT JOIN partition_assignments pa ON pa.consumer_id = c.consumer_id AND pa.group_id = c.group_id "
+    "WHERE c.group_id = $1";
+
+// Appends one element to a PostgreSQL array literal, quoting it
+void appendArrayElement(std::string& literal, const std::string& element) {
+    literal += literal.size() > 1 ? ",\"" : "\"";
+    for (char c : element) {
+        if (c == '"' || c == '\\') {
+            literal += '\\';
+        }
+        literal += c;
+    }
+    literal += '"';
+}
+
+double toEpochSeconds(std::chrono::system_clock::time_point timePoint) {
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(timePoint.time_since_epoch());
+    return static_cast<double>(millis.count()) / 1000.0;
+}
+
+// libpq error text without its trailing newline
+std::string_view errorMessage(const PGconn* connection) {
+    std::string_view message = PQerrorMessage(connection);
+    while (!message.empty() && message.back() == '\n') {
+        message.remove_suffix(1);
+    }
+    return message;
+}
+
+} // namespace
+
+// Constructor: Connects to PostgreSQL (the store is unavailable if that fails)
+PostgresGroupStore::PostgresGroupStore(std::string connectionString) :
+    connection_(nullptr) {
+    connection_ = PQconnectdb(connectionString.c_str());
+    if (PQstatus(connection_) != CONNECTION_OK) {
+        SK_LOGF(LogLevel::ERROR, "Connection to database failed: {}", errorMessage(connection_));
+        PQfinish(connection_);
+        connection_ = nullptr;
+        return;
+    }
+
+    SK_LOGF(LogLevel::INFO, "Connected to PostgreSQL database");
+    if (!prepareStatements()) {
+        PQfinish(connection_);
+        connection_ = nullptr;
+    }
+}
+
+// Destructor: Closes the connection
+PostgresGroupStore::~PostgresGroupStore() {
+    if (connection_) {
+        PQfinish(connection_);
+    }
+}
+
+// Utility: Default connection string for the local selfkafka database
+std::string PostgresGroupStore::defaultConnectionString() {
+    const char* user = std::getenv("USER");
+    return "dbname=selfkafka user=" + std::string(user ? user : "postgres");
+}
+
+// Persistence: Loads members and assignments, registering the group if it is new
+GroupState PostgresGroupStore::load(const std::string& groupId, const std::string& topicName) {
+    GroupState state;
+    state.groupId = groupId;
+    state.topicName = topicName;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connection_ || !ensureConnected()) {
+        SK_LOGF(LogLevel::WARN, "No database connection available for loading group {}", groupId);
+        return state;
+    }
+
+    const char* values[1] = {groupId.c_str()};
+    PGresult* result = PQexecParams(connection_, kLoadGroup, 1, nullptr, values, nullptr, nullptr, 0);
+    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+        SK_LOGF(LogLevel::ERROR, "Load consumers of group {} failed: {}", groupId, errorMessage(connection_));
+        PQclear(result);
+        return state;
+    }
+
+    int numRows = PQntuples(result);
+    for (int i = 0; i < numRows; ++i) {
+        std::string consumerId = PQgetvalue(result, i, 0);
+        if (!PQgetisnull(result, i, 1)) {
+            auto millis = static_cast<int64_t>(std::stod(PQgetvalue(result, i, 1)) * 1000.0);
+            state.members[consumerId] = std::chrono::system_clock::time_point(std::chrono::milliseconds(millis));
+        } else {
+            state.members[consumerId] = std::chrono::system_clock::time_point();
+        }
+        if (!PQgetisnull(result, i, 2)) {
+            state.assignments[static_cast<uint32_t>(std::stoul(PQgetvalue(result, i, 2)))] = consumerId;
+        }
+    }
+    PQclear(result);
+
+    const char* groupValues[2] = {groupId.c_str(), topicName.c_str()};
+    if (execPrepared("sk_upsert_group", 2, groupValues)) {
+        registeredGroups_.insert(groupId);
+    }
+
+    SK_LOGF(LogLevel::INFO, "Loaded ConsumerGroup {} ({} consumers) from PostgreSQL", groupId, state.members.size());
+    return state;
+}
+
+// Persistence: Applies a diff in a single transaction
+bool PostgresGroupStore::apply(const std::string& groupId, const std::string& topicName, const GroupStateDiff& diff) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connection_ || !ensureConnected()) {
+        return false;
+    }
+
+    if (!execCommand("BEGIN")) {
+        return false;
+    }
+
+    bool ok = true;
+    bool registerGroup = !registeredGroups_.contains(groupId);
+    if (registerGroup) {
+        const char* values[2] = {groupId.c_str(), topicName.c_str()};
+        ok = execPrepared("sk_upsert_group", 2, values);
+    }
+
+    if (ok && !diff.upsertedMembers.empty()) {
+        std::string consumerIds = "{";
+        std::string heartbeats = "{";
+        for (const auto& [consumerId, heartbeat] : diff.upsertedMembers) {
+            appendArrayElement(consumerIds, consumerId);
+            heartbeats += (heartbeats.size() > 1 ? "," : "") + std::to_string(toEpochSeconds(heartbeat));
+        }
+        consumerIds += "}";
+        heartbeats += "}";
+
+        const char* values[3] = {groupId.c_str(), consumerIds.c_str(), heartbeats.c_str()};
+        ok = execPrepared("sk_upsert_consumers", 3, values);
+    }
+
+    if (ok && !diff.upsertedAssignments.empty()) {
+        std::string consumerIds = "{";
+        std::string partitionIds = "{";
+        for (const auto& [partitionId, consumerId] : diff.upsertedAssignments) {
+            appendArrayElement(consumerIds, consumerId);
+            partitionIds += (partitionIds.size() > 1 ? "," : "") + std::to_string(partitionId);
+        }
+        consumerIds += "}";
+        partitionIds += "}";
+
+        const char* values[3] = {groupId.c_str(), consumerIds.c_str(), partitionIds.c_str()};
+        ok = execPrepared("sk_upsert_assignments", 3, values);
+    }
+
+    if (ok && !diff.removedAssignments.empty()) {
+        std::string partitionIds = "{";
+        for (uint32_t partitionId : diff.removedAssignments) {
+            partitionIds += (partitionIds.size() > 1 ? "," : "") + std::to_string(partitionId);
+        }
+        partitionIds += "}";
+
+        const char* values[2] = {groupId.c_str(), partitionIds.c_str()};
+        ok = execPrepared("sk_delete_assignments", 2, values);
+    }
+
+    // Removed last: their assignments were re-owned above, the rest cascade
+    if (ok && !diff.removedMembers.empty()) {
+        std::string consumerIds = "{";
+        for (const auto& consumerId : diff.removedMembers) {
+            appendArrayElement(consumerIds, consumerId);
+        }
+        consumerIds += "}";
+
+        const char* values[2] = {groupId.c_str(), consumerIds.c_str()};
+        ok = execPrepared("sk_delete_consumers", 2, values);
+    }
+
+    if (!ok) {
+        execCommand("ROLLBACK");
+        return false;
+    }
+    if (!execCommand("COMMIT")) {
+        return false;
+    }
+
+    if (registerGroup) {
+        registeredGroups_.insert(groupId);
+    }
+    return true;
+}
+
+// Status: Returns true when connected to PostgreSQL
+bool PostgresGroupStore::isAvailable() const {
+    return connection_ != nullptr;
+}
+
+// Status: Backend name for logs
+std::string PostgresGroupStore::getName() const {
+    return "PostgreSQL";
+}
+
+// Utility: Re-establishes a dropped connection; caller holds mutex_
+bool PostgresGroupStore::ensureConnected() {
+    if (PQstatus(connection_) == CONNECTION_OK) {
+        return true;
+    }
+
+    PQreset(connection_);
+    if (PQstatus(connection_) != CONNECTION_OK || !prepareStatements()) {
+        SK_LOGF(LogLevel::ERROR, "Reconnect to database failed: {}", errorMessage(connection_));
+        return false;
+    }
+    return true;
+}
+
+// Persistence: Prepares the upsert and delete statements on the connection
+bool PostgresGroupStore::prepareStatements() {
+    const std::pair<const char*, const char*> statements[] = {
+        {"sk_upsert_group", kUpsertGroup},
+        {"sk_upsert_consumers", kUpsertConsumers},
+        {"sk_upsert_assignments", kUpsertAssignments},
+        {"sk_delete_assignments", kDeleteAssignments},
+        {"sk_delete_consumers", kDeleteConsumers},
+    };
+
+    for (const auto& [name, query] : statements) {
+        PGresult* result = PQprepare(connection_, name, query, 0, nullptr);
+        bool ok = PQresultStatus(result) == PGRES_COMMAND_OK;
+        if (!ok) {
+            SK_LOGF(LogLevel::ERROR, "Prepare {} failed: {}", name, errorMessage(connection_));
+        }
+        PQclear(result);
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Utility: Runs a prepared statement, reporting failures
+bool PostgresGroupStore::execPrepared(const char* name, int numParams, const char* const* values) {
+    PGresult* result = PQexecPrepared(connection_, name, numParams, values, nullptr, nullptr, 0);
+    bool ok = PQresultStatus(result) == PGRES_COMMAND_OK;
+    if (!ok) {
+        SK_LOGF(LogLevel::ERROR, "Statement {} failed: {}", name, errorMessage(connection_));
+    }
+    PQclear(result);
+    return ok;
+}
+
+// Utility: Runs a parameterless command, reporting failures
+bool PostgresGroupStore::execCommand(const char* command) {
+    PGresult* result = PQexec(connection_, command);
+    bool ok = PQresultStatus(result) == PGRES_COMMAND_OK;
+    if (!ok) {
+        SK_LOGF(LogLevel::ERROR, "{} command failed: {}", command, errorMessage(connection_));
+    }
+    PQclear(result);
+    return ok;
+}
@@ -1,4 +1,5 @@
 #include "Producer.h"
+#include "CoroutineExecutor.h"
 
 // Constructor: Initializes producer with reference to broker
 Producer::Producer(Broker& broker):
@@ -8,3 +9,11 @@ Producer::Producer(Broker& broker):
 void Producer::send(const std::string& topicName, const std::string& key, const std::string& value) {
     broker_.send(topicName, key, value);
 }
+
+
+// Coroutine: Sends a message and suspends until the async writer has appended it
+Task<void> Producer::sendAsync(std::string topicName, std::string key, std::string value) {
+    co_await CallbackAwaiter([&](auto callback) {
+        broker_.send(topicName, key, value, std::move(callback));
+    });
+}
\ No newline at end of file
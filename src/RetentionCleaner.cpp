@@ -115,6 +115,19 @@ std::chrono::milliseconds RetentionCleaner::getCleanupInterval() const {
     return cleanupInterval_;
 }
 
+// Partition management: Runs one cleanup pass synchronously (independent of the thread)
+void RetentionCleaner::runOnce() {
+    std::vector<PartitionInfo> partitionsCopy;
+    {
+        std::lock_guard<std::mutex> lock(partitionsMutex_);
+        partitionsCopy = partitions_;
+    }
+    
+    for (const auto& partitionInfo : partitionsCopy) {
+        cleanupPartition(partitionInfo.partition, partitionInfo.policy);
+    }
+}
+
 // Background: Main cleanup thread that processes all partitions
 void RetentionCleaner::cleanupThread() {
     Metrics::getInstance().logInfo("RetentionCleaner thread started");
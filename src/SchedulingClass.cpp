@@ -0,0 +1,48 @@
+#include "SchedulingClass.h"
+#include <sstream>
+
+// Constructor: Initializes the default class (priority 0, 16KB per round)
+SchedulingClass::SchedulingClass() :
+    name_("default"),
+    priority_(0),
+    quantumBytes_(16 * 1024) {}
+
+// Constructor: Initializes a custom class (quantum is clamped to at least 1 byte)
+SchedulingClass::SchedulingClass(std::string name, int32_t priority, uint64_t quantumBytes) :
+    name_(std::move(name)),
+    priority_(priority),
+    quantumBytes_(quantumBytes > 0 ? quantumBytes : 1) {}
+
+// Factory: Class for latency-sensitive topics, served ahead of the default lane
+SchedulingClass SchedulingClass::latencyCritical() {
+    return SchedulingClass("latency-critical", 10, 16 * 1024);
+}
+
+// Factory: Class for backfill topics, served only when higher lanes are idle
+SchedulingClass SchedulingClass::bulk() {
+    return SchedulingClass("bulk", -10, 64 * 1024);
+}
+
+// Getter: Returns the class name
+const std::string& SchedulingClass::getName() const {
+    return name_;
+}
+
+// Getter: Returns the strict priority lane
+int32_t SchedulingClass::getPriority() const {
+    return priority_;
+}
+
+// Getter: Returns the deficit-round-robin quantum in bytes
+uint64_t SchedulingClass::getQuantumBytes() const {
+    return quantumBytes_;
+}
+
+// Utility: Get scheduling info as string
+std::string SchedulingClass::toString() const {
+    std::ostringstream oss;
+    oss << "SchedulingClass(name=" << name_
+        << ", priority=" << priority_
+        << ", quantum=" << quantumBytes_ << "B)";
+    return oss.str();
+}
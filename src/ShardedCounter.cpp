@@ -0,0 +1,17 @@
+#include "ShardedCounter.h"
+
+// Reads: Sums the shards
+uint64_t ShardedCounter::load() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// Reads: Zeroes every shard (adds racing with the reset may survive it)
+void ShardedCounter::reset() {
+    for (auto& shard : shards_) {
+        shard.value.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,218 @@
+#include "ShareGroup.h"
+
+#include <stdexcept>
+
+// Constructor: Creates the delivery state of every partition of the topic
+ShareGroup::ShareGroup(std::string groupId, Broker& broker, std::string topicName) :
+    groupId_(std::move(groupId)),
+    broker_(broker),
+    topicName_(std::move(topicName)),
+    nextMemberId_(0),
+    lockTimeout_(std::chrono::seconds(30)),
+    closing_(false),
+    totalAcquired_(0),
+    totalAcknowledged_(0),
+    totalLeaseExpirations_(0) {
+    size_t numPartitions = broker_.getNumPartitions(topicName_);
+    partitions_.reserve(numPartitions);
+    for (size_t i = 0; i < numPartitions; ++i) {
+        partitions_.push_back(std::make_unique<SharePartition>(static_cast<uint32_t>(i)));
+    }
+}
+
+// Destructor: Cancels the lease expiry timers, waiting for one that is firing
+ShareGroup::~ShareGroup() {
+    std::unordered_map<uint32_t, ExpiryTimer> expiryTimers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closing_ = true;
+        expiryTimers.swap(expiryTimers_);
+    }
+
+    for (const auto& [partitionId, timer] : expiryTimers) {
+        broker_.getSessionTimers().cancelSync(timer.timerId);
+    }
+}
+
+// Membership: Registers a member and returns its id
+std::string ShareGroup::join() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string memberId = groupId_ + "-member-" + std::to_string(nextMemberId_++);
+    members_.insert(memberId);
+    pollCursors_[memberId] = static_cast<uint32_t>(members_.size() % std::max<size_t>(partitions_.size(), 1));
+    return memberId;
+}
+
+// Membership: Removes a member and hands its leased records back for redelivery
+void ShareGroup::leave(const std::string& memberId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (members_.erase(memberId) == 0) {
+        return;
+    }
+    pollCursors_.erase(memberId);
+
+    for (auto& partition : partitions_) {
+        partition->releaseMember(memberId);
+    }
+}
+
+// Consumption: Acquires up to maxRecords records across all partitions for a member,
+// waiting up to timeout for some to become available. Only the lease bookkeeping runs
+// under the group lock; the records are fetched after it is released, so one member's
+// fetch does not hold up the other members' polls, acknowledgements and lease expiry.
+ConsumerRecords ShareGroup::poll(const std::string& memberId, size_t maxRecords, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    size_t numPartitions = partitions_.size();
+    std::vector<uint64_t> logEndOffsets(numPartitions);
+
+    while (true) {
+        // Sample the append counter before acquiring so an append in between still wakes us
+        uint64_t seenAppends = broker_.getAppendCount(topicName_);
+        for (size_t i = 0; i < numPartitions; ++i) {
+            logEndOffsets[i] = broker_.getLogEndOffset(topicName_, static_cast<uint32_t>(i));
+        }
+
+        std::vector<std::pair<uint32_t, std::vector<SharePartition::OffsetRange>>> acquired;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!members_.contains(memberId)) {
+                throw std::runtime_error("Unknown share group member: " + memberId);
+            }
+
+            uint32_t& cursor = pollCursors_[memberId];
+            auto leaseDeadline = TimerWheel::Clock::now() + lockTimeout_;
+            size_t acquiredCount = 0;
+
+            for (size_t i = 0; i < numPartitions && acquiredCount < maxRecords; ++i) {
+                uint32_t partitionId = static_cast<uint32_t>((cursor + i) % numPartitions);
+                auto ranges = partitions_[partitionId]->acquire(memberId, maxRecords - acquiredCount,
+                                                                logEndOffsets[partitionId], leaseDeadline);
+                if (ranges.empty()) {
+                    continue;
+                }
+
+                armExpiryLocked(partitionId, leaseDeadline);
+                for (const auto& [first, last] : ranges) {
+                    acquiredCount += last - first + 1;
+                }
+                acquired.emplace_back(partitionId, std::move(ranges));
+            }
+            if (numPartitions > 0) {
+                cursor = static_cast<uint32_t>((cursor + 1) % numPartitions);
+            }
+        }
+
+        // The leases are recorded; a lease that expires meanwhile is simply redelivered too
+        ConsumerRecords records;
+        for (const auto& [partitionId, ranges] : acquired) {
+            std::vector<Message> messages;
+            for (const auto& [first, last] : ranges) {
+                auto batch = broker_.getMessages(topicName_, partitionId, first, last + 1);
+                messages.insert(messages.end(), batch.begin(), batch.end());
+            }
+            totalAcquired_ += messages.size();
+            records.add(partitionId, std::move(messages));
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (!records.empty() || now >= deadline) {
+            return records;
+        }
+
+        // Released or expired records do not append, so re-check at least every 100ms
+        auto wait = std::min(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now),
+                             std::chrono::milliseconds(100));
+        broker_.waitForAppend(topicName_, seenAppends, wait);
+    }
+}
+
+// Consumption: Accepts, releases or rejects one record the member holds
+bool ShareGroup::acknowledge(const std::string& memberId, uint32_t partitionId, uint64_t offset,
+                             AcknowledgeType type) {
+    if (partitionId >= partitions_.size()) {
+        throw std::out_of_range("Partition " + std::to_string(partitionId) + " does not exist");
+    }
+
+    bool acknowledged = partitions_[partitionId]->acknowledge(memberId, offset, type);
+    if (acknowledged) {
+        totalAcknowledged_++;
+    }
+    return acknowledged;
+}
+
+// Configuration: Sets how long acquired records stay leased; applies to later polls
+void ShareGroup::setAcquisitionLockTimeout(std::chrono::milliseconds timeout) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lockTimeout_ = timeout;
+}
+
+// Status: Returns the group id
+std::string ShareGroup::getGroupId() const {
+    return groupId_;
+}
+
+// Status: Returns the number of members
+size_t ShareGroup::getMemberCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return members_.size();
+}
+
+// Status: Returns the delivery state of one partition
+const SharePartition& ShareGroup::getPartition(uint32_t partitionId) const {
+    if (partitionId >= partitions_.size()) {
+        throw std::out_of_range("Partition " + std::to_string(partitionId) + " does not exist");
+    }
+    return *partitions_[partitionId];
+}
+
+// Statistics: Returns the number of records handed out, redeliveries included
+uint64_t ShareGroup::getTotalAcquired() const {
+    return totalAcquired_.load();
+}
+
+// Statistics: Returns the number of successful acknowledgements
+uint64_t ShareGroup::getTotalAcknowledged() const {
+    return totalAcknowledged_.load();
+}
+
+// Statistics: Returns the number of records released by lease expiry
+uint64_t ShareGroup::getTotalLeaseExpirations() const {
+    return totalLeaseExpirations_.load();
+}
+
+// Leases: Makes sure the partition's expiry timer fires no later than deadline; caller holds mutex_
+void ShareGroup::armExpiryLocked(uint32_t partitionId, TimerWheel::Clock::time_point deadline) {
+    if (closing_) {
+        return;
+    }
+
+    auto it = expiryTimers_.find(partitionId);
+    if (it != expiryTimers_.end()) {
+        if (deadline < it->second.deadline && broker_.getSessionTimers().extend(it->second.timerId, deadline)) {
+            it->second.deadline = deadline;
+        }
+        return; // A timer that is already firing re-arms itself for the remaining leases
+    }
+
+    auto timerId = broker_.getSessionTimers().schedule(deadline, [this, partitionId]() {
+        expireLeases(partitionId);
+    });
+    expiryTimers_[partitionId] = ExpiryTimer{timerId, deadline};
+}
+
+// Leases: Releases the partition's timed-out leases and re-arms for the next deadline
+void ShareGroup::expireLeases(uint32_t partitionId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closing_) {
+        return;
+    }
+    expiryTimers_.erase(partitionId);
+
+    SharePartition& partition = *partitions_[partitionId];
+    totalLeaseExpirations_ += partition.expireLeases(TimerWheel::Clock::now());
+
+    auto next = partition.getNextLeaseDeadline();
+    if (next) {
+        armExpiryLocked(partitionId, *next);
+    }
+}
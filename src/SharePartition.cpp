@@ -0,0 +1,262 @@
+#include "SharePartition.h"
+
+#include <bit>
+
+// Constructor: Starts with an empty window at offset 0
+SharePartition::SharePartition(uint32_t id, size_t maxInFlightRecords, uint8_t maxDeliveryAttempts) :
+    id_(id),
+    maxInFlightRecords_(maxInFlightRecords),
+    maxDeliveryAttempts_(maxDeliveryAttempts),
+    windowBase_(0),
+    startOffset_(0),
+    endOffset_(0),
+    acquiredCount_(0),
+    archivedCount_(0) {}
+
+// Delivery: Leases up to maxRecords available records to a member, redeliveries first, then
+// records never handed out. Returns the acquired offsets as contiguous ranges.
+std::vector<SharePartition::OffsetRange> SharePartition::acquire(const std::string& memberId, size_t maxRecords,
+                                                                 uint64_t logEndOffset,
+                                                                 Clock::time_point leaseDeadline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<OffsetRange> ranges;
+    size_t taken = 0;
+
+    auto take = [&](uint64_t offset) {
+        setBit(acquired_, offset, true);
+        deliveryCounts_[offset - windowBase_]++;
+        acquiredCount_++;
+        taken++;
+        if (!ranges.empty() && ranges.back().second + 1 == offset) {
+            ranges.back().second = offset;
+        } else {
+            ranges.emplace_back(offset, offset);
+        }
+    };
+
+    // Redeliveries: scan the window a word at a time for records neither acquired nor completed
+    uint64_t windowEndWord = (endOffset_ - windowBase_ + 63) / 64;
+    for (uint64_t word = (startOffset_ - windowBase_) / 64; word < windowEndWord && taken < maxRecords; ++word) {
+        uint64_t available = ~(acquired_[word] | completed_[word]);
+        while (available != 0 && taken < maxRecords) {
+            uint64_t offset = windowBase_ + word * 64 + std::countr_zero(available);
+            available &= available - 1;
+            if (offset < startOffset_) {
+                continue;
+            }
+            if (offset >= endOffset_) {
+                break;
+            }
+            if (deliveryCounts_[offset - windowBase_] >= maxDeliveryAttempts_) {
+                completeLocked(offset, true); // Poison record: archived instead of redelivered
+                continue;
+            }
+            take(offset);
+        }
+    }
+
+    // New records, bounded by the in-flight window
+    while (taken < maxRecords && endOffset_ < logEndOffset && endOffset_ - startOffset_ < maxInFlightRecords_) {
+        extendWindow(endOffset_ + 1);
+        take(endOffset_++);
+    }
+
+    for (const auto& [first, last] : ranges) {
+        leases_[first] = Lease{last, memberId, leaseDeadline};
+    }
+    advanceStartOffset();
+    return ranges;
+}
+
+// Delivery: Settles one record acquired by the member; false when the member does not hold it
+bool SharePartition::acknowledge(const std::string& memberId, uint64_t offset, AcknowledgeType type) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (offset < startOffset_ || offset >= endOffset_ || !testBit(acquired_, offset)) {
+        return false;
+    }
+
+    auto lease = findLease(offset);
+    if (lease == leases_.end() || lease->second.memberId != memberId) {
+        return false;
+    }
+    removeFromLease(lease, offset);
+    setBit(acquired_, offset, false);
+    acquiredCount_--;
+
+    switch (type) {
+    case AcknowledgeType::Accept:
+        completeLocked(offset, false);
+        break;
+    case AcknowledgeType::Reject:
+        completeLocked(offset, true);
+        break;
+    case AcknowledgeType::Release:
+        break; // Available again; the delivery count decides whether it is redelivered
+    }
+
+    advanceStartOffset();
+    return true;
+}
+
+// Delivery: Makes the records of every lease past its deadline available again
+size_t SharePartition::expireLeases(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t released = 0;
+
+    for (auto it = leases_.begin(); it != leases_.end();) {
+        if (it->second.deadline > now) {
+            ++it;
+            continue;
+        }
+        for (uint64_t offset = it->first; offset <= it->second.lastOffset; ++offset) {
+            makeAvailableLocked(offset);
+            released++;
+        }
+        it = leases_.erase(it);
+    }
+    return released;
+}
+
+// Delivery: Makes every record leased by a departing member available again
+size_t SharePartition::releaseMember(const std::string& memberId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t released = 0;
+
+    for (auto it = leases_.begin(); it != leases_.end();) {
+        if (it->second.memberId != memberId) {
+            ++it;
+            continue;
+        }
+        for (uint64_t offset = it->first; offset <= it->second.lastOffset; ++offset) {
+            makeAvailableLocked(offset);
+            released++;
+        }
+        it = leases_.erase(it);
+    }
+    return released;
+}
+
+// Status: Returns the partition id
+uint32_t SharePartition::getId() const {
+    return id_;
+}
+
+// Status: Returns the first offset that is not yet completed
+uint64_t SharePartition::getStartOffset() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return startOffset_;
+}
+
+// Status: Returns the first offset that was never handed out
+uint64_t SharePartition::getEndOffset() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return endOffset_;
+}
+
+// Status: Returns the number of records currently under a lease
+size_t SharePartition::getAcquiredCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return acquiredCount_;
+}
+
+// Status: Returns the number of records rejected or archived after too many deliveries
+size_t SharePartition::getArchivedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return archivedCount_;
+}
+
+// Status: Returns the earliest deadline among current leases
+std::optional<SharePartition::Clock::time_point> SharePartition::getNextLeaseDeadline() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::optional<Clock::time_point> next;
+    for (const auto& [first, lease] : leases_) {
+        if (!next || lease.deadline < *next) {
+            next = lease.deadline;
+        }
+    }
+    return next;
+}
+
+// Helper: Reads the bit of an offset inside the window
+bool SharePartition::testBit(const std::vector<uint64_t>& bits, uint64_t offset) const {
+    uint64_t index = offset - windowBase_;
+    return (bits[index / 64] >> (index % 64)) & 1;
+}
+
+// Helper: Writes the bit of an offset inside the window
+void SharePartition::setBit(std::vector<uint64_t>& bits, uint64_t offset, bool value) {
+    uint64_t index = offset - windowBase_;
+    uint64_t mask = uint64_t{1} << (index % 64);
+    if (value) {
+        bits[index / 64] |= mask;
+    } else {
+        bits[index / 64] &= ~mask;
+    }
+}
+
+// Helper: Grows the window storage to cover offsets below endOffset
+void SharePartition::extendWindow(uint64_t endOffset) {
+    uint64_t records = endOffset - windowBase_;
+    size_t words = static_cast<size_t>((records + 63) / 64);
+    if (acquired_.size() < words) {
+        acquired_.resize(words, 0);
+        completed_.resize(words, 0);
+    }
+    if (deliveryCounts_.size() < records) {
+        deliveryCounts_.resize(static_cast<size_t>(records), 0);
+    }
+}
+
+// Helper: Marks a record accepted or archived
+void SharePartition::completeLocked(uint64_t offset, bool archived) {
+    setBit(completed_, offset, true);
+    if (archived) {
+        archivedCount_++;
+    }
+}
+
+// Helper: Clears a record's acquired bit (its lease is dropped by the caller)
+void SharePartition::makeAvailableLocked(uint64_t offset) {
+    setBit(acquired_, offset, false);
+    acquiredCount_--;
+}
+
+// Helper: Finds the lease covering an offset
+std::map<uint64_t, SharePartition::Lease>::iterator SharePartition::findLease(uint64_t offset) {
+    auto it = leases_.upper_bound(offset);
+    if (it == leases_.begin()) {
+        return leases_.end();
+    }
+    --it;
+    return offset <= it->second.lastOffset ? it : leases_.end();
+}
+
+// Helper: Removes one offset from a lease, splitting it around that offset
+void SharePartition::removeFromLease(std::map<uint64_t, Lease>::iterator lease, uint64_t offset) {
+    uint64_t first = lease->first;
+    Lease remaining = std::move(lease->second);
+    leases_.erase(lease);
+
+    if (first < offset) {
+        leases_[first] = Lease{offset - 1, remaining.memberId, remaining.deadline};
+    }
+    if (offset < remaining.lastOffset) {
+        leases_[offset + 1] = std::move(remaining);
+    }
+}
+
+// Helper: Moves the start past completed records and drops window words no longer needed
+void SharePartition::advanceStartOffset() {
+    while (startOffset_ < endOffset_ && testBit(completed_, startOffset_)) {
+        startOffset_++;
+    }
+
+    size_t droppedWords = static_cast<size_t>((startOffset_ - windowBase_) / 64);
+    if (droppedWords == 0) {
+        return;
+    }
+    acquired_.erase(acquired_.begin(), acquired_.begin() + droppedWords);
+    completed_.erase(completed_.begin(), completed_.begin() + droppedWords);
+    deliveryCounts_.erase(deliveryCounts_.begin(), deliveryCounts_.begin() + droppedWords * 64);
+    windowBase_ += droppedWords * 64;
+}
@@ -0,0 +1,246 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+// Constructor: Initializes an empty wheel with the given tick resolution
+TimerWheel::TimerWheel(std::chrono::milliseconds tick) :
+    tick_(tick.count() > 0 ? tick : std::chrono::milliseconds(1)),
+    origin_(Clock::now()),
+    currentTick_(0),
+    nextTimerId_(1),
+    firingTimerId_(0),
+    running_(false),
+    totalExpired_(0) {}
+
+// Destructor: Stops the wheel thread; pending timers are dropped without firing
+TimerWheel::~TimerWheel() {
+    stop();
+    join();
+}
+
+// Lifecycle: Starts the wheel thread
+void TimerWheel::start() {
+    if (running_.load()) {
+        return;
+    }
+
+    running_.store(true);
+    wheelThread_ = std::thread(&TimerWheel::wheelThread, this);
+}
+
+// Lifecycle: Stops the wheel thread without waiting for the next tick
+void TimerWheel::stop() {
+    if (!running_.load()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.store(false);
+    }
+    wakeCv_.notify_all();
+}
+
+// Lifecycle: Waits for the wheel thread to finish
+void TimerWheel::join() {
+    if (wheelThread_.joinable()) {
+        wheelThread_.join();
+    }
+}
+
+// Timers: Registers a one-shot callback for 'deadline' and returns its id
+TimerWheel::TimerId TimerWheel::schedule(Clock::time_point deadline, std::function<void()> onExpired) {
+    bool wasIdle;
+    TimerId timerId;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wasIdle = timers_.empty();
+        if (wasIdle) {
+            // The wheel does not tick while it is empty, so catch up before placing
+            currentTick_ = std::max(currentTick_, nowTick());
+        }
+
+        timerId = nextTimerId_++;
+        uint64_t deadlineTick = std::max(toTick(deadline), currentTick_ + 1);
+        timers_.emplace(timerId, Timer{deadlineTick, std::move(onExpired)});
+        place(timerId, deadlineTick);
+    }
+
+    if (wasIdle) {
+        wakeCv_.notify_one();
+    }
+    return timerId;
+}
+
+// Timers: Moves a timer's deadline. Extending only updates the stored deadline (the timer
+// is re-slotted when its old slot comes due); an earlier deadline is slotted right away.
+bool TimerWheel::extend(TimerId timerId, Clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = timers_.find(timerId);
+    if (it == timers_.end()) {
+        return false;
+    }
+
+    uint64_t deadlineTick = std::max(toTick(deadline), currentTick_ + 1);
+    if (deadlineTick < it->second.deadlineTick) {
+        place(timerId, deadlineTick);
+    }
+    it->second.deadlineTick = deadlineTick;
+    return true;
+}
+
+// Timers: Cancels a timer that has not fired yet
+bool TimerWheel::cancel(TimerId timerId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return timers_.erase(timerId) > 0;
+}
+
+// Timers: Cancels a timer; if its callback is running on another thread, waits for it
+bool TimerWheel::cancelSync(TimerId timerId) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool erased = timers_.erase(timerId) > 0;
+
+    if (std::this_thread::get_id() != wheelThread_.get_id()) {
+        firedCv_.wait(lock, [this, timerId] { return firingTimerId_ != timerId; });
+    }
+    return erased;
+}
+
+// Statistics: Returns the number of scheduled timers
+size_t TimerWheel::getActiveTimers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return timers_.size();
+}
+
+// Statistics: Returns the number of callbacks fired
+uint64_t TimerWheel::getTotalExpired() const {
+    return totalExpired_.load();
+}
+
+// Status: Check if the wheel thread is running
+bool TimerWheel::isRunning() const {
+    return running_.load();
+}
+
+// Background: Advances the wheel once per tick while timers are scheduled
+void TimerWheel::wheelThread() {
+    std::vector<TimerId> expired;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (running_.load()) {
+        if (timers_.empty()) {
+            wakeCv_.wait(lock, [this] { return !running_.load() || !timers_.empty(); });
+            continue;
+        }
+
+        Clock::time_point nextTick = origin_ + tick_ * (currentTick_ + 1);
+        if (wakeCv_.wait_until(lock, nextTick, [this] { return !running_.load(); })) {
+            break;
+        }
+
+        expired.clear();
+        advanceTo(nowTick(), expired);
+        fire(lock, expired);
+    }
+}
+
+// Background: Ticks up to 'targetTick', cascading higher levels and collecting due timers
+void TimerWheel::advanceTo(uint64_t targetTick, std::vector<TimerId>& expired) {
+    while (currentTick_ < targetTick) {
+        ++currentTick_;
+
+        for (size_t level = kLevels - 1; level > 0; --level) {
+            uint64_t levelMask = (uint64_t(1) << (kSlotBits * level)) - 1;
+            if ((currentTick_ & levelMask) == 0) {
+                cascade(level);
+            }
+        }
+
+        Slot due;
+        due.swap(levels_[0][currentTick_ & (kSlotsPerLevel - 1)]);
+        for (TimerId timerId : due) {
+            auto it = timers_.find(timerId);
+            if (it == timers_.end()) {
+                continue; // Cancelled or already fired
+            }
+            if (it->second.deadlineTick > currentTick_) {
+                place(timerId, it->second.deadlineTick); // Extended since it was slotted
+            } else {
+                expired.push_back(timerId);
+            }
+        }
+    }
+}
+
+// Background: Runs expired callbacks outside the lock, skipping timers cancelled or
+// extended after they were collected
+void TimerWheel::fire(std::unique_lock<std::mutex>& lock, const std::vector<TimerId>& expired) {
+    for (TimerId timerId : expired) {
+        auto it = timers_.find(timerId);
+        if (it == timers_.end()) {
+            continue;
+        }
+        if (it->second.deadlineTick > currentTick_) {
+            place(timerId, it->second.deadlineTick);
+            continue;
+        }
+
+        std::function<void()> onExpired = std::move(it->second.onExpired);
+        timers_.erase(it);
+        firingTimerId_ = timerId;
+
+        lock.unlock();
+        onExpired();
+        totalExpired_++;
+        lock.lock();
+
+        firingTimerId_ = 0;
+        firedCv_.notify_all();
+    }
+}
+
+// Utility: Slots a timer on the lowest level whose span covers its deadline
+void TimerWheel::place(TimerId timerId, uint64_t deadlineTick) {
+    uint64_t span = uint64_t(1) << (kSlotBits * kLevels);
+    uint64_t delta = deadlineTick - currentTick_;
+    if (delta >= span) {
+        // Beyond the wheel: park it in the last slot to come due and re-slot it then
+        deadlineTick = currentTick_ + span - 1;
+        delta = span - 1;
+    }
+
+    size_t level = 0;
+    while (level + 1 < kLevels && delta >= (uint64_t(1) << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+
+    size_t index = (deadlineTick >> (kSlotBits * level)) & (kSlotsPerLevel - 1);
+    levels_[level][index].push_back(timerId);
+}
+
+// Utility: Re-slots the timers of the level's current slot onto lower levels
+void TimerWheel::cascade(size_t level) {
+    Slot slot;
+    slot.swap(levels_[level][(currentTick_ >> (kSlotBits * level)) & (kSlotsPerLevel - 1)]);
+    for (TimerId timerId : slot) {
+        auto it = timers_.find(timerId);
+        if (it != timers_.end()) {
+            place(timerId, std::max(it->second.deadlineTick, currentTick_));
+        }
+    }
+}
+
+// Utility: Converts a deadline to the first tick at or after it
+uint64_t TimerWheel::toTick(Clock::time_point deadline) const {
+    if (deadline <= origin_) {
+        return 0;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - origin_);
+    return static_cast<uint64_t>((elapsed.count() + tick_.count() - 1) / tick_.count());
+}
+
+// Utility: Returns the tick that has most recently started
+uint64_t TimerWheel::nowTick() const {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - origin_);
+    return static_cast<uint64_t>(elapsed.count() / tick_.count());
+}
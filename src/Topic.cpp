@@ -1,25 +1,70 @@
 #include "Topic.h"
+#include "Tracer.h"
 
 // Constructor: Creates a topic with specified name and number of partitions
 Topic::Topic(std::string name, size_t numPartitions):
        name_(std::move(name)),
-       numPartitions_(numPartitions) {
+       numPartitions_(numPartitions),
+       appendCount_(0) {
     for (size_t i = 0; i < numPartitions_; i++) {
         partitions_.push_back(std::make_shared<Partition>(i));
     }
 }
 
-// Core: Routes a message to appropriate partition based on key hash
+// Core: Routes a copy of a message to appropriate partition based on key hash
 void Topic::append(const Message& message) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    size_t partitionId = std::hash<std::string>()(message.getKey()) % numPartitions_;
-    partitions_[partitionId]->append(message);
-    cv_.notify_all();
+    append(Message(message));
+}
+
+// Core: Routes a message to appropriate partition based on key hash
+void Topic::append(Message&& message) {
+    std::vector<std::function<void()>> readyWaiters;
+    uint64_t traceId = message.getTraceId();
+    uint64_t waitStartTicks = (traceId != 0) ? Tracer::now() : 0;
+    {
+        std::lock_guard lock(mutex_);
+        if (traceId != 0) {
+            Tracer::getInstance().record(traceId, "topic.lock_wait", waitStartTicks, Tracer::now());
+        }
+        size_t partitionId = std::hash<std::string>()(message.getKey()) % numPartitions_;
+        {
+            TraceSpan span(traceId, "partition.append");
+            partitions_[partitionId]->append(std::move(message));
+        }
+        appendCount_.fetch_add(1);
+        cv_.notify_all();
+        readyWaiters.swap(appendWaiters_);
+    }
+    
+    // Callbacks run outside the lock so they may read from this topic
+    for (auto& callback : readyWaiters) {
+        callback();
+    }
+}
+
+// Core: Blocks until an append happens after 'seenAppends' (see getAppendCount) or the timeout expires
+bool Topic::waitForAppend(uint64_t seenAppends, std::chrono::milliseconds timeout) {
+    std::unique_lock lock(mutex_);
+    return cv_.wait_for(lock, timeout, [this, seenAppends] {
+        return appendCount_.load() != seenAppends;
+    });
+}
+
+// Core: Invokes callback on the first append after 'seenAppends' (immediately if one already happened)
+void Topic::notifyOnAppend(uint64_t seenAppends, std::function<void()> callback) {
+    {
+        std::lock_guard lock(mutex_);
+        if (appendCount_.load() == seenAppends) {
+            appendWaiters_.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback();
 }
 
 // Accessor: Returns reference to a specific partition by ID
 Partition& Topic::getPartition(uint32_t partitionId) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
 
     if (partitionId >= numPartitions_) {
         throw std::out_of_range("Partition ID " + std::to_string(partitionId) + " does not exist");
@@ -30,7 +75,7 @@ Partition& Topic::getPartition(uint32_t partitionId) {
 
 // Reader: Retrieves all messages from all partitions in this topic
 std::vector<Message> Topic::getAllMessages() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
     std::vector<Message> allMessages;
 
     size_t totalSize = 0;
@@ -51,7 +96,7 @@ std::vector<Message> Topic::getAllMessages() {
 
 // Utility: Returns total number of messages across all partitions
 size_t Topic::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard lock(mutex_);
 
     size_t totalSize = 0;
     for (const auto& partition : partitions_) {
@@ -66,7 +111,21 @@ std::string Topic::getName() const {
     return name_;
 }
 
+// Getter: Returns the number of appends so far (a cheap change counter for waiters)
+uint64_t Topic::getAppendCount() const {
+    return appendCount_.load();
+}
+
 // Getter: Returns the number of partitions in this topic
 size_t Topic::getNumPartitions() const {
     return numPartitions_;
-}
\ No newline at end of file
+}
+// Setter: Attaches the topic's consumer lag handle; called before the topic is published
+void Topic::setTopicLag(std::shared_ptr<TopicLag> topicLag) {
+    topicLag_ = std::move(topicLag);
+}
+
+// Getter: Returns the topic's consumer lag handle, if one is attached
+TopicLag* Topic::getTopicLag() const {
+    return topicLag_.get();
+}
@@ -0,0 +1,263 @@
+#include "Tracer.h"
+
+#include <map>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Holds the calling thread's ring and releases it for reuse when the thread exits
+template <typename Ring>
+struct ThreadRing {
+    std::shared_ptr<Ring> ring;
+
+    ~ThreadRing() {
+        if (ring) {
+            ring->owned.store(false, std::memory_order_release);
+        }
+    }
+};
+
+} // namespace
+
+// Singleton instance
+Tracer& Tracer::getInstance() {
+    static Tracer instance;
+    return instance;
+}
+
+// Constructor: Starts with sampling disabled and records the clock origin
+Tracer::Tracer() :
+    sampleRate_(0),
+    nextTraceId_(1),
+    nextThreadId_(1),
+    originTicks_(now()),
+    originTime_(std::chrono::steady_clock::now()),
+    totalSampled_(0),
+    totalRecorded_(0) {}
+
+// Sampling: Traces one message in every oneInN (counted per thread)
+void Tracer::setSampleRate(uint32_t oneInN) {
+    sampleRate_.store(oneInN);
+}
+
+// Sampling: Returns the configured rate (0 when disabled)
+uint32_t Tracer::getSampleRate() const {
+    return sampleRate_.load();
+}
+
+// Export: Renders every buffered span as Chrome trace_event JSON. Spans become complete
+// ("X") events, zero-length spans instant ("i") events, and the spans of one message are
+// chained by flow events so the viewer draws its path across threads.
+std::string Tracer::toChromeJson() const {
+    std::vector<Event> events = collect();
+    double ticksPerUs = ticksPerMicrosecond();
+    auto toUs = [this, ticksPerUs](uint64_t ticks) {
+        return static_cast<double>(static_cast<int64_t>(ticks - originTicks_)) / ticksPerUs;
+    };
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    char buffer[512];
+    bool first = true;
+    auto append = [&out, &first](const char* event) {
+        out += first ? "" : ",";
+        out += event;
+        first = false;
+    };
+
+    std::map<uint32_t, bool> threads;
+    for (const auto& event : events) {
+        threads[event.threadId] = true;
+    }
+    for (const auto& [threadId, unused] : threads) {
+        std::snprintf(buffer, sizeof(buffer),
+                      "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread-%u\"}}",
+                      threadId, threadId);
+        append(buffer);
+    }
+
+    std::map<uint64_t, std::vector<const Event*>> byTrace;
+    for (const auto& event : events) {
+        double ts = toUs(event.beginTicks);
+        if (event.endTicks == event.beginTicks) {
+            std::snprintf(buffer, sizeof(buffer),
+                          "{\"ph\":\"i\",\"s\":\"t\",\"cat\":\"selfkafka\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,"
+                          "\"ts\":%.3f,\"args\":{\"trace_id\":%llu}}",
+                          event.name, event.threadId, ts, static_cast<unsigned long long>(event.traceId));
+        } else {
+            std::snprintf(buffer, sizeof(buffer),
+                          "{\"ph\":\"X\",\"cat\":\"selfkafka\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,"
+                          "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"trace_id\":%llu}}",
+                          event.name, event.threadId, ts, toUs(event.endTicks) - ts,
+                          static_cast<unsigned long long>(event.traceId));
+        }
+        append(buffer);
+        byTrace[event.traceId].push_back(&event);
+    }
+
+    for (const auto& [traceId, spans] : byTrace) {
+        if (spans.size() < 2) {
+            continue;
+        }
+        for (size_t i = 0; i < spans.size(); ++i) {
+            const char* phase = (i == 0) ? "s" : (i + 1 == spans.size() ? "f" : "t");
+            std::snprintf(buffer, sizeof(buffer),
+                          "{\"ph\":\"%s\",\"bp\":\"e\",\"cat\":\"selfkafka\",\"name\":\"message\",\"id\":%llu,"
+                          "\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+                          phase, static_cast<unsigned long long>(traceId), spans[i]->threadId,
+                          toUs(spans[i]->beginTicks));
+            append(buffer);
+        }
+    }
+    return out + "]}";
+}
+
+// Export: Writes the Chrome trace JSON to a file
+void Tracer::dump(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Failed to open trace file: " + path);
+    }
+    file << toChromeJson();
+    if (!file) {
+        throw std::runtime_error("Failed to write trace file: " + path);
+    }
+}
+
+// Export: Discards every buffered span (spans racing with the clear may survive it)
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    for (const auto& ring : rings_) {
+        ring->floor.store(ring->head.load());
+    }
+}
+
+// Statistics: Returns the number of messages given a trace id
+uint64_t Tracer::getTotalSampled() const {
+    return totalSampled_.load();
+}
+
+// Statistics: Returns the number of spans recorded (including ones since overwritten)
+uint64_t Tracer::getTotalRecorded() const {
+    return totalRecorded_.load();
+}
+
+// Sampling: Counts the message and hands out a trace id to every Nth
+uint64_t Tracer::sampleSlow() {
+    thread_local uint64_t seen = 0;
+    uint32_t rate = sampleRate_.load(std::memory_order_relaxed);
+    if (rate == 0 || ++seen % rate != 0) {
+        return 0;
+    }
+    totalSampled_.fetch_add(1, std::memory_order_relaxed);
+    return nextTraceId_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Recording: Writes a span into the calling thread's ring, overwriting its oldest span
+void Tracer::recordSlow(uint64_t traceId, const char* name, uint64_t beginTicks, uint64_t endTicks) {
+    Ring& ring = ringForThread();
+    uint64_t position = ring.head.load(std::memory_order_relaxed);
+    Slot& slot = ring.slots[position % kRingEvents];
+
+    uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.traceId.store(traceId, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.beginTicks.store(beginTicks, std::memory_order_relaxed);
+    slot.endTicks.store(endTicks, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    ring.head.store(position + 1, std::memory_order_release);
+    totalRecorded_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Recording: Returns the calling thread's ring, acquiring one on first use
+Tracer::Ring& Tracer::ringForThread() {
+    thread_local ThreadRing<Ring> threadRing;
+    if (!threadRing.ring) {
+        threadRing.ring = acquireRing();
+    }
+    return *threadRing.ring;
+}
+
+// Recording: Reuses the ring of an exited thread whose spans were exported (or cleared),
+// or the oldest released ring once kMaxRetainedRings wait for an export; otherwise creates one
+std::shared_ptr<Tracer::Ring> Tracer::acquireRing() {
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    auto claim = [this](const std::shared_ptr<Ring>& ring) {
+        ring->floor.store(ring->head.load());
+        ring->threadId.store(nextThreadId_++);
+        ring->owned.store(true, std::memory_order_release);
+        return ring;
+    };
+
+    std::shared_ptr<Ring> oldest;
+    size_t released = 0;
+    for (const auto& ring : rings_) {
+        if (ring->owned.load(std::memory_order_acquire)) {
+            continue;
+        }
+        uint64_t head = ring->head.load();
+        if (ring->exported.load() >= head || ring->floor.load() >= head) {
+            return claim(ring);
+        }
+        if (released++ == 0) {
+            oldest = ring;
+        }
+    }
+    if (released >= kMaxRetainedRings) {
+        return claim(oldest); // Its unexported spans are lost, as if the ring wrapped
+    }
+
+    auto created = std::make_shared<Ring>();
+    created->threadId.store(nextThreadId_++);
+    rings_.push_back(created);
+    return created;
+}
+
+// Export: Copies the spans of every ring, skipping slots being overwritten during the copy
+std::vector<Tracer::Event> Tracer::collect() const {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        rings = rings_;
+    }
+
+    std::vector<Event> events;
+    for (const auto& ring : rings) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint32_t threadId = ring->threadId.load();
+        uint64_t begin = std::max(ring->floor.load(), head > kRingEvents ? head - kRingEvents : 0);
+        for (uint64_t position = begin; position < head; ++position) {
+            const Slot& slot = ring->slots[position % kRingEvents];
+            uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            Event event{slot.traceId.load(std::memory_order_relaxed), slot.name.load(std::memory_order_relaxed),
+                        slot.beginTicks.load(std::memory_order_relaxed), slot.endTicks.load(std::memory_order_relaxed),
+                        threadId};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (before % 2 != 0 || slot.sequence.load(std::memory_order_relaxed) != before || event.name == nullptr) {
+                continue;
+            }
+            events.push_back(event);
+        }
+        ring->exported.store(head); // Lets the ring be reused once its thread has exited
+    }
+
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.beginTicks < b.beginTicks;
+    });
+    return events;
+}
+
+// Export: Measures the tick rate against the steady clock since the tracer was created
+double Tracer::ticksPerMicrosecond() const {
+    uint64_t ticks = now() - originTicks_;
+    double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - originTime_).count();
+    if (ticks == 0 || elapsedUs <= 0) {
+        return 1.0;
+    }
+    return static_cast<double>(ticks) / elapsedUs;
+}
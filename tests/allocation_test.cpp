@@ -0,0 +1,166 @@
+// Allocation budgets of the steady-state produce and fetch paths. The test always links
+// the counting operator new/delete (see CMakeLists.txt), so a default ctest run enforces
+// the budgets.
+//
+// Each case warms its path up first (queue rings, partition vectors and metric registry
+// entries reach their working size), then measures allocations per message over a large
+// batch and compares them with the budget. Payloads up to 15 bytes fit the std::string
+// small buffer, so with them any allocation is structural overhead.
+
+#include "AllocationTracker.h"
+#include "Broker.h"
+#include "MessageQueue.h"
+#include "Metrics.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace {
+
+int failures = 0;
+
+// Compares allocations per message with the budget and prints one result line
+void checkBudget(const char* name, const AllocationCounts& counts, uint64_t messages, double budget) {
+    double perMessage = static_cast<double>(counts.allocations) / static_cast<double>(messages);
+    bool ok = perMessage <= budget;
+    std::printf("%-44s %10.5f allocs/msg %10.1f bytes/msg  budget %.3f  %s\n", name, perMessage,
+                static_cast<double>(counts.bytes) / static_cast<double>(messages), budget, ok ? "ok" : "FAILED");
+    if (!ok) {
+        failures++;
+    }
+}
+
+uint64_t logEndOffset(const Broker& broker, const std::string& topicName) {
+    uint64_t total = 0;
+    for (uint32_t partition = 0; partition < broker.getNumPartitions(topicName); ++partition) {
+        total += broker.getLogEndOffset(topicName, partition);
+    }
+    return total;
+}
+
+// Waits until the async writer has appended 'expected' messages to the topic
+bool waitForAppended(const Broker& broker, const std::string& topicName, uint64_t expected) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (logEndOffset(broker, topicName) < expected) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// MessageQueue push and pop once the ring has grown to the working size: no allocations
+void testMessageQueue() {
+    constexpr uint64_t kMessages = 100'000;
+    MessageQueue queue;
+    QueuedMessage entry{Message("", ""), {}, nullptr, 0};
+    for (int i = 0; i < 1000; ++i) {
+        queue.push(Message("key", "value"));
+    }
+    while (queue.tryPopFront(entry)) {}
+
+    AllocationScope scope;
+    for (uint64_t i = 0; i < kMessages; ++i) {
+        queue.push(Message("key", "value"));
+        queue.tryPopFront(entry);
+    }
+    checkBudget("message_queue_push_pop", scope.delta(), kMessages, 0.0);
+}
+
+// Broker::appendSync (topic routing, partition append, metrics): only the amortized
+// growth of the partition vectors may allocate
+void testAppendSync() {
+    constexpr uint64_t kMessages = 200'000;
+    Broker broker("alloc-test");
+    broker.createTopic("sync", 4);
+    Message message("key", "value");
+    for (int i = 0; i < 10'000; ++i) {
+        broker.appendSync("sync", message);
+    }
+
+    AllocationScope scope;
+    for (uint64_t i = 0; i < kMessages; ++i) {
+        broker.appendSync("sync", message);
+    }
+    checkBudget("broker_append_sync", scope.delta(), kMessages, 0.001);
+}
+
+// Broker::send through the async writer, counted across all threads
+void testProducePath(const char* name, const std::string& key, const std::string& value, double budget) {
+    constexpr uint64_t kWarmup = 20'000;
+    constexpr uint64_t kMessages = 100'000;
+    Broker broker("alloc-test");
+    broker.createTopic("produce", 4);
+    broker.startAsyncWriter();
+
+    for (uint64_t i = 0; i < kWarmup; ++i) {
+        broker.send("produce", key, value);
+    }
+    if (!waitForAppended(broker, "produce", kWarmup)) {
+        std::printf("%s: warm-up messages were not appended\n", name);
+        failures++;
+        broker.stopAsyncWriter();
+        return;
+    }
+
+    AllocationScope scope(true);
+    for (uint64_t i = 0; i < kMessages; ++i) {
+        broker.send("produce", key, value);
+    }
+    bool appended = waitForAppended(broker, "produce", kWarmup + kMessages);
+    AllocationCounts counts = scope.delta();
+    broker.stopAsyncWriter();
+
+    if (!appended) {
+        std::printf("%s: messages were not appended\n", name);
+        failures++;
+        return;
+    }
+    checkBudget(name, counts, kMessages, budget);
+}
+
+// Broker::fetch in batches of 100: one allocation (the result vector) per batch
+void testFetchPath() {
+    constexpr uint64_t kMessages = 100'000;
+    constexpr size_t kBatch = 100;
+    Broker broker("alloc-test");
+    broker.createTopic("fetch", 1);
+    Message message("key", "value");
+    for (uint64_t i = 0; i < kMessages; ++i) {
+        broker.appendSync("fetch", message);
+    }
+    broker.fetch("fetch", 0, 0, kBatch, UINT64_MAX);
+
+    AllocationScope scope;
+    uint64_t fetched = 0;
+    for (uint64_t offset = 0; offset < kMessages; offset += kBatch) {
+        fetched += broker.fetch("fetch", 0, offset, kBatch, UINT64_MAX).size();
+    }
+    checkBudget("broker_fetch", scope.delta(), fetched, 1.0 / kBatch + 0.001);
+}
+
+} // namespace
+
+int main() {
+    if (!AllocationTracker::isEnabled()) {
+        std::printf("allocation_test: allocation tracking is not linked in\n");
+        return 1;
+    }
+    Metrics::getInstance().setLogLevel(LogLevel::ERROR);
+
+    testMessageQueue();
+    testAppendSync();
+    testProducePath("produce_small_payload", "key", "value", 0.01);
+    // Larger payloads: the key and value copied into the Message at send, nothing after
+    testProducePath("produce_200_byte_payload", "key-000000000001", std::string(200, 'x'), 2.01);
+    testFetchPath();
+
+    if (failures > 0) {
+        std::printf("allocation_test: %d budget(s) exceeded\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Consumer positions around the records next() buffers: commits cover only the records
+// next() has returned, and seek() or a new assignment drops buffered records that no
+// longer belong at the consumer's position.
+
+#include "Broker.h"
+#include "Consumer.h"
+#include "CoroutineExecutor.h"
+#include "Metrics.h"
+
+#include <cstdio>
+#include <future>
+#include <set>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+// Records one failed expectation with its source line
+void check(bool condition, const char* expression, int line) {
+    if (!condition) {
+        std::printf("  FAILED line %d: %s\n", line, expression);
+        failures++;
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+// Runs consumer.next() on the executor and waits for its record
+Message nextRecord(CoroutineExecutor& executor, Consumer& consumer) {
+    std::promise<Message> result;
+    spawn(executor, [](Consumer& consumer, std::promise<Message>& result) -> Task<void> {
+        result.set_value(co_await consumer.next());
+    }(consumer, result));
+    return result.get_future().get();
+}
+
+void fill(Broker& broker, const std::string& topicName, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        broker.appendSync(topicName, Message("key-" + std::to_string(i), "value"));
+    }
+}
+
+// next() fetches a whole batch, but a commit covers only the records it returned
+void testCommitAfterNext(CoroutineExecutor& executor) {
+    Broker broker("consumer-test");
+    broker.createTopic("events", 1);
+    fill(broker, "events", 10);
+
+    Consumer consumer(broker, "events", "readers");
+    for (uint64_t expected = 0; expected < 3; ++expected) {
+        CHECK(nextRecord(executor, consumer).getOffset() == expected);
+    }
+    consumer.commitSync();
+    CHECK(broker.getCommittedOffset("readers", "events", 0) == 3);
+
+    // A consumer taking over from the commit resumes at the first record not returned
+    Consumer successor(broker, "events", "readers");
+    CHECK(nextRecord(executor, successor).getOffset() == 3);
+
+    // Once the buffer is drained the commit moves to the fetch position
+    for (uint64_t expected = 3; expected < 10; ++expected) {
+        CHECK(nextRecord(executor, consumer).getOffset() == expected);
+    }
+    consumer.commitSync();
+    CHECK(broker.getCommittedOffset("readers", "events", 0) == 10);
+}
+
+// seek() drops the buffered records of its partition
+void testSeekAfterNext(CoroutineExecutor& executor) {
+    Broker broker("consumer-test");
+    broker.createTopic("events", 1);
+    fill(broker, "events", 10);
+
+    Consumer consumer(broker, "events");
+    CHECK(nextRecord(executor, consumer).getOffset() == 0);
+    consumer.seek(0, 7);
+    CHECK(nextRecord(executor, consumer).getOffset() == 7);
+    consumer.seek(0, 2);
+    CHECK(nextRecord(executor, consumer).getOffset() == 2);
+    CHECK(nextRecord(executor, consumer).getOffset() == 3);
+}
+
+// A new assignment drops the buffered records of the partitions taken away
+void testReassignAfterNext(CoroutineExecutor& executor) {
+    Broker broker("consumer-test");
+    broker.createTopic("events", 2);
+    fill(broker, "events", 40);
+    std::set<std::string> partitionOneKeys;
+    for (const auto& message : broker.fetch("events", 1, 0, 100, UINT64_MAX)) {
+        partitionOneKeys.insert(message.getKey());
+    }
+    CHECK(broker.getLogEndOffset("events", 0) > 0 && !partitionOneKeys.empty());
+
+    // The first batch starts at partition 0, so the first record comes from it
+    Consumer consumer(broker, "events", "readers");
+    consumer.assign({0, 1});
+    CHECK(partitionOneKeys.count(nextRecord(executor, consumer).getKey()) == 0);
+    consumer.assign({1});
+
+    for (size_t i = 0; i < partitionOneKeys.size(); ++i) {
+        CHECK(partitionOneKeys.count(nextRecord(executor, consumer).getKey()) == 1);
+    }
+    consumer.commitSync();
+    CHECK(broker.getCommittedOffset("readers", "events", 1) == partitionOneKeys.size());
+    CHECK(broker.getCommittedOffset("readers", "events", 0) == 1); // Only one record was returned
+}
+
+void run(const char* name, void (*test)(CoroutineExecutor&), CoroutineExecutor& executor) {
+    int before = failures;
+    test(executor);
+    std::printf("%-32s %s\n", name, failures == before ? "ok" : "FAILED");
+}
+
+} // namespace
+
+int main() {
+    Metrics::getInstance().setLogLevel(LogLevel::ERROR);
+    CoroutineExecutor executor(1);
+    executor.start();
+
+    run("commit_after_next", testCommitAfterNext, executor);
+    run("seek_after_next", testSeekAfterNext, executor);
+    run("reassign_after_next", testReassignAfterNext, executor);
+
+    executor.stop();
+    executor.join();
+    if (failures > 0) {
+        std::printf("consumer_test: %d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+// Embedded group metadata backend: replay of the snapshot plus the journal, a torn journal
+// tail, an append that fails partway, and reopening after the journal was compacted into
+// a snapshot.
+
+#include "FileGroupStore.h"
+#include "Metrics.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <unistd.h>
+#include <sys/resource.h>
+
+namespace {
+
+using TimePoint = std::chrono::system_clock::time_point;
+
+int failures = 0;
+
+// Records one failed expectation with its source line
+void check(bool condition, const char* expression, int line) {
+    if (!condition) {
+        std::printf("  FAILED line %d: %s\n", line, expression);
+        failures++;
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+// Fresh store directory per case, removed when the case ends
+class TempDirectory {
+public:
+    explicit TempDirectory(const std::string& name) :
+        path_(std::filesystem::temp_directory_path() /
+              ("selfkafka-" + name + "-" + std::to_string(::getpid()))) {
+        std::filesystem::remove_all(path_);
+    }
+
+    ~TempDirectory() {
+        std::filesystem::remove_all(path_);
+    }
+
+    std::string path() const {
+        return path_.string();
+    }
+
+    std::string journalPath() const {
+        return (path_ / "journal.log").string();
+    }
+
+private:
+    std::filesystem::path path_;
+};
+
+// Heartbeats are stored with millisecond precision
+TimePoint heartbeat(int64_t milliseconds) {
+    return TimePoint(std::chrono::milliseconds(milliseconds));
+}
+
+GroupStateDiff join(const std::string& consumerId, int64_t heartbeatMs, uint32_t partitionId) {
+    GroupStateDiff diff;
+    diff.upsertedMembers.emplace_back(consumerId, heartbeat(heartbeatMs));
+    diff.upsertedAssignments.emplace_back(partitionId, consumerId);
+    return diff;
+}
+
+GroupStateDiff leave(const std::string& consumerId) {
+    GroupStateDiff diff;
+    diff.removedMembers.push_back(consumerId);
+    return diff;
+}
+
+// Diffs spread over a snapshot and the journal replay to the same state; the journal
+// keeps growing after a reopen and compacts again
+void testSnapshotAndJournalReplay() {
+    TempDirectory directory("group-replay");
+    {
+        FileGroupStore store(directory.path());
+        store.setSnapshotThreshold(3);
+        store.load("g", "t");
+        CHECK(store.apply("g", "t", join("a", 1000, 0)));
+        CHECK(store.apply("g", "t", join("b", 2000, 1)));
+        CHECK(store.apply("g", "t", join("c", 3000, 2)));
+        CHECK(store.getTotalSnapshots() >= 1);
+        CHECK(store.apply("g", "t", leave("b")));       // Journal only
+        CHECK(store.apply("g", "t", join("a", 4000, 1))); // Takes over b's partition
+    }
+
+    {
+        FileGroupStore store(directory.path());
+        GroupState state = store.load("g", "t");
+        CHECK(state.members.size() == 2);
+        CHECK(state.members.count("b") == 0);
+        CHECK(state.members["a"] == heartbeat(4000));
+        CHECK(state.members["c"] == heartbeat(3000));
+        CHECK(state.assignments.size() == 3);
+        CHECK(state.assignments[0] == "a" && state.assignments[1] == "a" && state.assignments[2] == "c");
+
+        // Compact again after the reopen, then reopen from the new snapshot
+        store.setSnapshotThreshold(1);
+        uint64_t snapshots = store.getTotalSnapshots();
+        CHECK(store.apply("g", "t", leave("c")));
+        CHECK(store.getTotalSnapshots() == snapshots + 1);
+        CHECK(std::filesystem::file_size(directory.journalPath()) == 0);
+    }
+
+    FileGroupStore store(directory.path());
+    GroupState state = store.load("g", "t");
+    CHECK(state.members.size() == 1 && state.members.count("a") == 1);
+    CHECK(state.assignments.size() == 2 && state.assignments.count(2) == 0);
+}
+
+// A record cut short at the tail of the journal is dropped; later diffs are kept
+void testTornJournalTail() {
+    TempDirectory directory("group-torn-tail");
+    {
+        FileGroupStore store(directory.path());
+        store.load("g", "t");
+        CHECK(store.apply("g", "t", join("a", 1000, 0)));
+    }
+    {
+        std::ofstream journal(directory.journalPath(), std::ios::binary | std::ios::app);
+        journal.write("\x47\x40\x00\x00\x00group", 10); // Header and part of a payload
+    }
+
+    {
+        FileGroupStore store(directory.path());
+        GroupState state = store.load("g", "t");
+        CHECK(state.members.size() == 1 && state.assignments[0] == "a");
+        CHECK(store.apply("g", "t", join("b", 2000, 1)));
+    }
+
+    FileGroupStore store(directory.path());
+    GroupState state = store.load("g", "t");
+    CHECK(state.members.size() == 2);
+    CHECK(state.assignments[1] == "b");
+}
+
+// A short journal write (the file size limit stands in for a full disk) is rejected and
+// cut back, so diffs applied afterwards survive a reopen
+void testFailedAppendThenRetry() {
+    TempDirectory directory("group-append-failure");
+    std::signal(SIGXFSZ, SIG_IGN);
+    rlimit original;
+    ::getrlimit(RLIMIT_FSIZE, &original);
+    {
+        FileGroupStore store(directory.path());
+        store.load("g", "t");
+        CHECK(store.apply("g", "t", join("a", 1000, 0)));
+        uintmax_t length = std::filesystem::file_size(directory.journalPath());
+
+        rlimit limited = original;
+        limited.rlim_cur = length + 10; // Less than one record fits
+        ::setrlimit(RLIMIT_FSIZE, &limited);
+        bool applied = store.apply("g", "t", join("b", 2000, 1));
+        ::setrlimit(RLIMIT_FSIZE, &original);
+        CHECK(!applied);
+        CHECK(std::filesystem::file_size(directory.journalPath()) == length);
+
+        CHECK(store.apply("g", "t", join("c", 3000, 2)));
+    }
+
+    FileGroupStore store(directory.path());
+    GroupState state = store.load("g", "t");
+    CHECK(state.members.size() == 2);
+    CHECK(state.members.count("b") == 0);
+    CHECK(state.assignments[2] == "c");
+}
+
+void run(const char* name, void (*test)()) {
+    int before = failures;
+    test();
+    std::printf("%-32s %s\n", name, failures == before ? "ok" : "FAILED");
+}
+
+} // namespace
+
+int main() {
+    Metrics::getInstance().setLogLevel(LogLevel::ERROR);
+
+    run("snapshot_and_journal_replay", testSnapshotAndJournalReplay);
+    run("torn_journal_tail", testTornJournalTail);
+    run("failed_append_then_retry", testFailedAppendThenRetry);
+
+    if (failures > 0) {
+        std::printf("file_group_store_test: %d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Offset log durability: recovery drops a torn tail and keeps appending after it, an
+// append that fails partway is cut back so its retry is recovered along with later
+// commits, and a compacted log restarts with the latest offset of every key.
+
+#include "Metrics.h"
+#include "OffsetStore.h"
+
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <unistd.h>
+#include <sys/resource.h>
+
+namespace {
+
+int failures = 0;
+
+// Records one failed expectation with its source line
+void check(bool condition, const char* expression, int line) {
+    if (!condition) {
+        std::printf("  FAILED line %d: %s\n", line, expression);
+        failures++;
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+// Fresh data directory per case, removed when the case ends
+class TempDirectory {
+public:
+    explicit TempDirectory(const std::string& name) :
+        path_(std::filesystem::temp_directory_path() /
+              ("selfkafka-" + name + "-" + std::to_string(::getpid()))) {
+        std::filesystem::remove_all(path_);
+    }
+
+    ~TempDirectory() {
+        std::filesystem::remove_all(path_);
+    }
+
+    std::string path() const {
+        return path_.string();
+    }
+
+    std::string logPath() const {
+        return (path_ / "__consumer_offsets" / "00000000.log").string();
+    }
+
+private:
+    std::filesystem::path path_;
+};
+
+// A half-written record at the tail is dropped; commits after the restart are kept
+void testTornTail() {
+    TempDirectory directory("offset-torn-tail");
+    {
+        OffsetStore store(directory.path());
+        store.commitSync("g", "t", 0, 10);
+        store.commitSync("g", "t", 1, 20);
+    }
+    uintmax_t validLength = std::filesystem::file_size(directory.logPath());
+    {
+        std::ofstream log(directory.logPath(), std::ios::binary | std::ios::app);
+        log.write("\x4F\x01\x00\x01", 4); // Header of a record cut short by a crash
+    }
+
+    {
+        OffsetStore store(directory.path());
+        CHECK(store.getCommittedOffset("g", "t", 0) == 10);
+        CHECK(store.getCommittedOffset("g", "t", 1) == 20);
+        CHECK(std::filesystem::file_size(directory.logPath()) == validLength);
+        store.commitSync("g", "t", 2, 30);
+    }
+
+    OffsetStore store(directory.path());
+    CHECK(store.getCommittedOffset("g", "t", 0) == 10);
+    CHECK(store.getCommittedOffset("g", "t", 2) == 30);
+}
+
+// A short write (the file size limit stands in for a full disk) fails the commit and is
+// cut back; the requeued commit is retried with the next one and both survive a restart
+void testAppendFailureThenRetry() {
+    TempDirectory directory("offset-append-failure");
+    std::signal(SIGXFSZ, SIG_IGN);
+    rlimit original;
+    ::getrlimit(RLIMIT_FSIZE, &original);
+    {
+        OffsetStore store(directory.path());
+        store.commitSync("g", "t", 0, 1);
+        uintmax_t length = std::filesystem::file_size(directory.logPath());
+
+        rlimit limited = original;
+        limited.rlim_cur = length + 10; // Less than one record fits
+        ::setrlimit(RLIMIT_FSIZE, &limited);
+        bool failed = false;
+        try {
+            store.commitSync("group-with-a-long-name", "t", 1, 2);
+        } catch (const std::exception&) {
+            failed = true;
+        }
+        ::setrlimit(RLIMIT_FSIZE, &original);
+        CHECK(failed);
+        CHECK(std::filesystem::file_size(directory.logPath()) == length);
+
+        store.commitSync("g", "t", 2, 3);
+    }
+
+    OffsetStore store(directory.path());
+    CHECK(store.getCommittedOffset("g", "t", 0) == 1);
+    CHECK(store.getCommittedOffset("group-with-a-long-name", "t", 1) == 2);
+    CHECK(store.getCommittedOffset("g", "t", 2) == 3);
+}
+
+// Compaction rewrites the log to one record per key; appends after it and a restart
+// still see the latest offsets
+void testCompactionAndRestart() {
+    TempDirectory directory("offset-compaction");
+    constexpr uint32_t kPartitions = 4;
+    uintmax_t uncompacted;
+    {
+        OffsetStore store(directory.path());
+        store.setCompactionThreshold(1000000);
+        for (uint64_t offset = 1; offset <= 50; ++offset) {
+            store.commitSync("g", "t", static_cast<uint32_t>(offset % kPartitions), offset);
+        }
+        uncompacted = std::filesystem::file_size(directory.logPath());
+    }
+    {
+        OffsetStore store(directory.path());
+        store.setCompactionThreshold(10);
+        for (uint64_t offset = 51; offset <= 100; ++offset) {
+            store.commitSync("g", "t", static_cast<uint32_t>(offset % kPartitions), offset);
+        }
+        CHECK(std::filesystem::file_size(directory.logPath()) < uncompacted);
+    }
+
+    {
+        OffsetStore store(directory.path());
+        for (uint32_t partition = 0; partition < kPartitions; ++partition) {
+            CHECK(store.getCommittedOffset("g", "t", partition) == 100 - (100 - partition) % kPartitions);
+        }
+        store.commitSync("g", "t", 0, 500);
+    }
+
+    OffsetStore store(directory.path());
+    CHECK(store.getCommittedOffset("g", "t", 0) == 500);
+    CHECK(store.getCommittedOffset("g", "t", 3) == 99);
+}
+
+void run(const char* name, void (*test)()) {
+    int before = failures;
+    test();
+    std::printf("%-32s %s\n", name, failures == before ? "ok" : "FAILED");
+}
+
+} // namespace
+
+int main() {
+    Metrics::getInstance().setLogLevel(LogLevel::ERROR);
+
+    run("torn_tail", testTornTail);
+    run("append_failure_then_retry", testAppendFailureThenRetry);
+    run("compaction_and_restart", testCompactionAndRestart);
+
+    if (failures > 0) {
+        std::printf("offset_store_test: %d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
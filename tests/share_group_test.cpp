@@ -0,0 +1,237 @@
+// Share group delivery state machine: acquisition, acknowledgement (accept, release,
+// reject), lease expiry, delivery attempt limits and member departure, first on a
+// SharePartition directly and then through ShareGroup against a broker.
+
+#include "Broker.h"
+#include "Metrics.h"
+#include "ShareGroup.h"
+#include "SharePartition.h"
+
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = SharePartition::Clock;
+using Ranges = std::vector<SharePartition::OffsetRange>;
+
+int failures = 0;
+
+// Records one failed expectation with its source line
+void check(bool condition, const char* expression, int line) {
+    if (!condition) {
+        std::printf("  FAILED line %d: %s\n", line, expression);
+        failures++;
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+size_t countOffsets(const Ranges& ranges) {
+    size_t count = 0;
+    for (const auto& [first, last] : ranges) {
+        count += last - first + 1;
+    }
+    return count;
+}
+
+Clock::time_point later() {
+    return Clock::now() + std::chrono::hours(1);
+}
+
+// Acquire hands out new records as one range; accepting the prefix advances the start
+void testAcquireAndAccept() {
+    SharePartition partition(0);
+    Ranges ranges = partition.acquire("a", 10, 10, later());
+    CHECK(ranges.size() == 1 && ranges[0] == SharePartition::OffsetRange(0, 9));
+    CHECK(partition.getAcquiredCount() == 10);
+    CHECK(partition.getEndOffset() == 10);
+
+    // Nothing left to hand out until the log grows
+    CHECK(partition.acquire("b", 10, 10, later()).empty());
+
+    for (uint64_t offset = 0; offset < 5; ++offset) {
+        CHECK(partition.acknowledge("a", offset, AcknowledgeType::Accept));
+    }
+    CHECK(partition.getStartOffset() == 5);
+    CHECK(partition.getAcquiredCount() == 5);
+
+    // Only the holder may settle a record, and only once
+    CHECK(!partition.acknowledge("b", 5, AcknowledgeType::Accept));
+    CHECK(!partition.acknowledge("a", 0, AcknowledgeType::Accept));
+    CHECK(!partition.acknowledge("a", 10, AcknowledgeType::Accept));
+
+    // Accepting out of order leaves the start at the first unsettled record
+    CHECK(partition.acknowledge("a", 7, AcknowledgeType::Accept));
+    CHECK(partition.getStartOffset() == 5);
+}
+
+// Released records are redelivered to any member before new ones; rejected ones never
+void testReleaseAndReject() {
+    SharePartition partition(0);
+    partition.acquire("a", 4, 8, later());
+    CHECK(partition.acknowledge("a", 1, AcknowledgeType::Release));
+    CHECK(partition.acknowledge("a", 2, AcknowledgeType::Reject));
+    CHECK(partition.getArchivedCount() == 1);
+
+    Ranges ranges = partition.acquire("b", 2, 8, later());
+    CHECK(ranges.size() == 2);
+    CHECK(!ranges.empty() && ranges[0] == SharePartition::OffsetRange(1, 1));
+    CHECK(ranges.size() > 1 && ranges[1] == SharePartition::OffsetRange(4, 4));
+
+    // The redelivered record now belongs to b
+    CHECK(!partition.acknowledge("a", 1, AcknowledgeType::Accept));
+    CHECK(partition.acknowledge("b", 1, AcknowledgeType::Accept));
+}
+
+// Leases past their deadline are released; the records go to the next acquirer
+void testLeaseExpiry() {
+    SharePartition partition(0);
+    auto deadline = Clock::now() + std::chrono::milliseconds(10);
+    partition.acquire("a", 3, 3, deadline);
+    partition.acquire("b", 3, 6, later());
+    CHECK(partition.getNextLeaseDeadline() == deadline);
+
+    CHECK(partition.expireLeases(deadline - std::chrono::milliseconds(1)) == 0);
+    CHECK(partition.expireLeases(deadline) == 3);
+    CHECK(partition.getAcquiredCount() == 3);
+    CHECK(!partition.acknowledge("a", 0, AcknowledgeType::Accept));
+
+    Ranges ranges = partition.acquire("c", 10, 6, later());
+    CHECK(ranges.size() == 1 && ranges[0] == SharePartition::OffsetRange(0, 2));
+}
+
+// A record delivered maxDeliveryAttempts times is archived instead of redelivered
+void testDeliveryLimit() {
+    SharePartition partition(0, 100, 2);
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        Ranges ranges = partition.acquire("a", 1, 1, later());
+        CHECK(ranges.size() == 1 && ranges[0].first == 0);
+        CHECK(partition.acknowledge("a", 0, AcknowledgeType::Release));
+    }
+    CHECK(partition.acquire("a", 1, 1, later()).empty());
+    CHECK(partition.getArchivedCount() == 1);
+    CHECK(partition.getStartOffset() == 1);
+}
+
+// A departing member's leases are released; acquisition stops at the in-flight bound
+void testReleaseMemberAndWindow() {
+    SharePartition partition(0, 4);
+    CHECK(countOffsets(partition.acquire("a", 10, 100, later())) == 4);
+    CHECK(partition.acquire("b", 10, 100, later()).empty());
+
+    CHECK(partition.releaseMember("a") == 4);
+    CHECK(partition.getAcquiredCount() == 0);
+    Ranges ranges = partition.acquire("b", 10, 100, later());
+    CHECK(countOffsets(ranges) == 4);
+
+    // Settling the window lets new records in, across a 64-record word boundary
+    for (uint64_t round = 0; round < 20; ++round) {
+        for (const auto& [first, last] : ranges) {
+            for (uint64_t offset = first; offset <= last; ++offset) {
+                CHECK(partition.acknowledge("b", offset, AcknowledgeType::Accept));
+            }
+        }
+        ranges = partition.acquire("b", 10, 100, later());
+    }
+    CHECK(partition.getStartOffset() == 80);
+}
+
+// Two members share every partition: together they see each record once, and a lease
+// that times out is redelivered by the broker's timer wheel
+void testShareGroup() {
+    constexpr size_t kMessages = 40;
+    Broker broker("share-test");
+    broker.createTopic("jobs", 2);
+    for (size_t i = 0; i < kMessages; ++i) {
+        broker.appendSync("jobs", Message("key-" + std::to_string(i), "value"));
+    }
+
+    ShareGroup group("workers", broker, "jobs");
+    std::string first = group.join();
+    std::string second = group.join();
+    CHECK(group.getMemberCount() == 2);
+
+    std::set<std::pair<uint32_t, uint64_t>> seen;
+    size_t duplicates = 0;
+    auto pollInto = [&](const std::string& member, size_t maxRecords) {
+        ConsumerRecords records = group.poll(member, maxRecords, std::chrono::milliseconds(0));
+        for (const auto& [partitionId, messages] : records) {
+            for (const auto& message : messages) {
+                if (!seen.emplace(partitionId, message.getOffset()).second) {
+                    duplicates++;
+                }
+            }
+        }
+        return records;
+    };
+
+    ConsumerRecords firstRecords = pollInto(first, 15);
+    ConsumerRecords secondRecords = pollInto(second, 100);
+    CHECK(firstRecords.count() == 15);
+    CHECK(secondRecords.count() == kMessages - 15);
+    CHECK(duplicates == 0);
+    CHECK(pollInto(first, 100).empty());
+
+    for (const auto& [partitionId, messages] : secondRecords) {
+        for (const auto& message : messages) {
+            CHECK(group.acknowledge(second, partitionId, message.getOffset()));
+            CHECK(!group.acknowledge(first, partitionId, message.getOffset()));
+        }
+    }
+
+    // The first member leaves without acknowledging: its records go to the second
+    group.leave(first);
+    CHECK(group.getMemberCount() == 1);
+    ConsumerRecords redelivered = group.poll(second, 100, std::chrono::milliseconds(0));
+    CHECK(redelivered.count() == 15);
+
+    // Now the second member sits on them until the lease times out
+    group.setAcquisitionLockTimeout(std::chrono::milliseconds(50));
+    for (const auto& [partitionId, messages] : redelivered) {
+        for (const auto& message : messages) {
+            CHECK(group.acknowledge(second, partitionId, message.getOffset(), AcknowledgeType::Release));
+        }
+    }
+    std::string third = group.join();
+    CHECK(group.poll(second, 100, std::chrono::milliseconds(0)).count() == 15);
+    ConsumerRecords expired = group.poll(third, 100, std::chrono::milliseconds(2000));
+    CHECK(expired.count() == 15);
+    CHECK(group.getTotalLeaseExpirations() == 15);
+
+    for (const auto& [partitionId, messages] : expired) {
+        for (const auto& message : messages) {
+            CHECK(group.acknowledge(third, partitionId, message.getOffset()));
+        }
+    }
+    CHECK(group.getPartition(0).getStartOffset() + group.getPartition(1).getStartOffset() == kMessages);
+    CHECK(group.getTotalAcknowledged() == kMessages + 15); // Releases count as acknowledgements
+}
+
+void run(const char* name, void (*test)()) {
+    int before = failures;
+    test();
+    std::printf("%-32s %s\n", name, failures == before ? "ok" : "FAILED");
+}
+
+} // namespace
+
+int main() {
+    Metrics::getInstance().setLogLevel(LogLevel::ERROR);
+
+    run("acquire_and_accept", testAcquireAndAccept);
+    run("release_and_reject", testReleaseAndReject);
+    run("lease_expiry", testLeaseExpiry);
+    run("delivery_limit", testDeliveryLimit);
+    run("release_member_and_window", testReleaseMemberAndWindow);
+    run("share_group", testShareGroup);
+
+    if (failures > 0) {
+        std::printf("share_group_test: %d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,216 @@
+// Session timer wheel: firing order across level boundaries, timers cascading from level 1
+// into level 0, cancelling a timer whose callback is running, and extending a deadline
+// onto a higher level. The wheel ticks every millisecond, so level 0 spans 64 ms.
+
+#include "Metrics.h"
+#include "TimerWheel.h"
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <functional>
+
+namespace {
+
+using Clock = TimerWheel::Clock;
+using std::chrono::milliseconds;
+
+constexpr milliseconds kTick(1);
+
+int failures = 0;
+
+// Records one failed expectation with its source line
+void check(bool condition, const char* expression, int line) {
+    if (!condition) {
+        std::printf("  FAILED line %d: %s\n", line, expression);
+        failures++;
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+// Polls until the condition holds or the timeout passes
+bool waitFor(const std::function<bool()>& condition, milliseconds timeout = milliseconds(5000)) {
+    auto deadline = Clock::now() + timeout;
+    while (!condition()) {
+        if (Clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(kTick);
+    }
+    return true;
+}
+
+// Fired timers in firing order, with the time each fired
+class FiringLog {
+public:
+    std::function<void()> callback(int label) {
+        return [this, label]() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            labels_.push_back(label);
+            firedAt_.push_back(Clock::now());
+        };
+    }
+
+    std::vector<int> labels() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return labels_;
+    }
+
+    Clock::time_point firedAt(size_t index) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return firedAt_[index];
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return labels_.size();
+    }
+
+private:
+    std::vector<int> labels_;
+    std::vector<Clock::time_point> firedAt_;
+    mutable std::mutex mutex_;
+};
+
+// Deadlines are rounded to whole ticks, so a timer may fire up to one tick before them
+bool notEarly(Clock::time_point firedAt, Clock::time_point deadline) {
+    return firedAt + kTick >= deadline;
+}
+
+// Timers scheduled out of order on levels 0 and 1 fire by deadline, none of them early
+void testFiringOrderAcrossLevels() {
+    TimerWheel wheel(kTick);
+    wheel.start();
+    FiringLog log;
+
+    auto base = Clock::now();
+    const int deadlinesMs[] = {200, 30, 130, 60, 70, 10, 65};
+    for (int deadlineMs : deadlinesMs) {
+        wheel.schedule(base + milliseconds(deadlineMs), log.callback(deadlineMs));
+    }
+
+    CHECK(waitFor([&] { return log.size() == std::size(deadlinesMs); }));
+    std::vector<int> labels = log.labels();
+    CHECK((labels == std::vector<int>{10, 30, 60, 65, 70, 130, 200}));
+    for (size_t i = 0; i < labels.size(); ++i) {
+        CHECK(notEarly(log.firedAt(i), base + milliseconds(labels[i])));
+    }
+    CHECK(wheel.getActiveTimers() == 0);
+    CHECK(wheel.getTotalExpired() == std::size(deadlinesMs));
+}
+
+// A timer beyond level 0's span is slotted on level 1, moved down to level 0 when its
+// level 1 slot comes due, and fires on its own tick rather than the slot's
+void testCascadeIntoLevelZero() {
+    TimerWheel wheel(kTick);
+    wheel.start();
+    FiringLog log;
+
+    auto base = Clock::now();
+    wheel.schedule(base + milliseconds(150), log.callback(150));
+    wheel.schedule(base + milliseconds(100), log.callback(100));
+
+    std::this_thread::sleep_for(milliseconds(80));
+    CHECK(log.size() == 0);
+
+    CHECK(waitFor([&] { return log.size() == 2; }));
+    CHECK((log.labels() == std::vector<int>{100, 150}));
+    CHECK(notEarly(log.firedAt(0), base + milliseconds(100)));
+    CHECK(notEarly(log.firedAt(1), base + milliseconds(150)));
+}
+
+// cancel() on a timer whose callback is running returns at once; cancelSync() waits for
+// the callback, and a cancelled timer that is still pending never fires
+void testCancelMidFlight() {
+    TimerWheel wheel(kTick);
+    wheel.start();
+
+    std::atomic<bool> started(false);
+    std::atomic<bool> release(false);
+    std::atomic<bool> finished(false);
+    TimerWheel::TimerId running = wheel.schedule(Clock::now() + milliseconds(5), [&]() {
+        started.store(true);
+        while (!release.load()) {
+            std::this_thread::sleep_for(kTick);
+        }
+        finished.store(true);
+    });
+    std::atomic<bool> pendingFired(false);
+    TimerWheel::TimerId pending = wheel.schedule(Clock::now() + milliseconds(20), [&]() {
+        pendingFired.store(true);
+    });
+
+    CHECK(waitFor([&] { return started.load(); }));
+    CHECK(!wheel.cancel(running)); // Already taken off the wheel to fire
+    CHECK(wheel.cancel(pending));
+
+    std::atomic<bool> cancelled(false);
+    std::thread canceller([&]() {
+        wheel.cancelSync(running);
+        cancelled.store(true);
+    });
+    std::this_thread::sleep_for(milliseconds(50));
+    CHECK(!cancelled.load());
+
+    release.store(true);
+    canceller.join();
+    CHECK(finished.load());
+
+    std::this_thread::sleep_for(milliseconds(50));
+    CHECK(!pendingFired.load());
+    CHECK(wheel.getActiveTimers() == 0);
+    CHECK(wheel.getTotalExpired() == 1);
+}
+
+// Extending a level 0 timer past level 0's span re-slots it on level 1 when its old slot
+// comes due; it fires at the new deadline. Pulling a deadline in fires it early.
+void testExtendToHigherLevel() {
+    TimerWheel wheel(kTick);
+    wheel.start();
+    FiringLog log;
+
+    auto base = Clock::now();
+    TimerWheel::TimerId extended = wheel.schedule(base + milliseconds(20), log.callback(1));
+    TimerWheel::TimerId shortened = wheel.schedule(base + milliseconds(400), log.callback(2));
+    CHECK(wheel.extend(extended, base + milliseconds(250)));
+    CHECK(wheel.extend(shortened, base + milliseconds(40)));
+
+    CHECK(waitFor([&] { return log.size() == 1; }));
+    CHECK(log.labels()[0] == 2);
+    CHECK(notEarly(log.firedAt(0), base + milliseconds(40)));
+    CHECK(Clock::now() < base + milliseconds(250));
+
+    CHECK(waitFor([&] { return log.size() == 2; }));
+    CHECK(log.labels()[1] == 1);
+    CHECK(notEarly(log.firedAt(1), base + milliseconds(250)));
+
+    // Fired timers can no longer be extended
+    CHECK(!wheel.extend(extended, Clock::now() + milliseconds(100)));
+}
+
+void run(const char* name, void (*test)()) {
+    int before = failures;
+    test();
+    std::printf("%-32s %s\n", name, failures == before ? "ok" : "FAILED");
+}
+
+} // namespace
+
+int main() {
+    Metrics::getInstance().setLogLevel(LogLevel::ERROR);
+
+    run("firing_order_across_levels", testFiringOrderAcrossLevels);
+    run("cascade_into_level_zero", testCascadeIntoLevelZero);
+    run("cancel_mid_flight", testCancelMidFlight);
+    run("extend_to_higher_level", testExtendToHigherLevel);
+
+    if (failures > 0) {
+        std::printf("timer_wheel_test: %d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}